@@ -4,12 +4,10 @@
 #include <yavsg/gl_wrap.hpp>
 
 #include <yavsg/gl/error.hpp>
-
-#include <doctest/doctest.h>    // REQUIRE
+#include <yavsg/gl/object_pool.hpp>
 
 #include <array>
 #include <cstdint>  // uintptr_t
-#include <limits>
 #include <tuple>
 #include <vector>
 
@@ -24,6 +22,7 @@ namespace JadeMatrix::yavsg::gl
         using tuple_type = std::tuple< Attributes... >;
         
         attribute_buffer( std::vector< tuple_type > const& vertices );
+        attribute_buffer( tuple_type const* vertices, std::size_t count );
         // template< std::size_t N > attribute_buffer(
         //     std::array< tuple_type, N > const& vertices
         // );
@@ -32,6 +31,8 @@ namespace JadeMatrix::yavsg::gl
         ~attribute_buffer();
         
         void upload_data( std::vector< tuple_type > const& vertices );
+        // For vertices that aren't in a `std::vector`, e.g. a mapped file
+        void upload_data( tuple_type const* vertices, std::size_t count );
         // template< std::size_t N > void upload_data(
         //     std::array< tuple_type, N > const& vertices
         // );
@@ -44,6 +45,7 @@ namespace JadeMatrix::yavsg::gl
     protected:
         GLuint      gl_id_ = 0;
         std::size_t vertex_count_;
+        std::size_t capacity_ = 0;
     };
     
     class index_buffer
@@ -52,11 +54,13 @@ namespace JadeMatrix::yavsg::gl
         
     public:
         index_buffer( std::vector< GLuint > const& indices );
+        index_buffer( GLuint const* indices, std::size_t count );
         index_buffer( index_buffer&& o );
         
         ~index_buffer();
         
         void upload_data( std::vector< GLuint > const& indices );
+        void upload_data( GLuint const* indices, std::size_t count );
         
         std::size_t size() const;
         bool empty() const;
@@ -66,6 +70,7 @@ namespace JadeMatrix::yavsg::gl
     protected:
         GLuint      gl_id_ = 0;
         std::size_t index_count_;
+        std::size_t capacity_ = 0;
     };
 }
 
@@ -77,10 +82,18 @@ JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::attribute_buffer(
     std::vector< tuple_type > const& vertices
 )
 {
-    gl::GenBuffers( 1, &gl_id_ );
     upload_data( vertices );
 }
 
+template< typename... Attributes >
+JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::attribute_buffer(
+    tuple_type const* vertices,
+    std::size_t       count
+)
+{
+    upload_data( vertices, count );
+}
+
 template< typename... Attributes >
 JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::attribute_buffer(
     attribute_buffer&& o
@@ -88,15 +101,13 @@ JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::attribute_buffer(
 {
     std::swap( gl_id_, o.gl_id_ );
     std::swap( vertex_count_, o.vertex_count_ );
+    std::swap( capacity_, o.capacity_ );
 }
 
 template< typename... Attributes >
 JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::~attribute_buffer()
 {
-    if( gl_id_ != 0 )
-    {
-        gl::DeleteBuffers( 1, &gl_id_ );
-    }
+    release_buffer_later( gl_id_, capacity_ );
 }
 
 template< typename... Attributes >
@@ -104,20 +115,25 @@ void JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::upload_data(
     std::vector< tuple_type > const& vertices
 )
 {
-    gl::BindBuffer( GL_ARRAY_BUFFER, gl_id_ );
-    
-    auto const vertices_len = vertices.size() * sizeof( tuple_type );
-    REQUIRE( vertices_len <= std::numeric_limits< GLsizeiptr >::max() );
-    auto const vertices_len_glsip = static_cast< GLsizeiptr >( vertices_len );
-    
-    gl::BufferData(
+    upload_data( vertices.data(), vertices.size() );
+}
+
+template< typename... Attributes >
+void JadeMatrix::yavsg::gl::attribute_buffer< Attributes... >::upload_data(
+    tuple_type const* vertices,
+    std::size_t       count
+)
+{
+    // TODO: GL_DYNAMIC_DRAW, GL_STREAM_DRAW
+    upload_pooled_buffer_data(
         GL_ARRAY_BUFFER,
-        vertices_len_glsip,
-        vertices.data(),
-        GL_STATIC_DRAW // TODO: GL_DYNAMIC_DRAW, GL_STREAM_DRAW
+        gl_id_,
+        capacity_,
+        vertices,
+        count * sizeof( tuple_type )
     );
     
-    vertex_count_ = vertices.size();
+    vertex_count_ = count;
 }
 
 template< typename... Attributes >
@@ -150,42 +166,51 @@ inline JadeMatrix::yavsg::gl::index_buffer::index_buffer(
     std::vector< GLuint > const& indices
 )
 {
-    gl::GenBuffers( 1, &gl_id_ );
     upload_data( indices );
 }
 
+inline JadeMatrix::yavsg::gl::index_buffer::index_buffer(
+    GLuint const* indices,
+    std::size_t   count
+)
+{
+    upload_data( indices, count );
+}
+
 inline JadeMatrix::yavsg::gl::index_buffer::index_buffer( index_buffer&& o )
 {
     std::swap( gl_id_, o.gl_id_ );
     std::swap( index_count_, o.index_count_ );
+    std::swap( capacity_, o.capacity_ );
 }
 
 inline JadeMatrix::yavsg::gl::index_buffer::~index_buffer()
 {
-    if( gl_id_ != 0 )
-    {
-        gl::DeleteBuffers( 1, &gl_id_ );
-    }
+    release_buffer_later( gl_id_, capacity_ );
 }
 
 inline void JadeMatrix::yavsg::gl::index_buffer::upload_data(
     const std::vector< GLuint >& indices
 )
 {
-    gl::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, gl_id_ );
-    
-    auto const buffer_len = indices.size() * sizeof( GLuint );
-    REQUIRE( buffer_len <= std::numeric_limits< GLsizeiptr >::max() );
-    auto const buffer_len_glsip = static_cast< GLsizeiptr >( buffer_len );
-    
-    gl::BufferData(
+    upload_data( indices.data(), indices.size() );
+}
+
+inline void JadeMatrix::yavsg::gl::index_buffer::upload_data(
+    GLuint const* indices,
+    std::size_t   count
+)
+{
+    // TODO: GL_DYNAMIC_DRAW, GL_STREAM_DRAW
+    upload_pooled_buffer_data(
         GL_ELEMENT_ARRAY_BUFFER,
-        buffer_len_glsip,
-        indices.data(),
-        GL_STATIC_DRAW // TODO: GL_DYNAMIC_DRAW, GL_STREAM_DRAW
+        gl_id_,
+        capacity_,
+        indices,
+        count * sizeof( GLuint )
     );
     
-    index_count_ = indices.size();
+    index_count_ = count;
 }
 
 inline std::size_t JadeMatrix::yavsg::gl::index_buffer::size() const
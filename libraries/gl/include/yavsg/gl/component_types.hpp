@@ -0,0 +1,111 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <cstdint>  // uint32_t
+#include <cstring>  // memcpy
+
+
+// Stand-ins for plain component types where the type alone doesn't determine
+// how data is interpreted.  As texture `DataType`s they select formats that are
+// stored more compactly than as 32-bit floats while still being sampled as
+// floats; as vertex attribute components (see `attribute_traits`) they hold
+// the stored value, so vertices can be packed the same way.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    // Integer data read as [0,1] if unsigned or [-1,1] if signed, e.g.
+    // `GL_RGBA8`
+    template< typename T > struct normalized
+    {
+        using sample_type = T;
+        
+        T value;
+    };
+    
+    // 8-bit sRGB-encoded color (`GL_SRGB8`/`GL_SRGB8_ALPHA8`), decoded to
+    // linear by OpenGL when sampled; only has 3- & 4-channel texture formats
+    struct srgb
+    {
+        using sample_type = GLubyte;
+    };
+    
+    // 16-bit float storage; needed as `GLhalf` is just an alias of `GLushort`
+    struct half
+    {
+        using sample_type = GLhalf;
+        
+        GLhalf value;
+    };
+    
+    // 10-bit RGB & 2-bit alpha packed into a `GLuint`; only has a 4-channel
+    // texture format
+    struct rgb10_a2
+    {
+        using sample_type = GLuint;
+    };
+    
+    // Rounds to nearest-even like the hardware conversion
+    inline GLhalf float_to_half( GLfloat value )
+    {
+        std::uint32_t bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        
+        auto const sign     = ( bits >> 16 ) & 0x8000u;
+        auto const exponent = static_cast< int >( ( bits >> 23 ) & 0xFFu );
+        auto       mantissa = bits & 0x7FFFFFu;
+        
+        // Infinity & NaN
+        if( exponent == 0xFF )
+        {
+            return static_cast< GLhalf >(
+                sign | 0x7C00u | ( mantissa ? 0x200u : 0u )
+            );
+        }
+        
+        auto const half_exponent = exponent - 127 + 15;
+        if( half_exponent >= 31 )
+        {
+            return static_cast< GLhalf >( sign | 0x7C00u );
+        }
+        
+        std::uint32_t result;
+        std::uint32_t remainder;
+        std::uint32_t halfway;
+        if( half_exponent <= 0 )
+        {
+            // Too small even for a subnormal
+            if( half_exponent < -10 )
+            {
+                return static_cast< GLhalf >( sign );
+            }
+            
+            mantissa |= 0x800000u;
+            auto const shift = static_cast< std::uint32_t >(
+                14 - half_exponent
+            );
+            result    = sign | ( mantissa >> shift );
+            remainder = mantissa & ( ( 1u << shift ) - 1 );
+            halfway   = 1u << ( shift - 1 );
+        }
+        else
+        {
+            result = (
+                sign
+                | ( static_cast< std::uint32_t >( half_exponent ) << 10 )
+                | ( mantissa >> 13 )
+            );
+            remainder = mantissa & 0x1FFFu;
+            halfway   = 0x1000u;
+        }
+        
+        // A carry out of the mantissa correctly bumps the exponent
+        if( remainder > halfway || ( remainder == halfway && ( result & 1u ) ) )
+        {
+            ++result;
+        }
+        return static_cast< GLhalf >( result );
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <vector>
+
+
+// OpenGL objects can only be deleted on the GPU thread, but the wrappers that
+// own them are often destroyed elsewhere, e.g. when the last reference to a
+// texture goes away on a task worker.  Rather than deleting anything directly,
+// destructors queue the object's name here, & everything queued is freed once
+// per frame with one `glDelete*()` call per object type.  There's only ever
+// one OpenGL context, so there's only one queue.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    // Safe to call from any thread; names of 0 are ignored
+    void delete_texture_later     ( GLuint );
+    void delete_buffer_later      ( GLuint );
+    void delete_vertex_array_later( GLuint );
+    void delete_framebuffer_later ( GLuint );
+    void delete_program_later     ( GLuint );
+    
+    struct deferred_deletion_batch
+    {
+        std::vector< GLuint > textures;
+        std::vector< GLuint > buffers;
+        std::vector< GLuint > vertex_arrays;
+        std::vector< GLuint > framebuffers;
+        std::vector< GLuint > programs;
+        
+        // Not deleted, but returned to a pool (see object_pool.hpp) & so just
+        // as unused by whatever released them
+        std::vector< GLuint > pooled_textures;
+    };
+    
+    // Must be called on the GPU thread.  Returns the names that were just
+    // deleted or pooled, so anything tracking them can forget them before
+    // they're reused; the batch is only valid until the next call.
+    deferred_deletion_batch const& flush_deferred_deletions();
+}
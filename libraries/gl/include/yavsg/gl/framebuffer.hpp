@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include <yavsg/gl/deferred_deletion.hpp>
 #include <yavsg/gl/error.hpp>
 #include "texture.hpp"
 
@@ -443,7 +444,7 @@ JadeMatrix::yavsg::gl::framebuffer< ColorTargetTypes... >::framebuffer(
 template< class... ColorTargetTypes >
 JadeMatrix::yavsg::gl::framebuffer< ColorTargetTypes... >::~framebuffer()
 {
-    gl::DeleteFramebuffers( 1, &gl_id_ );
+    delete_framebuffer_later( gl_id_ );
 }
 
 template< class... ColorTargetTypes >
@@ -0,0 +1,25 @@
+#pragma once
+
+
+#include "texture_utilities.hpp"
+
+#include <filesystem>
+
+
+// Reading & writing of KTX (version 1) texture containers, used to ship
+// textures that were block-compressed ahead of time along with their full mip
+// chains so they can be uploaded as-is.  Only single 2D images in
+// block-compressed formats (see texture_compression.hpp) are supported.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    // Throws `std::runtime_error` if the file can't be read or holds anything
+    // other than a block-compressed 2D texture
+    texture_upload_data read_ktx_file( std::filesystem::path const& filename );
+    
+    void write_ktx_file(
+        std::filesystem::path const& filename,
+        texture_upload_data   const& upload_data
+    );
+}
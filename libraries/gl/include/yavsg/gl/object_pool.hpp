@@ -0,0 +1,104 @@
+#pragma once
+
+
+#include "deferred_deletion.hpp"
+#include "texture_utilities.hpp"
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+
+
+// Streaming content creates & destroys textures & buffers all the time, so
+// rather than deleting them, released objects are kept in pools bucketed by
+// shape (textures) or capacity (buffers) & handed back out to the next object
+// of a matching shape, saving the `glGen*()`/`glDelete*()` & the driver's
+// re-validation of a new object.
+//
+// Buffers keep their storage while pooled, so small buffer capacities are
+// rounded up to a power of two to make reuse likely; large ones only to a
+// multiple of 64 KiB, so meshes that are never recycled don't pay up to twice
+// their size.  Textures don't keep their storage, as texture memory is
+// accounted for by whatever streamed their levels in; a pooled texture is only
+// an object that already has the right format & level range set up.
+//
+// Objects are returned to the pools through the deferred deletion queue, so
+// they can be released from any thread but only become available again after
+// the next `flush_deferred_deletions()`.  Anything that doesn't fit in its pool
+// is deleted as usual.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    struct texture_shape
+    {
+        GLenum      target;
+        GLint       gl_internal_format;
+        GLenum      gl_incoming_format;
+        GLenum      gl_incoming_type;
+        std::size_t width;
+        std::size_t height;
+        std::size_t layers;
+        std::size_t levels;
+    };
+    
+    bool operator<( texture_shape const&, texture_shape const& );
+    
+    texture_shape texture_shape_of(
+        GLenum                     target,
+        texture_upload_data const& upload_data,
+        std::size_t                layers = 1
+    );
+    
+    struct object_pool_limits
+    {
+        std::size_t textures_per_shape;
+        std::size_t textures;
+        std::size_t buffers_per_capacity;
+        std::size_t buffer_bytes;
+    };
+    
+    // Defaults to 4 textures per shape & 64 in total, & 8 buffers per capacity
+    // & 64 MiB in total; pools are trimmed to lowered totals on the next flush
+    void set_object_pool_limits( object_pool_limits const& );
+    object_pool_limits object_pool_limit_settings();
+    
+    struct object_pool_counters
+    {
+        std::uint64_t texture_hits   = 0;
+        std::uint64_t texture_misses = 0;
+        std::uint64_t buffer_hits    = 0;
+        std::uint64_t buffer_misses  = 0;
+        std::size_t   pooled_textures     = 0;
+        std::size_t   pooled_buffers      = 0;
+        std::size_t   pooled_buffer_bytes = 0;
+    };
+    
+    object_pool_counters object_pool_counts();
+    void reset_object_pool_counts();
+    
+    // Must be called on the GPU thread; returns a pooled texture, or generates
+    // a new one if there isn't one of that shape
+    GLuint acquire_texture( texture_shape const& );
+    
+    // Binds `gl_id` to `target` & copies `size` bytes into it, first taking a
+    // buffer from the pool if `gl_id` is 0 & growing the buffer's storage if
+    // `size` is more than `capacity`.  Must be called on the GPU thread.
+    void upload_pooled_buffer_data(
+        GLenum       target,
+        GLuint     & gl_id,
+        std::size_t& capacity,
+        void const*  data,
+        std::size_t  size
+    );
+    
+    // Safe to call from any thread; names of 0 are ignored
+    void release_texture_later( GLuint, texture_shape const& );
+    void release_buffer_later ( GLuint, std::size_t capacity );
+    
+    // Called by `flush_deferred_deletions()` on the GPU thread to return
+    // everything released since the last flush to the pools; names that don't
+    // fit are added to the batch to be deleted
+    void return_released_objects( deferred_deletion_batch& );
+}
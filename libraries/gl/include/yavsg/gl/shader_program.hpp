@@ -3,6 +3,8 @@
 
 #include <yavsg/gl_wrap.hpp>
 
+#include <yavsg/gl/component_types.hpp>
+#include <yavsg/gl/deferred_deletion.hpp>
 #include <yavsg/gl/error.hpp>
 #include "attribute_buffer.hpp"
 // #include "../rendering/shader_variable_names.hpp"
@@ -12,11 +14,13 @@
 
 #include <doctest/doctest.h>    // REQUIRE
 
+#include <array>
 #include <exception>
 #include <limits>
 #include <string>
 #include <tuple>
 #include <type_traits>  // enable_if_t
+#include <vector>
 
 
 namespace JadeMatrix::yavsg::gl // Shader program //////////////////////////////
@@ -58,11 +62,19 @@ namespace JadeMatrix::yavsg::gl // Shader program //////////////////////////////
             std::size_t                  count
         );
         
+        // TODO: Determine if there's a more opaque way to access these
+        GLuint gl_program_id() const;
+        GLuint gl_vao_id() const;
+        
         bool has_attribute( std::string const& name                   );
         bool has_attribute( std::string const& name, GLuint& location );
         bool has_uniform  ( std::string const& name                   );
         bool has_uniform  ( std::string const& name, GLint & location );
         
+        // Cached per string ID; -1 if the variable does not exist
+        template< typename StrID > GLint attribute_location( StrID const& id );
+        template< typename StrID > GLint uniform_location  ( StrID const& id );
+        
         // Return true if the variable exists & could be linked, false if it
         // does not exist, and throws `yavsg::gl::summary_error` if the variable
         // exists but could not be linked.
@@ -103,13 +115,40 @@ namespace JadeMatrix::yavsg::gl // Shader program //////////////////////////////
             StrID const& target_name_id
         );
         
+        // Attaches a named uniform block to a uniform buffer binding point;
+        // returns false if the program has no active block by that name
+        bool bind_uniform_block(
+            std::string const& block_name,
+            GLuint             binding_point
+        );
+        template< typename StrID > bool bind_uniform_block(
+            StrID const& block_name_id,
+            GLuint       binding_point
+        );
+    
     protected:
         GLuint gl_program_id_;
         GLuint gl_vao_id_;
         
+        // Dense tables of variable locations indexed by string ID value,
+        // filled in the first time each ID is used
+        static constexpr GLint unresolved_location = -2;
+        std::vector< GLint > attribute_locations_;
+        std::vector< GLint >   uniform_locations_;
+        
         // OpenGL commands wrapped with error-checking
         void use_program();
         void bind_vao();
+        
+        template< std::size_t Nth > void link_attribute_location(
+            GLuint                       attribute_location,
+            attribute_buffer_type const& dummy_attributes
+        );
+        template< typename T > void set_uniform_location(
+            GLint              uniform_location,
+            T           const& uniform_value,
+            std::string const& uniform_name
+        );
     };
 }
 
@@ -118,22 +157,43 @@ namespace JadeMatrix::yavsg::gl // Attribute traits ////////////////////////////
 {
     template< typename T > struct attribute_traits {};
     
-    template<> struct attribute_traits< GLfloat >
-    {
-        static constexpr GLint  components_per_element = 1;
-        static constexpr GLenum component_type         = GL_FLOAT;
-    };
+    #define DEFINE_ATTRIBUTE_TRAITS( TYPE, GLTYPE ) \
+        template<> struct attribute_traits< TYPE > \
+        { \
+            static constexpr GLint     components_per_element = 1; \
+            static constexpr GLenum    component_type         = GLTYPE; \
+            static constexpr GLboolean normalized             = GL_FALSE; \
+        };
+    
+    // Integer types are converted to floats as-is, so shader inputs are still
+    // `float`/`vecN`
+    DEFINE_ATTRIBUTE_TRAITS( GLbyte  , GL_BYTE           )
+    DEFINE_ATTRIBUTE_TRAITS( GLubyte , GL_UNSIGNED_BYTE  )
+    DEFINE_ATTRIBUTE_TRAITS( GLshort , GL_SHORT          )
+    DEFINE_ATTRIBUTE_TRAITS( GLushort, GL_UNSIGNED_SHORT )
+    DEFINE_ATTRIBUTE_TRAITS( GLint   , GL_INT            )
+    DEFINE_ATTRIBUTE_TRAITS( GLuint  , GL_UNSIGNED_INT   )
+    DEFINE_ATTRIBUTE_TRAITS( GLfloat , GL_FLOAT          )
+    DEFINE_ATTRIBUTE_TRAITS( half    , GL_HALF_FLOAT     )
     
-    template<> struct attribute_traits< GLint >
+    #undef DEFINE_ATTRIBUTE_TRAITS
+    
+    // Integers mapped to [0,1] or [-1,1], e.g. for colors & unit vectors
+    template< typename T > struct attribute_traits< normalized< T > >
     {
-        static constexpr GLint  components_per_element = 1;
-        static constexpr GLenum component_type         = GL_INT;
+        static_assert(
+            attribute_traits< T >::component_type != GL_FLOAT
+            && attribute_traits< T >::component_type != GL_HALF_FLOAT,
+            "only integer attributes can be normalized"
+        );
+        
+        static constexpr GLint components_per_element
+            = attribute_traits< T >::components_per_element;
+        static constexpr GLenum component_type
+            = attribute_traits< T >::component_type;
+        static constexpr GLboolean normalized = GL_TRUE;
     };
     
-    // TODO: more basic types, see
-    //      https://www.khronos.org/opengl/wiki/OpenGL_Type
-    //      http://docs.gl/gl3/glVertexAttribPointer
-    
     template< typename T, unsigned int D >
     struct attribute_traits< vector< T, D > >
     {
@@ -141,6 +201,21 @@ namespace JadeMatrix::yavsg::gl // Attribute traits ////////////////////////////
             = attribute_traits< T >::components_per_element * D;
         static constexpr GLenum component_type
             = attribute_traits< T >::component_type;
+        static constexpr GLboolean normalized
+            = attribute_traits< T >::normalized;
+    };
+    
+    // For components `vector<>` can't do math on, like `normalized<>`
+    template< typename T, std::size_t D >
+    struct attribute_traits< std::array< T, D > >
+    {
+        static constexpr GLint components_per_element
+            = attribute_traits< T >::components_per_element
+            * static_cast< GLint >( D );
+        static constexpr GLenum component_type
+            = attribute_traits< T >::component_type;
+        static constexpr GLboolean normalized
+            = attribute_traits< T >::normalized;
     };
 }
 
@@ -234,8 +309,8 @@ JadeMatrix::yavsg::gl::shader_program<
     Framebuffer
 >::~shader_program()
 {
-    gl::DeleteProgram( gl_program_id_ );
-    gl::DeleteVertexArrays( 1, &gl_vao_id_ );
+    delete_program_later     ( gl_program_id_ );
+    delete_vertex_array_later( gl_vao_id_     );
 }
 
 template< class AttributeBuffer, class Framebuffer >
@@ -266,7 +341,7 @@ void JadeMatrix::yavsg::gl::shader_program<
     // like way
     attribute_buffer_type const& buffer_ref =
         const_cast< attribute_buffer_type& >(  buffer );
-    
+        
     gl::BindBuffer( GL_ARRAY_BUFFER, buffer_ref.gl_buffer_id() );
     
     if( count + start > buffer.size() )
@@ -327,6 +402,24 @@ void JadeMatrix::yavsg::gl::shader_program<
     );
 }
 
+template< class AttributeBuffer, class Framebuffer >
+GLuint JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::gl_program_id() const
+{
+    return gl_program_id_;
+}
+
+template< class AttributeBuffer, class Framebuffer >
+GLuint JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::gl_vao_id() const
+{
+    return gl_vao_id_;
+}
+
 template< class AttributeBuffer, class Framebuffer >
 bool JadeMatrix::yavsg::gl::shader_program<
     AttributeBuffer,
@@ -395,6 +488,54 @@ bool JadeMatrix::yavsg::gl::shader_program<
     }
 }
 
+template< class AttributeBuffer, class Framebuffer >
+template< typename StrID >
+GLint JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::attribute_location( StrID const& id )
+{
+    auto const index = static_cast< std::size_t >( id );
+    if( index >= attribute_locations_.size() )
+    {
+        attribute_locations_.resize( index + 1, unresolved_location );
+    }
+    
+    auto& location = attribute_locations_[ index ];
+    if( location == unresolved_location )
+    {
+        location = gl::GetAttribLocation(
+            gl_program_id_,
+            shader_string( id ).c_str()
+        );
+    }
+    return location;
+}
+
+template< class AttributeBuffer, class Framebuffer >
+template< typename StrID >
+GLint JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::uniform_location( StrID const& id )
+{
+    auto const index = static_cast< std::size_t >( id );
+    if( index >= uniform_locations_.size() )
+    {
+        uniform_locations_.resize( index + 1, unresolved_location );
+    }
+    
+    auto& location = uniform_locations_[ index ];
+    if( location == unresolved_location )
+    {
+        location = gl::GetUniformLocation(
+            gl_program_id_,
+            shader_string( id ).c_str()
+        );
+    }
+    return location;
+}
+
 template< class AttributeBuffer, class Framebuffer >
 template< std::size_t Nth >
 bool JadeMatrix::yavsg::gl::shader_program<
@@ -411,6 +552,43 @@ bool JadeMatrix::yavsg::gl::shader_program<
         return false;
     }
     
+    link_attribute_location< Nth >( attribute_location, dummy_attributes );
+    return true;
+}
+
+template< class AttributeBuffer, class Framebuffer >
+template< std::size_t Nth, typename StrID >
+bool JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::link_attribute(
+    StrID                 const& attribute_name_id,
+    attribute_buffer_type const& dummy_attributes
+)
+{
+    auto const location = attribute_location( attribute_name_id );
+    if( location == -1 )
+    {
+        return false;
+    }
+    
+    link_attribute_location< Nth >(
+        static_cast< GLuint >( location ),
+        dummy_attributes
+    );
+    return true;
+}
+
+template< class AttributeBuffer, class Framebuffer >
+template< std::size_t Nth >
+void JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::link_attribute_location(
+    GLuint                       attribute_location,
+    attribute_buffer_type const& dummy_attributes
+)
+{
     bind_vao();
     
     attribute_buffer_type& buffer_ref = const_cast<
@@ -435,28 +613,10 @@ bool JadeMatrix::yavsg::gl::shader_program<
         attribute_location,
         attribute_traits< attribute_type >::components_per_element,
         attribute_traits< attribute_type >::component_type,
-        GL_FALSE,
+        attribute_traits< attribute_type >::normalized,
         sizeof( tuple_type ),
         reinterpret_cast< const void* >( offset_of_attribute )
     );
-    
-    return true;
-}
-
-template< class AttributeBuffer, class Framebuffer >
-template< std::size_t Nth, typename StrID >
-bool JadeMatrix::yavsg::gl::shader_program<
-    AttributeBuffer,
-    Framebuffer
->::link_attribute(
-    StrID                 const& attribute_name_id,
-    attribute_buffer_type const& dummy_attributes
-)
-{
-    return link_attribute< Nth >(
-        shader_string( attribute_name_id ),
-        dummy_attributes
-    );
 }
 
 template< class AttributeBuffer, class Framebuffer >
@@ -474,13 +634,7 @@ bool JadeMatrix::yavsg::gl::shader_program<
     {
         return false;
     }
-    use_program();
-    set_current_program_uniform< T >(
-        uniform_location,
-        uniform_value,
-        uniform_name,
-        gl_program_id_
-    );
+    set_uniform_location( uniform_location, uniform_value, uniform_name );
     return true;
 }
 
@@ -494,7 +648,37 @@ bool JadeMatrix::yavsg::gl::shader_program<
     T     const& uniform_value
 )
 {
-    return set_uniform( shader_string( uniform_name_id ), uniform_value );
+    auto const location = uniform_location( uniform_name_id );
+    if( location == -1 )
+    {
+        return false;
+    }
+    set_uniform_location(
+        location,
+        uniform_value,
+        shader_string( uniform_name_id )
+    );
+    return true;
+}
+
+template< class AttributeBuffer, class Framebuffer >
+template< typename T >
+void JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::set_uniform_location(
+    GLint              uniform_location,
+    T           const& uniform_value,
+    std::string const& uniform_name
+)
+{
+    use_program();
+    set_current_program_uniform< T >(
+        uniform_location,
+        uniform_value,
+        uniform_name,
+        gl_program_id_
+    );
 }
 
 template< class AttributeBuffer, class Framebuffer >
@@ -524,6 +708,40 @@ void JadeMatrix::yavsg::gl::shader_program<
     return bind_target< Nth >( shader_string( target_name_id ) );
 }
 
+template< class AttributeBuffer, class Framebuffer >
+bool JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::bind_uniform_block(
+    std::string const& block_name,
+    GLuint             binding_point
+)
+{
+    auto const block_index = gl::GetUniformBlockIndex(
+        gl_program_id_,
+        block_name.c_str()
+    );
+    if( block_index == GL_INVALID_INDEX )
+    {
+        return false;
+    }
+    gl::UniformBlockBinding( gl_program_id_, block_index, binding_point );
+    return true;
+}
+
+template< class AttributeBuffer, class Framebuffer >
+template< typename StrID >
+bool JadeMatrix::yavsg::gl::shader_program<
+    AttributeBuffer,
+    Framebuffer
+>::bind_uniform_block(
+    StrID const& block_name_id,
+    GLuint       binding_point
+)
+{
+    return bind_uniform_block( shader_string( block_name_id ), binding_point );
+}
+
 
 // Uniform-set specializations /////////////////////////////////////////////////
 
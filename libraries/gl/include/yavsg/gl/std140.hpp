@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+#include <yavsg/math/matrix.hpp>
+#include <yavsg/math/vector.hpp>
+
+#include <cstddef>  // size_t, byte
+#include <cstring>  // memcpy
+
+
+// Base alignment, size, & packing of types as laid out in `std140` uniform
+// blocks (see "Standard Uniform Block Layout" in the OpenGL specification), so
+// that block layouts can be computed at compile time from C++ types.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    template< typename T > struct std140_traits {};
+    
+    template< typename T > struct std140_scalar_traits
+    {
+        static constexpr std::size_t alignment = sizeof( T );
+        static constexpr std::size_t size      = sizeof( T );
+        
+        static void write( std::byte* destination, T const& value )
+        {
+            std::memcpy( destination, &value, sizeof( T ) );
+        }
+    };
+    
+    template<> struct std140_traits< GLfloat >
+        : std140_scalar_traits< GLfloat > {};
+    template<> struct std140_traits< GLint >
+        : std140_scalar_traits< GLint > {};
+    template<> struct std140_traits< GLuint >
+        : std140_scalar_traits< GLuint > {};
+    
+    // 3-component vectors are aligned like 4-component vectors but don't take
+    // up the extra space, so a scalar can follow one directly
+    template< typename T, unsigned int D >
+    struct std140_traits< vector< T, D > >
+    {
+        static_assert( D >= 2 && D <= 4, "GLSL vectors have 2-4 components" );
+        
+        static constexpr std::size_t alignment = (
+            std140_traits< T >::alignment * ( D == 3 ? 4 : D )
+        );
+        static constexpr std::size_t size = std140_traits< T >::size * D;
+        
+        static void write( std::byte* destination, vector< T, D > const& value )
+        {
+            std::memcpy( destination, value.data(), size );
+        }
+    };
+    
+    // Matrices are stored as arrays of column vectors, & array elements are
+    // always padded out to the alignment of a 4-component vector
+    template< typename T, unsigned int D >
+    struct std140_traits< square_matrix< T, D > >
+    {
+        static constexpr std::size_t column_stride = (
+            std140_traits< vector< T, 4 > >::alignment
+        );
+        static constexpr std::size_t alignment = column_stride;
+        static constexpr std::size_t size      = column_stride * D;
+        
+        static void write(
+            std::byte*                   destination,
+            square_matrix< T, D > const& value
+        )
+        {
+            for( unsigned int column = 0; column < D; ++column )
+            {
+                std::memcpy(
+                    destination + column * column_stride,
+                    value[ column ].data(),
+                    sizeof( T ) * D
+                );
+            }
+        }
+    };
+}
@@ -1,11 +1,18 @@
 #pragma once
 
 
+#include <yavsg/gl/deferred_deletion.hpp>
 #include <yavsg/gl/error.hpp>
+#include <yavsg/gl/object_pool.hpp>
+#include <yavsg/gl/texture_compression.hpp>
 #include "texture_utilities.hpp"
 
+#include <doctest/doctest.h>    // REQUIRE
+
 #include <array>
 #include <cstddef>      // byte
+#include <limits>
+#include <optional>
 #include <string>
 #include <type_traits>  // enable_if
 
@@ -51,6 +58,19 @@ namespace JadeMatrix::yavsg::gl
         // void wrapping( ... );
         void filtering( texture_filter_settings const& );
         
+        // Replaces a region of the base level in place rather than
+        // re-specifying the whole texture, for textures that change after
+        // they're created.  `data` is tightly packed in the texture's incoming
+        // format & isn't preprocessed; must be called on the GPU thread.
+        void update(
+            std::size_t      x,
+            std::size_t      y,
+            std::size_t      width,
+            std::size_t      height,
+            std::byte const* data,
+            bool             regenerate_mipmaps = false
+        );
+        
         template<
             std::size_t ActiveTexture,
             typename    = std::enable_if_t<
@@ -61,11 +81,21 @@ namespace JadeMatrix::yavsg::gl
             gl::ActiveTexture( GL_TEXTURE0 + ActiveTexture );
             gl::BindTexture( GL_TEXTURE_2D, gl_id_ );
         }
-        
+    
     protected:
         GLuint gl_id_ = default_texture_gl_id;
         
+        // Set for textures taken from the pool, which go back to it when
+        // destroyed
+        std::optional< texture_shape > pool_shape_;
+        
+        // Only set while the texture has just its base level & could still
+        // have the rest generated; levels that were uploaded, already
+        // generated, or fixed by immutable storage are never regenerated
+        bool generate_mipmaps_ = false;
+        
         texture();
+        texture( texture_shape const& );
     };
     
     template<
@@ -89,12 +119,25 @@ JadeMatrix::yavsg::gl::texture< DataType, Channels >::texture()
     gl::GenTextures( 1, &gl_id_ );
 }
 
+template< typename DataType, std::size_t Channels >
+JadeMatrix::yavsg::gl::texture< DataType, Channels >::texture(
+    texture_shape const& shape
+) :
+    gl_id_     { acquire_texture( shape ) },
+    pool_shape_{ shape                    }
+{}
+
 template< typename DataType, std::size_t Channels >
 JadeMatrix::yavsg::gl::texture< DataType, Channels >::~texture()
 {
-    if( gl_id_ != default_texture_gl_id )
+    // May be destroyed on any thread
+    if( pool_shape_ )
     {
-        gl::DeleteTextures( 1, &gl_id_ );
+        release_texture_later( gl_id_, *pool_shape_ );
+    }
+    else
+    {
+        delete_texture_later( gl_id_ );
     }
 }
 
@@ -117,21 +160,26 @@ JadeMatrix::yavsg::gl::texture< DataType, Channels >::texture(
     texture_flags_type             flags
 ) : texture()
 {
-    upload_texture_data(
-        gl_id_,
-        process_texture_data(
-            texture_upload_data{
-                format_traits::gl_internal_format,
-                width,
-                height,
-                format_traits::gl_incoming_format,
-                format_traits::gl_incoming_type,
-                std::move( data )
-            },
-            flags
-        ),
+    auto upload_data = process_texture_data(
+        texture_upload_data{
+            format_traits::gl_internal_format,
+            width,
+            height,
+            format_traits::gl_incoming_format,
+            format_traits::gl_incoming_type,
+            std::move( data ),
+            {}
+        },
+        flags,
         settings
     );
+    generate_mipmaps_ = (
+        settings.mipmaps == texture_filter_settings::mipmap_type::none
+        && upload_data.mipmaps.empty()
+        && !is_block_compressed_format( upload_data.gl_internal_format )
+        && !immutable_texture_storage_supported()
+    );
+    upload_texture_data( gl_id_, std::move( upload_data ), settings );
 }
 
 template< typename DataType, std::size_t Channels >
@@ -139,7 +187,9 @@ JadeMatrix::yavsg::gl::texture< DataType, Channels >::texture(
     texture< DataType, Channels >&& o
 )
 {
-    std::swap( gl_id_, o.gl_id_ );
+    std::swap( gl_id_           , o.gl_id_            );
+    std::swap( pool_shape_      , o.pool_shape_       );
+    std::swap( generate_mipmaps_, o.generate_mipmaps_ );
 }
 
 template< typename DataType, std::size_t Channels >
@@ -155,5 +205,42 @@ void JadeMatrix::yavsg::gl::texture< DataType, Channels >::filtering(
 {
     gl::BindTexture( GL_TEXTURE_2D, gl_id_ );
     
-    set_bound_texture_filtering( settings );
+    set_bound_texture_filtering( settings, generate_mipmaps_ );
+    if( settings.mipmaps != texture_filter_settings::mipmap_type::none )
+    {
+        generate_mipmaps_ = false;
+    }
+}
+
+template< typename DataType, std::size_t Channels >
+void JadeMatrix::yavsg::gl::texture< DataType, Channels >::update(
+    std::size_t      x,
+    std::size_t      y,
+    std::size_t      width,
+    std::size_t      height,
+    std::byte const* data,
+    bool             regenerate_mipmaps
+)
+{
+    REQUIRE( x + width  <= std::numeric_limits< GLsizei >::max() );
+    REQUIRE( y + height <= std::numeric_limits< GLsizei >::max() );
+    
+    gl::BindTexture( GL_TEXTURE_2D, gl_id_ );
+    gl::PixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    gl::TexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        static_cast< GLint   >( x      ),
+        static_cast< GLint   >( y      ),
+        static_cast< GLsizei >( width  ),
+        static_cast< GLsizei >( height ),
+        format_traits::gl_incoming_format,
+        format_traits::gl_incoming_type,
+        data
+    );
+    
+    if( regenerate_mipmaps )
+    {
+        gl::GenerateMipmap( GL_TEXTURE_2D );
+    }
 }
@@ -0,0 +1,132 @@
+#pragma once
+
+
+#include <yavsg/gl/deferred_deletion.hpp>
+#include <yavsg/gl/error.hpp>
+#include <yavsg/gl/object_pool.hpp>
+#include "texture_utilities.hpp"
+
+#include <cstddef>      // size_t
+#include <optional>
+#include <type_traits>  // enable_if
+#include <utility>      // swap
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    // A `GL_TEXTURE_2D_ARRAY` whose layers all share one size & format, so
+    // that any of them can be sampled without rebinding; see
+    // `texture_array_packer` for building these from separate image files
+    template<
+        typename    DataType,
+        std::size_t Channels
+    > class texture_array
+    {
+        friend class yavsg::upload_texture_array_task< DataType, Channels >;
+        
+    public:
+        using format_traits = texture_format_traits< DataType, Channels >;
+        
+        using                 sample_type = DataType;
+        static constexpr auto channels    = Channels;
+        
+        texture_array( texture_array&& );
+        
+        ~texture_array();
+        
+        // Disable copy & assignment
+        texture_array( texture_array const& ) = delete;
+        texture_array& operator=( texture_array const& ) = delete;
+        
+        GLuint gl_texture_id() const;
+        std::size_t layers() const;
+        
+        template<
+            std::size_t ActiveTexture,
+            typename    = std::enable_if_t<
+                ( ActiveTexture < GL_MAX_TEXTURE_UNITS )
+            >
+        > void bind_as() const
+        {
+            gl::ActiveTexture( GL_TEXTURE0 + ActiveTexture );
+            gl::BindTexture( GL_TEXTURE_2D_ARRAY, gl_id_ );
+        }
+    
+    protected:
+        GLuint      gl_id_  = default_texture_gl_id;
+        std::size_t layers_ = 0;
+        
+        // Set for arrays taken from the pool, which go back to it when
+        // destroyed
+        std::optional< texture_shape > pool_shape_;
+        
+        texture_array();
+        texture_array( texture_shape const& );
+    };
+    
+    template<
+        std::size_t ActiveTexture,
+        typename    = std::enable_if_t<
+            ( ActiveTexture < GL_MAX_TEXTURE_UNITS )
+        >
+    > void unbind_texture_array()
+    {
+        gl::ActiveTexture( GL_TEXTURE0 + ActiveTexture );
+        gl::BindTexture( GL_TEXTURE_2D_ARRAY, 0 );
+    }
+}
+
+
+// Texture array class implementation //////////////////////////////////////////
+
+template< typename DataType, std::size_t Channels >
+JadeMatrix::yavsg::gl::texture_array< DataType, Channels >::texture_array()
+{
+    gl::GenTextures( 1, &gl_id_ );
+}
+
+template< typename DataType, std::size_t Channels >
+JadeMatrix::yavsg::gl::texture_array< DataType, Channels >::texture_array(
+    texture_shape const& shape
+) :
+    gl_id_     { acquire_texture( shape ) },
+    pool_shape_{ shape                    }
+{}
+
+template< typename DataType, std::size_t Channels >
+JadeMatrix::yavsg::gl::texture_array< DataType, Channels >::~texture_array()
+{
+    // May be destroyed on any thread
+    if( pool_shape_ )
+    {
+        release_texture_later( gl_id_, *pool_shape_ );
+    }
+    else
+    {
+        delete_texture_later( gl_id_ );
+    }
+}
+
+template< typename DataType, std::size_t Channels >
+JadeMatrix::yavsg::gl::texture_array< DataType, Channels >::texture_array(
+    texture_array< DataType, Channels >&& o
+)
+{
+    std::swap( gl_id_     , o.gl_id_      );
+    std::swap( layers_    , o.layers_     );
+    std::swap( pool_shape_, o.pool_shape_ );
+}
+
+template< typename DataType, std::size_t Channels >
+GLuint
+JadeMatrix::yavsg::gl::texture_array< DataType, Channels >::gl_texture_id() const
+{
+    return gl_id_;
+}
+
+template< typename DataType, std::size_t Channels >
+std::size_t
+JadeMatrix::yavsg::gl::texture_array< DataType, Channels >::layers() const
+{
+    return layers_;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include "texture_utilities.hpp"
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <cstddef>  // size_t, byte
+
+
+// CPU encoders for the BCn block-compressed formats, meant for cooking
+// textures ahead of time (see `programs/texture_cook/`) rather than for use
+// while loading, & decoders for loading them where the driver can't.  Every
+// format works on 4x4 blocks of pixels; partial blocks at the right & bottom
+// edges are padded by repeating the last row/column.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    enum class block_compression
+    {
+        bc1,    // RGB, 4 bits/pixel
+        bc3,    // RGBA, 8 bits/pixel (BC1 color + BC4 alpha)
+        bc4,    // R, 4 bits/pixel
+        bc5,    // RG, 8 bits/pixel (two BC4 channels); good for normal maps
+        bc7     // RGBA, 8 bits/pixel; best quality for color
+    };
+    
+    // Throws `std::invalid_argument` for sRGB BC4/BC5, which don't exist
+    GLint block_compressed_internal_format(
+        block_compression compression,
+        bool              srgb
+    );
+    
+    bool is_block_compressed_format( GLint gl_internal_format );
+    
+    // Whether the driver can upload data in a block-compressed format; S3TC
+    // (BC1/BC3) & BPTC (BC7) are extensions, & sRGB S3TC needs another
+    bool block_compressed_format_supported( GLint gl_internal_format );
+    
+    // Size in bytes of one image in a block-compressed format, or 0 if the
+    // format isn't block-compressed
+    std::size_t block_compressed_size(
+        GLint       gl_internal_format,
+        std::size_t width,
+        std::size_t height
+    );
+    
+    // Compresses preprocessed 8-bit data (see `process_texture_data()`) &
+    // all its mip levels; channels missing from the incoming format are read
+    // as 0, or 100% for alpha.  The result's incoming format & type are 0, as
+    // OpenGL doesn't use them for compressed data.
+    texture_upload_data compress_texture_data(
+        texture_upload_data upload_data,
+        block_compression   compression,
+        bool                srgb
+    );
+    
+    // Decodes block-compressed data & all its mip levels to 8-bit data with
+    // as many channels as the format has (4 for BC1, BC3, & BC7), keeping
+    // sRGB formats sRGB; for drivers that don't support the format (see
+    // `block_compressed_format_supported()`).  Throws `std::invalid_argument`
+    // if the data isn't block-compressed.
+    texture_upload_data decompress_texture_data(
+        texture_upload_data upload_data
+    );
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+
+#include "texture_utilities.hpp"
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <chrono>
+#include <cstddef>  // size_t
+#include <vector>
+
+
+// Texture data is streamed to OpenGL through a small ring of pixel buffer
+// objects rather than uploaded with one `glTexImage2D()` per texture, so a burst
+// of finished loads can't stall a frame.  Each chunk of rows is copied into the
+// next free buffer & transferred from there; a fence per buffer tells when the
+// transfer has finished & the buffer can be reused without waiting on the GPU.
+//
+// The GPU thread only spends a limited number of bytes & amount of time on
+// uploads between calls to `begin_texture_upload_frame()`; large textures are
+// split across as many frames as needed.  Everything here except the budget
+// setter must be used on the GPU thread.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    struct texture_upload_budget
+    {
+        // A budget of 0 doesn't limit that measure
+        std::size_t               bytes_per_frame;
+        std::chrono::microseconds time_per_frame;
+    };
+    
+    // Defaults to 16 MiB & 2 ms per frame
+    void set_texture_upload_budget( texture_upload_budget const& );
+    texture_upload_budget texture_upload_budget_setting();
+    
+    // Resets the bytes & time spent on uploads; called once per frame
+    void begin_texture_upload_frame();
+    
+    // Whether any more uploading fits in the current frame's budget
+    bool texture_upload_budget_left();
+    
+    // Incrementally uploads the data for one texture, or for every layer of a
+    // texture array, into a texture object that already exists.  Mip levels
+    // are uploaded smallest first, each one raising the texture's detail as
+    // soon as it's done, down to the target level.  By default the data is
+    // kept so a texture can later be streamed back in after its largest levels
+    // have been evicted to save memory; if it can be loaded again instead, see
+    // `discard_uploaded_data()`.
+    class texture_upload_stream
+    {
+    public:
+        texture_upload_stream(
+            GLuint                         gl_id,
+            texture_upload_data            upload_data,
+            texture_filter_settings const& settings
+        );
+        // Every layer must match like for `upload_texture_array_data()`
+        texture_upload_stream(
+            GLuint                             gl_id,
+            std::vector< texture_upload_data > layers,
+            texture_filter_settings     const& settings
+        );
+        
+        texture_upload_stream( texture_upload_stream&& ) = default;
+        texture_upload_stream& operator=( texture_upload_stream&& ) = default;
+        
+        // Uploads as much as the current frame's budget allows; returns true
+        // once every level down to the target level is ready to sample
+        bool upload_some();
+        
+        bool finished() const;
+        
+        GLuint gl_texture_id() const;
+        
+        std::size_t level_count() const;
+        std::size_t level_width ( std::size_t level ) const;
+        std::size_t level_height( std::size_t level ) const;
+        
+        // Approximate GPU memory used by one level across all layers, & by all
+        // levels with storage allocated (including any partially uploaded)
+        std::size_t level_bytes( std::size_t level ) const;
+        std::size_t allocated_bytes() const;
+        
+        // The largest level that can be sampled, or `level_count()` if none
+        // are ready yet
+        std::size_t resident_level() const;
+        
+        // Defaults to 0 (full detail).  Raising the target above the resident
+        // level immediately frees every larger level; lowering it lets
+        // `upload_some()` stream them back in.
+        std::size_t target_level() const;
+        void target_level( std::size_t );
+        
+        // Frees the data of every level that's resident, & of every level
+        // from then on as soon as it is.  Once such a level is evicted its
+        // data has to be given back with `restore_data()` before lowering the
+        // target level again.
+        void discard_uploaded_data();
+        
+        // Whether every layer still has its data for that level
+        bool level_data_available( std::size_t level ) const;
+        
+        // Fills in the levels whose data was discarded from freshly-loaded
+        // layers, which must match the original ones like for the array
+        // constructor or this throws `std::invalid_argument`
+        void restore_data( std::vector< texture_upload_data > layers );
+        
+    protected:
+        GLuint                             gl_id_;
+        GLenum                             target_;
+        std::vector< texture_upload_data > layers_;
+        texture_filter_settings            settings_;
+        bool                               compressed_;
+        bool                               discard_uploaded_ = false;
+        
+        // Levels are counted from 0 (largest) like in OpenGL, so each of
+        // these decreases as more detail is uploaded
+        std::size_t target_level_    = 0;
+        std::size_t resident_level_;
+        std::size_t allocated_level_;
+        
+        // Position in the level being uploaded, advanced row by row (or block
+        // row by block row) through each layer
+        std::size_t layer_ = 0;
+        std::size_t row_   = 0;
+        
+        void allocate_level( std::size_t level );
+        void release_level ( std::size_t level );
+        void finish_level  ( std::size_t level );
+        
+        texture_data_pointer& level_data(
+            texture_upload_data& layer,
+            std::size_t          level
+        );
+    };
+}
@@ -2,11 +2,14 @@
 
 
 #include <yavsg/gl_wrap.hpp>
+#include <yavsg/gl/component_types.hpp>
 #include <yavsg/sdl/sdl.hpp>
 
-#include <cstddef>  // size_t, byte
+#include <cstddef>      // size_t, byte
+#include <functional>
 #include <string>
-#include <memory>   // unique_ptr
+#include <memory>       // unique_ptr
+#include <vector>
 
 
 namespace JadeMatrix::yavsg // Class prototypes ////////////////////////////////
@@ -32,7 +35,7 @@ namespace JadeMatrix::yavsg // Class prototypes ////////////////////////////////
     template<
         typename    DataType,
         std::size_t Channels
-    >class destroy_texture_data_task;
+    >class upload_texture_array_task;
 }
 
 
@@ -63,19 +66,48 @@ namespace JadeMatrix::yavsg::gl // Texture format traits ///////////////////////
     DEFINE_TEXTURE_FORMAT_TRAITS_SINGLE( TYPE, 2, GL_RG  , TYPESEQ, TYPENAME, GL_RG   ) \
     DEFINE_TEXTURE_FORMAT_TRAITS_SINGLE( TYPE, 3, GL_RGB , TYPESEQ, TYPENAME, GL_RGB  ) \
     DEFINE_TEXTURE_FORMAT_TRAITS_SINGLE( TYPE, 4, GL_RGBA, TYPESEQ, TYPENAME, GL_RGBA )
-
+    
     DEFINE_TEXTURE_FORMAT_TRAITS( GLbyte  ,  8I , GL_BYTE           )
     DEFINE_TEXTURE_FORMAT_TRAITS( GLubyte ,  8UI, GL_UNSIGNED_BYTE  )
     DEFINE_TEXTURE_FORMAT_TRAITS( GLshort , 16I , GL_SHORT          )
     DEFINE_TEXTURE_FORMAT_TRAITS( GLushort, 16UI, GL_UNSIGNED_SHORT )
     DEFINE_TEXTURE_FORMAT_TRAITS( GLint   , 32I , GL_INT            )
     DEFINE_TEXTURE_FORMAT_TRAITS( GLuint  , 32UI, GL_UNSIGNED_INT   )
-    // DEFINE_TEXTURE_FORMAT_TRAITS( GLhalf  , 16F , GL_HALF_FLOAT     )
     DEFINE_TEXTURE_FORMAT_TRAITS( GLfloat , 32F , GL_FLOAT          )
     // DEFINE_TEXTURE_FORMAT_TRAITS( GLdouble, 64F , GL_DOUBLE         )
     
+    // Half-float textures take `GLfloat` data, which is converted by
+    // `process_texture_data()` after preprocessing rather than on upload
+    DEFINE_TEXTURE_FORMAT_TRAITS( half    , 16F , GL_FLOAT          )
+    
+    DEFINE_TEXTURE_FORMAT_TRAITS( normalized< GLubyte  >,  8, GL_UNSIGNED_BYTE  )
+    DEFINE_TEXTURE_FORMAT_TRAITS( normalized< GLushort >, 16, GL_UNSIGNED_SHORT )
+    
     #undef DEFINE_TEXTURE_FORMAT_TRAITS
     #undef DEFINE_TEXTURE_FORMAT_TRAITS_SINGLE
+    
+    template<> struct texture_format_traits< srgb, 3 >
+    {
+        static constexpr GLint  gl_internal_format = GL_SRGB8;
+        static constexpr GLenum gl_incoming_format = GL_RGB;
+        static constexpr GLenum gl_incoming_type   = GL_UNSIGNED_BYTE;
+    };
+    
+    template<> struct texture_format_traits< srgb, 4 >
+    {
+        static constexpr GLint  gl_internal_format = GL_SRGB8_ALPHA8;
+        static constexpr GLenum gl_incoming_format = GL_RGBA;
+        static constexpr GLenum gl_incoming_type   = GL_UNSIGNED_BYTE;
+    };
+    
+    template<> struct texture_format_traits< rgb10_a2, 4 >
+    {
+        static constexpr GLint  gl_internal_format = GL_RGB10_A2;
+        static constexpr GLenum gl_incoming_format = GL_RGBA;
+        static constexpr GLenum gl_incoming_type   = (
+            GL_UNSIGNED_INT_2_10_10_10_REV
+        );
+    };
 }
 
 
@@ -122,32 +154,84 @@ namespace JadeMatrix::yavsg::gl // Texture configuration types /////////////////
 
 namespace JadeMatrix::yavsg::gl // Upload utilities ////////////////////////////
 {
+    // Texture data may be owned by something other than `new[]`, such as an
+    // adopted SDL surface, so it carries its own deleter
+    using texture_data_pointer = std::unique_ptr<
+        std::byte[],
+        std::function< void( std::byte* ) >
+    >;
+    
+    // Allocates uninitialized texture data; large buffers are recycled
+    // through a pool when freed, so loading a texture of a similar size can
+    // reuse one instead of faulting in fresh pages
+    texture_data_pointer make_texture_data( std::size_t size );
+    
     struct texture_upload_data
     {
-        GLint                          gl_internal_format;
-        std::size_t                    width;
-        std::size_t                    height;
-        GLenum                         gl_incoming_format;
-        GLenum                         gl_incoming_type;
-        std::unique_ptr< std::byte[] > data;
+        GLint                gl_internal_format;
+        std::size_t          width;
+        std::size_t          height;
+        GLenum               gl_incoming_format;
+        GLenum               gl_incoming_type;
+        texture_data_pointer data;
+        
+        // Mip levels 1 and up, each half the size of the previous one; empty
+        // if mipmaps weren't generated on the CPU
+        std::vector< texture_data_pointer > mipmaps;
     };
     
+    // If the settings call for mipmaps, the full mip chain is generated here
+    // (on task workers) from the preprocessed, linear data rather than left to
+    // `glGenerateMipmap()` on the GPU thread
     texture_upload_data process_texture_data(
-        texture_upload_data upload_data,
-        texture_flags_type  flags
+        texture_upload_data            upload_data,
+        texture_flags_type             flags,
+        texture_filter_settings const& settings
     );
+    // Takes ownership of the surface, which is either adopted as-is or
+    // converted directly into the returned data
     texture_upload_data process_texture_data(
         // Not `const` due to the SDL API
-        SDL_Surface      * sdl_surface,
-        texture_flags_type flags,
-        GLint              gl_internal_format
+        SDL_Surface                  * sdl_surface,
+        texture_flags_type             flags,
+        texture_filter_settings const& settings,
+        GLint                          gl_internal_format
     );
     
+    // Size in bytes of one row of `width` pixels in the data's incoming format
+    // & type, or of one row of 4x4 blocks if the data is block-compressed
+    std::size_t incoming_row_size(
+        texture_upload_data const& upload_data,
+        std::size_t                width
+    );
+    
+    // Whether `ARB_texture_storage` (core in OpenGL 4.2) is available
+    bool immutable_texture_storage_supported();
+    
+    // Where immutable storage is supported, the texture is allocated once
+    // with exactly as many levels as it will have & then filled in, so it
+    // must not have been given any storage before; regions of it can still be
+    // updated in place with `glTexSubImage2D()`
     void upload_texture_data(
         GLuint                         gl_id,
         texture_upload_data            upload_data,
         texture_filter_settings const& settings
     );
     
-    void set_bound_texture_filtering( texture_filter_settings const& settings );
+    // Uploads each element of `layers` as one layer of a `GL_TEXTURE_2D_ARRAY`;
+    // every layer must have the same formats, size, & number of mip levels, or
+    // this throws `std::invalid_argument`
+    void upload_texture_array_data(
+        GLuint                             gl_id,
+        std::vector< texture_upload_data > layers,
+        texture_filter_settings     const& settings
+    );
+    
+    // Mipmaps are only generated by OpenGL if `generate_mipmaps` is set, e.g.
+    // when the mip levels weren't uploaded explicitly
+    void set_bound_texture_filtering(
+        texture_filter_settings const& settings,
+        bool                           generate_mipmaps = true,
+        GLenum                         target           = GL_TEXTURE_2D
+    );
 }
@@ -0,0 +1,159 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+#include <yavsg/gl/deferred_deletion.hpp>
+
+#include <array>
+#include <cstddef>      // size_t, byte
+#include <cstring>      // memcmp, memcpy
+#include <type_traits>  // is_trivially_copyable_v
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    // Ring of uniform buffer slots holding one `Block` each, which must match
+    // the `std140` layout of the shader-side uniform block.  Each `update()`
+    // writes the next slot & binds it to the buffer's binding point, so data
+    // still in use by earlier draws is never overwritten in place; updates
+    // with unchanged data are skipped entirely.
+    template< typename Block, std::size_t RingSize = 3 > class uniform_buffer
+    {
+    public:
+        static_assert(
+            std::is_trivially_copyable_v< Block >,
+            "uniform block data must be trivially copyable"
+        );
+        static_assert( RingSize > 0, "uniform buffer ring can't be empty" );
+        
+        uniform_buffer( GLuint binding_point );
+        uniform_buffer( uniform_buffer const& ) = delete;
+        
+        ~uniform_buffer();
+        
+        // Returns false if the block was unchanged & nothing was uploaded
+        bool update( Block const& data );
+        
+        // Re-binds the current slot, e.g. after something else used the same
+        // binding point
+        void bind() const;
+        
+        GLuint binding_point() const;
+        // Offset of the most recently updated slot, for binding it elsewhere
+        GLintptr current_offset() const;
+        // TODO: Determine if there's a more opaque way to access this
+        GLuint gl_buffer_id() const;
+        
+    protected:
+        GLuint      gl_id_ = 0;
+        GLuint      binding_point_;
+        std::size_t slot_stride_;
+        std::size_t current_slot_;
+        bool        has_data_;
+        
+        std::array< std::byte, sizeof( Block ) > last_data_;
+    };
+}
+
+
+// Uniform buffer implementation ///////////////////////////////////////////////
+
+template< typename Block, std::size_t RingSize >
+JadeMatrix::yavsg::gl::uniform_buffer< Block, RingSize >::uniform_buffer(
+    GLuint binding_point
+) :
+    binding_point_{ binding_point },
+    current_slot_{ RingSize - 1 },
+    has_data_{ false }
+{
+    // Bound ranges have to start on an implementation-defined alignment
+    GLint alignment = 1;
+    gl::GetIntegerv( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment );
+    auto const align = static_cast< std::size_t >(
+        alignment > 0 ? alignment : 1
+    );
+    slot_stride_ = ( ( sizeof( Block ) + align - 1 ) / align ) * align;
+    
+    gl::GenBuffers( 1, &gl_id_ );
+    gl::BindBuffer( GL_UNIFORM_BUFFER, gl_id_ );
+    gl::BufferData(
+        GL_UNIFORM_BUFFER,
+        static_cast< GLsizeiptr >( slot_stride_ * RingSize ),
+        nullptr,
+        GL_DYNAMIC_DRAW
+    );
+}
+
+template< typename Block, std::size_t RingSize >
+JadeMatrix::yavsg::gl::uniform_buffer< Block, RingSize >::~uniform_buffer()
+{
+    delete_buffer_later( gl_id_ );
+}
+
+template< typename Block, std::size_t RingSize >
+bool JadeMatrix::yavsg::gl::uniform_buffer< Block, RingSize >::update(
+    Block const& data
+)
+{
+    if(
+        has_data_
+        && std::memcmp( last_data_.data(), &data, sizeof( Block ) ) == 0
+    )
+    {
+        return false;
+    }
+    std::memcpy( last_data_.data(), &data, sizeof( Block ) );
+    has_data_ = true;
+    
+    current_slot_ = ( current_slot_ + 1 ) % RingSize;
+    
+    gl::BindBuffer( GL_UNIFORM_BUFFER, gl_id_ );
+    gl::BufferSubData(
+        GL_UNIFORM_BUFFER,
+        current_offset(),
+        static_cast< GLsizeiptr >( sizeof( Block ) ),
+        &data
+    );
+    bind();
+    
+    return true;
+}
+
+template< typename Block, std::size_t RingSize >
+void JadeMatrix::yavsg::gl::uniform_buffer< Block, RingSize >::bind() const
+{
+    gl::BindBufferRange(
+        GL_UNIFORM_BUFFER,
+        binding_point_,
+        gl_id_,
+        current_offset(),
+        static_cast< GLsizeiptr >( sizeof( Block ) )
+    );
+}
+
+template< typename Block, std::size_t RingSize >
+GLuint JadeMatrix::yavsg::gl::uniform_buffer<
+    Block,
+    RingSize
+>::binding_point() const
+{
+    return binding_point_;
+}
+
+template< typename Block, std::size_t RingSize >
+GLintptr JadeMatrix::yavsg::gl::uniform_buffer<
+    Block,
+    RingSize
+>::current_offset() const
+{
+    return static_cast< GLintptr >( current_slot_ * slot_stride_ );
+}
+
+template< typename Block, std::size_t RingSize >
+GLuint JadeMatrix::yavsg::gl::uniform_buffer<
+    Block,
+    RingSize
+>::gl_buffer_id() const
+{
+    return gl_id_;
+}
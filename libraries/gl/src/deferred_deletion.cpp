@@ -0,0 +1,124 @@
+#include <yavsg/gl/deferred_deletion.hpp>
+
+#include <yavsg/gl/object_pool.hpp>    // return_released_objects
+
+#include <doctest/doctest.h>    // REQUIRE
+
+#include <limits>
+#include <mutex>
+#include <utility>  // swap
+
+
+namespace
+{
+    namespace gl = JadeMatrix::yavsg::gl;
+    
+    std::mutex                  queue_mutex;
+    gl::deferred_deletion_batch queued;
+    
+    // Only touched on the GPU thread; swapped with `queued` on each flush so
+    // both keep their allocations
+    gl::deferred_deletion_batch flushed;
+    
+    void queue(
+        std::vector< GLuint > gl::deferred_deletion_batch::* names,
+        GLuint                                               gl_id
+    )
+    {
+        if( gl_id != 0 )
+        {
+            std::lock_guard< std::mutex > lock( queue_mutex );
+            ( queued.*names ).push_back( gl_id );
+        }
+    }
+    
+    GLsizei count( std::vector< GLuint > const& names )
+    {
+        REQUIRE( names.size() <= std::numeric_limits< GLsizei >::max() );
+        return static_cast< GLsizei >( names.size() );
+    }
+}
+
+
+void JadeMatrix::yavsg::gl::delete_texture_later( GLuint gl_id )
+{
+    queue( &deferred_deletion_batch::textures, gl_id );
+}
+
+void JadeMatrix::yavsg::gl::delete_buffer_later( GLuint gl_id )
+{
+    queue( &deferred_deletion_batch::buffers, gl_id );
+}
+
+void JadeMatrix::yavsg::gl::delete_vertex_array_later( GLuint gl_id )
+{
+    queue( &deferred_deletion_batch::vertex_arrays, gl_id );
+}
+
+void JadeMatrix::yavsg::gl::delete_framebuffer_later( GLuint gl_id )
+{
+    queue( &deferred_deletion_batch::framebuffers, gl_id );
+}
+
+void JadeMatrix::yavsg::gl::delete_program_later( GLuint gl_id )
+{
+    queue( &deferred_deletion_batch::programs, gl_id );
+}
+
+JadeMatrix::yavsg::gl::deferred_deletion_batch const&
+JadeMatrix::yavsg::gl::flush_deferred_deletions()
+{
+    flushed.textures       .clear();
+    flushed.buffers        .clear();
+    flushed.vertex_arrays  .clear();
+    flushed.framebuffers   .clear();
+    flushed.programs       .clear();
+    flushed.pooled_textures.clear();
+    
+    {
+        std::lock_guard< std::mutex > lock( queue_mutex );
+        std::swap( queued, flushed );
+    }
+    
+    // Anything released to a pool that doesn't fit is deleted along with the
+    // rest
+    return_released_objects( flushed );
+    
+    // Framebuffers & programs go first, as they may still have textures,
+    // buffers, or vertex arrays attached or bound
+    if( !flushed.framebuffers.empty() )
+    {
+        gl::DeleteFramebuffers(
+            count( flushed.framebuffers ),
+            flushed.framebuffers.data()
+        );
+    }
+    // There's no batched call for programs
+    for( auto gl_id : flushed.programs )
+    {
+        gl::DeleteProgram( gl_id );
+    }
+    if( !flushed.vertex_arrays.empty() )
+    {
+        gl::DeleteVertexArrays(
+            count( flushed.vertex_arrays ),
+            flushed.vertex_arrays.data()
+        );
+    }
+    if( !flushed.buffers.empty() )
+    {
+        gl::DeleteBuffers(
+            count( flushed.buffers ),
+            flushed.buffers.data()
+        );
+    }
+    if( !flushed.textures.empty() )
+    {
+        gl::DeleteTextures(
+            count( flushed.textures ),
+            flushed.textures.data()
+        );
+    }
+    
+    return flushed;
+}
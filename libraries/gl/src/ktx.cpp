@@ -0,0 +1,305 @@
+#include <yavsg/gl/ktx.hpp>
+
+#include <yavsg/gl/texture_compression.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>    // std::filesystem::path support
+
+#include <algorithm>    // max, equal
+#include <array>
+#include <cstdint>      // uint8_t, uint32_t
+#include <fstream>
+#include <stdexcept>    // runtime_error, invalid_argument
+#include <string_view>
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+    
+    constexpr std::array< std::uint8_t, 12 > ktx_identifier = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+    
+    constexpr std::uint32_t ktx_endianness         = 0x04030201;
+    constexpr std::uint32_t ktx_swapped_endianness = 0x01020304;
+    
+    struct ktx_header
+    {
+        std::uint32_t endianness;
+        std::uint32_t gl_type;
+        std::uint32_t gl_type_size;
+        std::uint32_t gl_format;
+        std::uint32_t gl_internal_format;
+        std::uint32_t gl_base_internal_format;
+        std::uint32_t pixel_width;
+        std::uint32_t pixel_height;
+        std::uint32_t pixel_depth;
+        std::uint32_t array_elements;
+        std::uint32_t faces;
+        std::uint32_t mipmap_levels;
+        std::uint32_t key_value_bytes;
+    };
+    
+    std::uint32_t swap_bytes( std::uint32_t value )
+    {
+        return (
+              ( value >> 24 )
+            | ( ( value >> 8 ) & 0x0000FF00u )
+            | ( ( value << 8 ) & 0x00FF0000u )
+            | ( value << 24 )
+        );
+    }
+    
+    std::uint32_t read_uint32( std::istream& in, bool swapped )
+    {
+        std::uint32_t value;
+        in.read( reinterpret_cast< char* >( &value ), sizeof( value ) );
+        return swapped ? swap_bytes( value ) : value;
+    }
+    
+    void write_uint32( std::ostream& out, std::uint32_t value )
+    {
+        out.write( reinterpret_cast< char const* >( &value ), sizeof( value ) );
+    }
+    
+    GLenum base_internal_format( GLint gl_internal_format )
+    {
+        switch( gl_internal_format )
+        {
+        case GL_COMPRESSED_RED_RGTC1:
+            return GL_RED;
+        case GL_COMPRESSED_RG_RGTC2:
+            return GL_RG;
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+        }
+    }
+}
+
+
+JadeMatrix::yavsg::gl::texture_upload_data
+JadeMatrix::yavsg::gl::read_ktx_file( std::filesystem::path const& filename )
+{
+    std::ifstream in( filename, std::ios_base::in | std::ios_base::binary );
+    if( !in.is_open() )
+    {
+        throw std::runtime_error( fmt::format(
+            "could not open KTX file {}"sv,
+            filename
+        ) );
+    }
+    
+    std::array< std::uint8_t, 12 > identifier;
+    in.read( reinterpret_cast< char* >( identifier.data() ), identifier.size() );
+    if( !in || identifier != ktx_identifier )
+    {
+        throw std::runtime_error( fmt::format(
+            "{} is not a KTX file"sv,
+            filename
+        ) );
+    }
+    
+    ktx_header header;
+    header.endianness = read_uint32( in, false );
+    if(
+           header.endianness != ktx_endianness
+        && header.endianness != ktx_swapped_endianness
+    )
+    {
+        throw std::runtime_error( fmt::format(
+            "invalid endianness marker in KTX file {}"sv,
+            filename
+        ) );
+    }
+    // Block-compressed data is a byte stream, so only the header needs to be
+    // swapped for files written on other-endian machines
+    auto const swapped = header.endianness == ktx_swapped_endianness;
+    
+    header.gl_type                 = read_uint32( in, swapped );
+    header.gl_type_size            = read_uint32( in, swapped );
+    header.gl_format               = read_uint32( in, swapped );
+    header.gl_internal_format      = read_uint32( in, swapped );
+    header.gl_base_internal_format = read_uint32( in, swapped );
+    header.pixel_width             = read_uint32( in, swapped );
+    header.pixel_height            = read_uint32( in, swapped );
+    header.pixel_depth             = read_uint32( in, swapped );
+    header.array_elements          = read_uint32( in, swapped );
+    header.faces                   = read_uint32( in, swapped );
+    header.mipmap_levels           = read_uint32( in, swapped );
+    header.key_value_bytes         = read_uint32( in, swapped );
+    
+    auto const internal_format = static_cast< GLint >(
+        header.gl_internal_format
+    );
+    if(
+           !in
+        || header.gl_type != 0
+        || !is_block_compressed_format( internal_format )
+        || header.pixel_width  == 0
+        || header.pixel_height == 0
+        || header.pixel_depth    != 0
+        || header.array_elements != 0
+        || header.faces          != 1
+    )
+    {
+        throw std::runtime_error( fmt::format(
+            "KTX file {} does not hold a block-compressed 2D texture"sv,
+            filename
+        ) );
+    }
+    
+    in.ignore( header.key_value_bytes );
+    
+    texture_upload_data upload_data{
+        internal_format,
+        header.pixel_width,
+        header.pixel_height,
+        0,
+        0,
+        nullptr,
+        {}
+    };
+    
+    auto width  = upload_data.width;
+    auto height = upload_data.height;
+    auto const levels = std::max< std::uint32_t >( 1, header.mipmap_levels );
+    
+    for( std::uint32_t level = 0; level < levels; ++level )
+    {
+        auto const image_size = read_uint32( in, swapped );
+        auto const expected_size = block_compressed_size(
+            internal_format,
+            width,
+            height
+        );
+        if( !in || image_size != expected_size )
+        {
+            throw std::runtime_error( fmt::format(
+                "KTX file {} has a truncated or mis-sized mip level {}"sv,
+                filename,
+                level
+            ) );
+        }
+        
+        auto data = make_texture_data( image_size );
+        in.read( reinterpret_cast< char* >( data.get() ), image_size );
+        // Each level is padded to a multiple of 4 bytes
+        in.ignore( 3 - ( ( image_size + 3 ) % 4 ) );
+        if( !in )
+        {
+            throw std::runtime_error( fmt::format(
+                "KTX file {} is truncated at mip level {}"sv,
+                filename,
+                level
+            ) );
+        }
+        
+        if( level == 0 )
+        {
+            upload_data.data = std::move( data );
+        }
+        else
+        {
+            upload_data.mipmaps.push_back( std::move( data ) );
+        }
+        
+        width  = std::max< std::size_t >( 1, width  / 2 );
+        height = std::max< std::size_t >( 1, height / 2 );
+    }
+    
+    return upload_data;
+}
+
+void JadeMatrix::yavsg::gl::write_ktx_file(
+    std::filesystem::path const& filename,
+    texture_upload_data   const& upload_data
+)
+{
+    if(
+           !upload_data.data
+        || !is_block_compressed_format( upload_data.gl_internal_format )
+    )
+    {
+        throw std::invalid_argument(
+            "yavsg::gl::write_ktx_file() only supports block-compressed data"
+        );
+    }
+    
+    std::ofstream out(
+        filename,
+        std::ios_base::out | std::ios_base::binary | std::ios_base::trunc
+    );
+    if( !out.is_open() )
+    {
+        throw std::runtime_error( fmt::format(
+            "could not open KTX file {} for writing"sv,
+            filename
+        ) );
+    }
+    
+    out.write(
+        reinterpret_cast< char const* >( ktx_identifier.data() ),
+        ktx_identifier.size()
+    );
+    write_uint32( out, ktx_endianness );
+    write_uint32( out, 0 );     // glType
+    write_uint32( out, 1 );     // glTypeSize
+    write_uint32( out, 0 );     // glFormat
+    write_uint32( out, static_cast< std::uint32_t >(
+        upload_data.gl_internal_format
+    ) );
+    write_uint32( out, base_internal_format( upload_data.gl_internal_format ) );
+    write_uint32( out, static_cast< std::uint32_t >( upload_data.width  ) );
+    write_uint32( out, static_cast< std::uint32_t >( upload_data.height ) );
+    write_uint32( out, 0 );     // pixelDepth
+    write_uint32( out, 0 );     // numberOfArrayElements
+    write_uint32( out, 1 );     // numberOfFaces
+    write_uint32( out, static_cast< std::uint32_t >(
+        upload_data.mipmaps.size() + 1
+    ) );
+    write_uint32( out, 0 );     // bytesOfKeyValueData
+    
+    auto width  = upload_data.width;
+    auto height = upload_data.height;
+    
+    for( std::size_t level = 0; level <= upload_data.mipmaps.size(); ++level )
+    {
+        auto const data = (
+            level == 0
+            ? upload_data.data.get()
+            : upload_data.mipmaps[ level - 1 ].get()
+        );
+        auto const image_size = block_compressed_size(
+            upload_data.gl_internal_format,
+            width,
+            height
+        );
+        
+        write_uint32( out, static_cast< std::uint32_t >( image_size ) );
+        out.write(
+            reinterpret_cast< char const* >( data ),
+            static_cast< std::streamsize >( image_size )
+        );
+        
+        std::array< char, 3 > const padding{};
+        out.write(
+            padding.data(),
+            static_cast< std::streamsize >( 3 - ( ( image_size + 3 ) % 4 ) )
+        );
+        
+        width  = std::max< std::size_t >( 1, width  / 2 );
+        height = std::max< std::size_t >( 1, height / 2 );
+    }
+    
+    if( !out )
+    {
+        throw std::runtime_error( fmt::format(
+            "failed writing KTX file {}"sv,
+            filename
+        ) );
+    }
+}
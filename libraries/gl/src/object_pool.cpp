@@ -0,0 +1,448 @@
+#include <yavsg/gl/object_pool.hpp>
+
+#include <yavsg/gl/texture_compression.hpp>
+
+#include <doctest/doctest.h>    // REQUIRE
+
+#include <algorithm>    // max
+#include <iterator>     // prev
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>      // pair, swap
+#include <vector>
+
+
+namespace
+{
+    namespace gl = JadeMatrix::yavsg::gl;
+    
+    constexpr std::size_t minimum_buffer_capacity = 256;
+    
+    // Buffers larger than this are usually static meshes that are never
+    // recycled, where doubling could waste as much again in VRAM, so they're
+    // only rounded up to a multiple of the coarse granularity
+    constexpr std::size_t largest_rounded_buffer    = 1024 * 1024;
+    constexpr std::size_t coarse_buffer_granularity = 64 * 1024;
+    
+    // Released objects & the limits may come from any thread
+    std::mutex release_mutex;
+    std::vector< std::pair< GLuint, gl::texture_shape > > released_textures;
+    std::vector< std::pair< GLuint, std::size_t       > > released_buffers;
+    gl::object_pool_limits limits{ 4, 64, 8, 64 * 1024 * 1024 };
+    
+    // The pools themselves are only touched on the GPU thread, but they're
+    // counted from anywhere
+    std::mutex                                          counts_mutex;
+    gl::object_pool_counters                            counts;
+    std::map< gl::texture_shape, std::vector< GLuint > > texture_pool;
+    std::map< std::size_t,       std::vector< GLuint > > buffer_pool;
+    
+    // Only the GPU thread swaps these with the released lists, so both keep
+    // their allocations
+    std::vector< std::pair< GLuint, gl::texture_shape > > returning_textures;
+    std::vector< std::pair< GLuint, std::size_t       > > returning_buffers;
+    
+    std::size_t buffer_capacity_for( std::size_t size )
+    {
+        if( size > largest_rounded_buffer )
+        {
+            return (
+                ( size + coarse_buffer_granularity - 1 )
+                / coarse_buffer_granularity
+                * coarse_buffer_granularity
+            );
+        }
+        
+        std::size_t capacity = minimum_buffer_capacity;
+        while( capacity < size )
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+    
+    // Frees the texture's storage but keeps its parameters, so a pooled
+    // texture takes up no texture memory
+    void release_storage( GLuint gl_id, gl::texture_shape const& shape )
+    {
+        auto const compressed = gl::is_block_compressed_format(
+            shape.gl_internal_format
+        );
+        
+        // OpenGL may have generated the mip chain itself
+        auto levels = shape.levels;
+        if( levels == 1 && !compressed )
+        {
+            for(
+                auto size = std::max( shape.width, shape.height );
+                size > 1;
+                size /= 2
+            )
+            {
+                ++levels;
+            }
+        }
+        
+        gl::BindTexture( shape.target, gl_id );
+        for( std::size_t level = 0; level < levels; ++level )
+        {
+            auto const gl_level = static_cast< GLint >( level );
+            
+            if( shape.target == GL_TEXTURE_2D_ARRAY && compressed )
+            {
+                gl::CompressedTexImage3D(
+                    shape.target,
+                    gl_level,
+                    static_cast< GLenum >( shape.gl_internal_format ),
+                    0, 0, 0,
+                    0,
+                    0,
+                    nullptr
+                );
+            }
+            else if( shape.target == GL_TEXTURE_2D_ARRAY )
+            {
+                gl::TexImage3D(
+                    shape.target,
+                    gl_level,
+                    shape.gl_internal_format,
+                    0, 0, 0,
+                    0,
+                    shape.gl_incoming_format,
+                    shape.gl_incoming_type,
+                    nullptr
+                );
+            }
+            else if( compressed )
+            {
+                gl::CompressedTexImage2D(
+                    shape.target,
+                    gl_level,
+                    static_cast< GLenum >( shape.gl_internal_format ),
+                    0, 0,
+                    0,
+                    0,
+                    nullptr
+                );
+            }
+            else
+            {
+                gl::TexImage2D(
+                    shape.target,
+                    gl_level,
+                    shape.gl_internal_format,
+                    0, 0,
+                    0,
+                    shape.gl_incoming_format,
+                    shape.gl_incoming_type,
+                    nullptr
+                );
+            }
+        }
+    }
+}
+
+
+namespace JadeMatrix::yavsg::gl // Texture shapes //////////////////////////////
+{
+    bool operator<( texture_shape const& lhs, texture_shape const& rhs )
+    {
+        auto const tie = []( texture_shape const& s ){
+            return std::tie(
+                s.target,
+                s.gl_internal_format,
+                s.gl_incoming_format,
+                s.gl_incoming_type,
+                s.width,
+                s.height,
+                s.layers,
+                s.levels
+            );
+        };
+        return tie( lhs ) < tie( rhs );
+    }
+    
+    texture_shape texture_shape_of(
+        GLenum                     target,
+        texture_upload_data const& upload_data,
+        std::size_t                layers
+    )
+    {
+        return {
+            target,
+            upload_data.gl_internal_format,
+            upload_data.gl_incoming_format,
+            upload_data.gl_incoming_type,
+            upload_data.width,
+            upload_data.height,
+            layers,
+            upload_data.mipmaps.size() + 1
+        };
+    }
+}
+
+
+namespace JadeMatrix::yavsg::gl // Limits & counters ///////////////////////////
+{
+    void set_object_pool_limits( object_pool_limits const& new_limits )
+    {
+        std::lock_guard< std::mutex > lock( release_mutex );
+        limits = new_limits;
+    }
+    
+    object_pool_limits object_pool_limit_settings()
+    {
+        std::lock_guard< std::mutex > lock( release_mutex );
+        return limits;
+    }
+    
+    object_pool_counters object_pool_counts()
+    {
+        std::lock_guard< std::mutex > lock( counts_mutex );
+        return counts;
+    }
+    
+    void reset_object_pool_counts()
+    {
+        std::lock_guard< std::mutex > lock( counts_mutex );
+        counts.texture_hits   = 0;
+        counts.texture_misses = 0;
+        counts.buffer_hits    = 0;
+        counts.buffer_misses  = 0;
+    }
+}
+
+
+namespace JadeMatrix::yavsg::gl // Acquisition /////////////////////////////////
+{
+    GLuint acquire_texture( texture_shape const& shape )
+    {
+        GLuint gl_id = 0;
+        
+        auto found = texture_pool.find( shape );
+        if( found != texture_pool.end() )
+        {
+            gl_id = found->second.back();
+            found->second.pop_back();
+            if( found->second.empty() )
+            {
+                texture_pool.erase( found );
+            }
+        }
+        
+        {
+            std::lock_guard< std::mutex > lock( counts_mutex );
+            if( gl_id != 0 )
+            {
+                ++counts.texture_hits;
+                --counts.pooled_textures;
+            }
+            else
+            {
+                ++counts.texture_misses;
+            }
+        }
+        
+        if( gl_id == 0 )
+        {
+            gl::GenTextures( 1, &gl_id );
+        }
+        return gl_id;
+    }
+    
+    void upload_pooled_buffer_data(
+        GLenum       target,
+        GLuint     & gl_id,
+        std::size_t& capacity,
+        void const*  data,
+        std::size_t  size
+    )
+    {
+        REQUIRE( size <= std::numeric_limits< GLsizeiptr >::max() );
+        
+        if( gl_id == 0 )
+        {
+            capacity = buffer_capacity_for( size );
+            
+            auto found = buffer_pool.find( capacity );
+            if( found != buffer_pool.end() )
+            {
+                gl_id = found->second.back();
+                found->second.pop_back();
+                if( found->second.empty() )
+                {
+                    buffer_pool.erase( found );
+                }
+            }
+            
+            std::lock_guard< std::mutex > lock( counts_mutex );
+            if( gl_id != 0 )
+            {
+                ++counts.buffer_hits;
+                --counts.pooled_buffers;
+                counts.pooled_buffer_bytes -= capacity;
+            }
+            else
+            {
+                ++counts.buffer_misses;
+            }
+        }
+        
+        if( gl_id == 0 )
+        {
+            gl::GenBuffers( 1, &gl_id );
+            gl::BindBuffer( target, gl_id );
+            gl::BufferData(
+                target,
+                static_cast< GLsizeiptr >( capacity ),
+                nullptr,
+                GL_STATIC_DRAW
+            );
+        }
+        else if( size > capacity )
+        {
+            // Outgrew its storage, but keep the same buffer so anything set up
+            // to read from it stays valid
+            capacity = buffer_capacity_for( size );
+            gl::BindBuffer( target, gl_id );
+            gl::BufferData(
+                target,
+                static_cast< GLsizeiptr >( capacity ),
+                nullptr,
+                GL_STATIC_DRAW
+            );
+        }
+        else
+        {
+            gl::BindBuffer( target, gl_id );
+        }
+        
+        if( size > 0 )
+        {
+            gl::BufferSubData(
+                target,
+                0,
+                static_cast< GLsizeiptr >( size ),
+                data
+            );
+        }
+    }
+}
+
+
+namespace JadeMatrix::yavsg::gl // Release /////////////////////////////////////
+{
+    void release_texture_later( GLuint gl_id, texture_shape const& shape )
+    {
+        if( gl_id != 0 )
+        {
+            std::lock_guard< std::mutex > lock( release_mutex );
+            released_textures.emplace_back( gl_id, shape );
+        }
+    }
+    
+    void release_buffer_later( GLuint gl_id, std::size_t capacity )
+    {
+        if( gl_id != 0 )
+        {
+            std::lock_guard< std::mutex > lock( release_mutex );
+            released_buffers.emplace_back( gl_id, capacity );
+        }
+    }
+    
+    void return_released_objects( deferred_deletion_batch& batch )
+    {
+        object_pool_limits current_limits;
+        {
+            std::lock_guard< std::mutex > lock( release_mutex );
+            std::swap( released_textures, returning_textures );
+            std::swap( released_buffers , returning_buffers  );
+            current_limits = limits;
+        }
+        
+        std::lock_guard< std::mutex > lock( counts_mutex );
+        
+        for( auto const& [ gl_id, shape ] : returning_textures )
+        {
+            auto& bucket = texture_pool[ shape ];
+            if(
+                bucket.size() < current_limits.textures_per_shape
+                && counts.pooled_textures < current_limits.textures
+            )
+            {
+                release_storage( gl_id, shape );
+                bucket.push_back( gl_id );
+                batch.pooled_textures.push_back( gl_id );
+                ++counts.pooled_textures;
+            }
+            else
+            {
+                batch.textures.push_back( gl_id );
+            }
+            if( bucket.empty() )
+            {
+                texture_pool.erase( shape );
+            }
+        }
+        returning_textures.clear();
+        
+        for( auto const& [ gl_id, capacity ] : returning_buffers )
+        {
+            auto& bucket = buffer_pool[ capacity ];
+            if(
+                bucket.size() < current_limits.buffers_per_capacity
+                && (
+                    counts.pooled_buffer_bytes + capacity
+                    <= current_limits.buffer_bytes
+                )
+            )
+            {
+                bucket.push_back( gl_id );
+                ++counts.pooled_buffers;
+                counts.pooled_buffer_bytes += capacity;
+            }
+            else
+            {
+                batch.buffers.push_back( gl_id );
+            }
+            if( bucket.empty() )
+            {
+                buffer_pool.erase( capacity );
+            }
+        }
+        returning_buffers.clear();
+        
+        // Trim the pools if the limits were lowered, largest buffers first
+        for(
+            auto iter = texture_pool.begin();
+            iter != texture_pool.end()
+            && counts.pooled_textures > current_limits.textures;
+        )
+        {
+            batch.textures.push_back( iter->second.back() );
+            iter->second.pop_back();
+            --counts.pooled_textures;
+            if( iter->second.empty() )
+            {
+                iter = texture_pool.erase( iter );
+            }
+        }
+        while(
+            !buffer_pool.empty()
+            && counts.pooled_buffer_bytes > current_limits.buffer_bytes
+        )
+        {
+            auto last = std::prev( buffer_pool.end() );
+            batch.buffers.push_back( last->second.back() );
+            last->second.pop_back();
+            --counts.pooled_buffers;
+            counts.pooled_buffer_bytes -= last->first;
+            if( last->second.empty() )
+            {
+                buffer_pool.erase( last );
+            }
+        }
+    }
+}
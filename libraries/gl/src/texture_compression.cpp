@@ -0,0 +1,1262 @@
+#include <yavsg/gl/texture_compression.hpp>
+
+#include <yavsg/tasking/parallel_for.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>    // min, max, clamp, swap, copy_n
+#include <array>
+#include <cmath>        // sqrt, abs, lround
+#include <cstdint>      // uint8_t, uint16_t, uint64_t
+#include <limits>
+#include <stdexcept>    // invalid_argument, runtime_error
+#include <utility>      // move
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+    
+    // RGBA, each 0-255
+    using block_pixels = std::array< std::array< int, 4 >, 16 >;
+    
+    struct source_level
+    {
+        std::uint8_t const* data;
+        std::size_t         width;
+        std::size_t         height;
+        std::size_t         channels;
+        bool                bgr;
+    };
+    
+    block_pixels fetch_block(
+        source_level const& source,
+        std::size_t         block_x,
+        std::size_t         block_y
+    )
+    {
+        block_pixels pixels;
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            auto const x = std::min( block_x * 4 + i % 4, source.width  - 1 );
+            auto const y = std::min( block_y * 4 + i / 4, source.height - 1 );
+            auto const pixel = source.data + (
+                ( y * source.width + x ) * source.channels
+            );
+            
+            auto& out = pixels[ i ];
+            out = { 0, 0, 0, 255 };
+            for( std::size_t c = 0; c < source.channels; ++c )
+            {
+                out[ c ] = pixel[ c ];
+            }
+            if( source.bgr )
+            {
+                std::swap( out[ 0 ], out[ 2 ] );
+            }
+        }
+        return pixels;
+    }
+    
+    // Fits a line through the first `N` channels of the block's pixels along
+    // their principal axis (found by power iteration on the covariance) &
+    // returns the extent of the pixels along that line as low & high points
+    template< std::size_t N > std::array< std::array< float, N >, 2 >
+    principal_endpoints( block_pixels const& pixels )
+    {
+        std::array< float, N > mean{};
+        for( auto const& pixel : pixels )
+        {
+            for( std::size_t c = 0; c < N; ++c )
+            {
+                mean[ c ] += static_cast< float >( pixel[ c ] );
+            }
+        }
+        for( auto& m : mean )
+        {
+            m /= 16.0f;
+        }
+        
+        std::array< std::array< float, N >, N > covariance{};
+        for( auto const& pixel : pixels )
+        {
+            for( std::size_t i = 0; i < N; ++i )
+            {
+                auto const d_i = static_cast< float >( pixel[ i ] ) - mean[ i ];
+                for( std::size_t j = 0; j < N; ++j )
+                {
+                    auto const d_j = (
+                        static_cast< float >( pixel[ j ] ) - mean[ j ]
+                    );
+                    covariance[ i ][ j ] += d_i * d_j;
+                }
+            }
+        }
+        
+        std::array< float, N > axis;
+        axis.fill( 1.0f );
+        for( int iteration = 0; iteration < 8; ++iteration )
+        {
+            std::array< float, N > next{};
+            auto largest = 0.0f;
+            for( std::size_t i = 0; i < N; ++i )
+            {
+                for( std::size_t j = 0; j < N; ++j )
+                {
+                    next[ i ] += covariance[ i ][ j ] * axis[ j ];
+                }
+                largest = std::max( largest, std::abs( next[ i ] ) );
+            }
+            if( largest == 0.0f )
+            {
+                break;
+            }
+            for( std::size_t i = 0; i < N; ++i )
+            {
+                axis[ i ] = next[ i ] / largest;
+            }
+        }
+        
+        auto length = 0.0f;
+        for( auto a : axis )
+        {
+            length += a * a;
+        }
+        length = std::sqrt( length );
+        for( auto& a : axis )
+        {
+            a /= length;
+        }
+        
+        auto low  =  std::numeric_limits< float >::max();
+        auto high = -std::numeric_limits< float >::max();
+        for( auto const& pixel : pixels )
+        {
+            auto t = 0.0f;
+            for( std::size_t c = 0; c < N; ++c )
+            {
+                t += ( static_cast< float >( pixel[ c ] ) - mean[ c ] ) * axis[ c ];
+            }
+            low  = std::min( low , t );
+            high = std::max( high, t );
+        }
+        
+        std::array< std::array< float, N >, 2 > endpoints;
+        for( std::size_t c = 0; c < N; ++c )
+        {
+            endpoints[ 0 ][ c ] = std::clamp(
+                mean[ c ] + low  * axis[ c ],
+                0.0f,
+                255.0f
+            );
+            endpoints[ 1 ][ c ] = std::clamp(
+                mean[ c ] + high * axis[ c ],
+                0.0f,
+                255.0f
+            );
+        }
+        return endpoints;
+    }
+    
+    template< std::size_t N > int squared_distance(
+        std::array< int, 4 > const& a,
+        std::array< int, 4 > const& b
+    )
+    {
+        auto distance = 0;
+        for( std::size_t c = 0; c < N; ++c )
+        {
+            distance += ( a[ c ] - b[ c ] ) * ( a[ c ] - b[ c ] );
+        }
+        return distance;
+    }
+    
+    template< std::size_t N, std::size_t PaletteSize > std::size_t nearest(
+        std::array< std::array< int, 4 >, PaletteSize > const& palette,
+        std::array< int, 4 >                            const& pixel
+    )
+    {
+        std::size_t best_index    = 0;
+        auto        best_distance = std::numeric_limits< int >::max();
+        for( std::size_t i = 0; i < PaletteSize; ++i )
+        {
+            auto const distance = squared_distance< N >( palette[ i ], pixel );
+            if( distance < best_distance )
+            {
+                best_index    = i;
+                best_distance = distance;
+            }
+        }
+        return best_index;
+    }
+    
+    void write_little_endian(
+        std::uint8_t* out,
+        std::uint64_t value,
+        std::size_t   bytes
+    )
+    {
+        for( std::size_t i = 0; i < bytes; ++i )
+        {
+            out[ i ] = static_cast< std::uint8_t >( value >> ( i * 8 ) );
+        }
+    }
+}
+
+
+namespace // BC1 ///////////////////////////////////////////////////////////////
+{
+    std::uint16_t pack_565( std::array< float, 3 > const& color )
+    {
+        auto const quantize = []( float value, int max ){
+            return static_cast< std::uint16_t >( std::lround(
+                value * static_cast< float >( max ) / 255.0f
+            ) );
+        };
+        return static_cast< std::uint16_t >(
+              ( quantize( color[ 0 ], 31 ) << 11 )
+            | ( quantize( color[ 1 ], 63 ) <<  5 )
+            |   quantize( color[ 2 ], 31 )
+        );
+    }
+    
+    std::array< int, 4 > unpack_565( std::uint16_t packed )
+    {
+        auto const r = ( packed >> 11 ) & 0x1F;
+        auto const g = ( packed >>  5 ) & 0x3F;
+        auto const b =   packed         & 0x1F;
+        return {
+            ( r << 3 ) | ( r >> 2 ),
+            ( g << 2 ) | ( g >> 4 ),
+            ( b << 3 ) | ( b >> 2 ),
+            255
+        };
+    }
+    
+    // Always uses the 4-color mode, so it's also valid as the color half of
+    // a BC3 block
+    void encode_bc1_block( block_pixels const& pixels, std::uint8_t* out )
+    {
+        auto const endpoints = principal_endpoints< 3 >( pixels );
+        auto color_0 = pack_565( endpoints[ 1 ] );
+        auto color_1 = pack_565( endpoints[ 0 ] );
+        
+        // The 4-color mode is selected by `color_0 > color_1`
+        if( color_0 < color_1 )
+        {
+            std::swap( color_0, color_1 );
+        }
+        
+        std::uint64_t indices = 0;
+        if( color_0 != color_1 )
+        {
+            std::array< std::array< int, 4 >, 4 > palette;
+            palette[ 0 ] = unpack_565( color_0 );
+            palette[ 1 ] = unpack_565( color_1 );
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                palette[ 2 ][ c ] = ( 2 * palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 3;
+                palette[ 3 ][ c ] = ( palette[ 0 ][ c ] + 2 * palette[ 1 ][ c ] ) / 3;
+            }
+            
+            for( std::size_t i = 0; i < 16; ++i )
+            {
+                indices |= static_cast< std::uint64_t >(
+                    nearest< 3 >( palette, pixels[ i ] )
+                ) << ( i * 2 );
+            }
+        }
+        
+        write_little_endian( out    , color_0, 2 );
+        write_little_endian( out + 2, color_1, 2 );
+        write_little_endian( out + 4, indices, 4 );
+    }
+}
+
+
+namespace // BC4 ///////////////////////////////////////////////////////////////
+{
+    // Encodes channel `channel` of the block using the 8-value mode
+    void encode_bc4_block(
+        block_pixels const& pixels,
+        std::size_t         channel,
+        std::uint8_t      * out
+    )
+    {
+        auto low  = 255;
+        auto high = 0;
+        for( auto const& pixel : pixels )
+        {
+            low  = std::min( low , pixel[ channel ] );
+            high = std::max( high, pixel[ channel ] );
+        }
+        
+        // The 8-value mode is selected by `endpoint_0 > endpoint_1`; if
+        // they're equal every index just refers to `endpoint_0`
+        std::uint64_t indices = 0;
+        if( high != low )
+        {
+            std::array< std::array< int, 4 >, 8 > palette{};
+            palette[ 0 ][ 0 ] = high;
+            palette[ 1 ][ 0 ] = low;
+            for( int i = 2; i < 8; ++i )
+            {
+                palette[ static_cast< std::size_t >( i ) ][ 0 ] = (
+                    ( 8 - i ) * high + ( i - 1 ) * low
+                ) / 7;
+            }
+            
+            for( std::size_t i = 0; i < 16; ++i )
+            {
+                indices |= static_cast< std::uint64_t >( nearest< 1 >(
+                    palette,
+                    { pixels[ i ][ channel ], 0, 0, 0 }
+                ) ) << ( i * 3 );
+            }
+        }
+        
+        out[ 0 ] = static_cast< std::uint8_t >( high );
+        out[ 1 ] = static_cast< std::uint8_t >( low  );
+        write_little_endian( out + 2, indices, 6 );
+    }
+}
+
+
+namespace // BC7 ///////////////////////////////////////////////////////////////
+{
+    // Writes fields LSB-first as laid out in the BPTC specification
+    class block_bit_writer
+    {
+    public:
+        explicit block_bit_writer( std::uint8_t* out ) : out_{ out }
+        {
+            std::fill( out_, out_ + 16, std::uint8_t{ 0 } );
+        }
+        
+        void write( std::uint32_t value, unsigned int bits )
+        {
+            for( unsigned int i = 0; i < bits; ++i, ++position_ )
+            {
+                if( ( value >> i ) & 1u )
+                {
+                    out_[ position_ / 8 ] |= static_cast< std::uint8_t >(
+                        1u << ( position_ % 8 )
+                    );
+                }
+            }
+        }
+    
+    protected:
+        std::uint8_t* out_;
+        unsigned int  position_ = 0;
+    };
+    
+    constexpr std::array< int, 16 > bc7_weights_4 = {
+        0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+    };
+    
+    // Only uses mode 6 (one subset, RGBA 7.7.7.7 endpoints with a shared
+    // P-bit each, 4-bit indices), which handles smooth color & alpha well &
+    // needs no partition search
+    void encode_bc7_block( block_pixels const& pixels, std::uint8_t* out )
+    {
+        auto const endpoints = principal_endpoints< 4 >( pixels );
+        
+        // Endpoints are 7 bits per channel plus a P-bit shared by all of an
+        // endpoint's channels; pick whichever P-bit lands closer
+        std::array< std::array< int, 4 >, 2 > quantized;
+        std::array< int, 2 >                  p_bits;
+        for( std::size_t e = 0; e < 2; ++e )
+        {
+            auto best_error = std::numeric_limits< float >::max();
+            for( int p = 0; p < 2; ++p )
+            {
+                std::array< int, 4 > candidate;
+                auto error = 0.0f;
+                for( std::size_t c = 0; c < 4; ++c )
+                {
+                    candidate[ c ] = std::clamp(
+                        static_cast< int >( std::lround(
+                            ( endpoints[ e ][ c ] - static_cast< float >( p ) )
+                            / 2.0f
+                        ) ),
+                        0,
+                        127
+                    );
+                    auto const d = static_cast< float >(
+                        ( candidate[ c ] << 1 ) | p
+                    ) - endpoints[ e ][ c ];
+                    error += d * d;
+                }
+                if( error < best_error )
+                {
+                    best_error = error;
+                    quantized[ e ] = candidate;
+                    p_bits[ e ] = p;
+                }
+            }
+        }
+        
+        std::array< std::array< int, 4 >, 16 > palette;
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            for( std::size_t c = 0; c < 4; ++c )
+            {
+                auto const e_0 = ( quantized[ 0 ][ c ] << 1 ) | p_bits[ 0 ];
+                auto const e_1 = ( quantized[ 1 ][ c ] << 1 ) | p_bits[ 1 ];
+                palette[ i ][ c ] = (
+                    ( 64 - bc7_weights_4[ i ] ) * e_0
+                    + bc7_weights_4[ i ] * e_1
+                    + 32
+                ) >> 6;
+            }
+        }
+        
+        std::array< unsigned int, 16 > indices;
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            indices[ i ] = static_cast< unsigned int >(
+                nearest< 4 >( palette, pixels[ i ] )
+            );
+        }
+        
+        // The first index's top bit is implicitly 0, so flip the endpoints if
+        // it would be set
+        if( indices[ 0 ] & 0x8u )
+        {
+            std::swap( quantized[ 0 ], quantized[ 1 ] );
+            std::swap( p_bits   [ 0 ], p_bits   [ 1 ] );
+            for( auto& index : indices )
+            {
+                index = 15u - index;
+            }
+        }
+        
+        block_bit_writer bits{ out };
+        bits.write( 1u << 6, 7 );   // Mode 6
+        for( std::size_t c = 0; c < 4; ++c )
+        {
+            bits.write( static_cast< std::uint32_t >( quantized[ 0 ][ c ] ), 7 );
+            bits.write( static_cast< std::uint32_t >( quantized[ 1 ][ c ] ), 7 );
+        }
+        bits.write( static_cast< std::uint32_t >( p_bits[ 0 ] ), 1 );
+        bits.write( static_cast< std::uint32_t >( p_bits[ 1 ] ), 1 );
+        bits.write( indices[ 0 ], 3 );
+        for( std::size_t i = 1; i < 16; ++i )
+        {
+            bits.write( indices[ i ], 4 );
+        }
+    }
+}
+
+
+namespace // Level compression /////////////////////////////////////////////////
+{
+    std::size_t block_bytes( JadeMatrix::yavsg::gl::block_compression compression )
+    {
+        using JadeMatrix::yavsg::gl::block_compression;
+        switch( compression )
+        {
+        case block_compression::bc1:
+        case block_compression::bc4:
+            return 8;
+        default:
+            return 16;
+        }
+    }
+    
+    JadeMatrix::yavsg::gl::texture_data_pointer compress_level(
+        source_level                           const& source,
+        JadeMatrix::yavsg::gl::block_compression      compression
+    )
+    {
+        using JadeMatrix::yavsg::gl::block_compression;
+        
+        auto const blocks_wide = ( source.width  + 3 ) / 4;
+        auto const blocks_high = ( source.height + 3 ) / 4;
+        auto const bytes       = block_bytes( compression );
+        
+        auto compressed = JadeMatrix::yavsg::gl::make_texture_data(
+            blocks_wide * blocks_high * bytes
+        );
+        auto const out = reinterpret_cast< std::uint8_t* >( compressed.get() );
+        
+        JadeMatrix::yavsg::parallel_for(
+            blocks_high,
+            [ & ]( std::size_t block_y ){
+                for( std::size_t block_x = 0; block_x < blocks_wide; ++block_x )
+                {
+                    auto const pixels = fetch_block( source, block_x, block_y );
+                    auto const block  = out + (
+                        ( block_y * blocks_wide + block_x ) * bytes
+                    );
+                    
+                    switch( compression )
+                    {
+                    case block_compression::bc1:
+                        encode_bc1_block( pixels, block );
+                        break;
+                    case block_compression::bc3:
+                        encode_bc4_block( pixels, 3, block     );
+                        encode_bc1_block( pixels,    block + 8 );
+                        break;
+                    case block_compression::bc4:
+                        encode_bc4_block( pixels, 0, block     );
+                        break;
+                    case block_compression::bc5:
+                        encode_bc4_block( pixels, 0, block     );
+                        encode_bc4_block( pixels, 1, block + 8 );
+                        break;
+                    case block_compression::bc7:
+                        encode_bc7_block( pixels, block );
+                        break;
+                    }
+                }
+            }
+        );
+        
+        return compressed;
+    }
+}
+
+
+namespace // Decoding //////////////////////////////////////////////////////////
+{
+    // Only used where a format isn't supported by the driver, so this favors
+    // being simple over being fast; everything is decoded to 8-bit RGBA
+    using decoded_block = std::array< std::array< std::uint8_t, 4 >, 16 >;
+    
+    std::uint64_t read_little_endian(
+        std::uint8_t const* in,
+        std::size_t         bytes
+    )
+    {
+        std::uint64_t value = 0;
+        for( std::size_t i = 0; i < bytes; ++i )
+        {
+            value |= static_cast< std::uint64_t >( in[ i ] ) << ( i * 8 );
+        }
+        return value;
+    }
+    
+    // BC3's color half is always read in the 4-color mode
+    void decode_bc1_block(
+        std::uint8_t const* in,
+        bool                always_4_color,
+        decoded_block     & out
+    )
+    {
+        auto const color_0 = static_cast< std::uint16_t >(
+            read_little_endian( in, 2 )
+        );
+        auto const color_1 = static_cast< std::uint16_t >(
+            read_little_endian( in + 2, 2 )
+        );
+        auto const indices = read_little_endian( in + 4, 4 );
+        
+        std::array< std::array< int, 4 >, 4 > palette;
+        palette[ 0 ] = unpack_565( color_0 );
+        palette[ 1 ] = unpack_565( color_1 );
+        for( std::size_t c = 0; c < 3; ++c )
+        {
+            auto const a = palette[ 0 ][ c ];
+            auto const b = palette[ 1 ][ c ];
+            if( always_4_color || color_0 > color_1 )
+            {
+                palette[ 2 ][ c ] = ( 2 * a + b ) / 3;
+                palette[ 3 ][ c ] = ( a + 2 * b ) / 3;
+            }
+            else
+            {
+                palette[ 2 ][ c ] = ( a + b ) / 2;
+                palette[ 3 ][ c ] = 0;
+            }
+        }
+        // Neither BC1 format used here has alpha, so the 3-color mode's
+        // transparent index is just black
+        palette[ 2 ][ 3 ] = 255;
+        palette[ 3 ][ 3 ] = 255;
+        
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            auto const& color = palette[ ( indices >> ( i * 2 ) ) & 0x3u ];
+            for( std::size_t c = 0; c < 4; ++c )
+            {
+                out[ i ][ c ] = static_cast< std::uint8_t >( color[ c ] );
+            }
+        }
+    }
+    
+    void decode_bc4_block(
+        std::uint8_t const* in,
+        std::size_t         channel,
+        decoded_block     & out
+    )
+    {
+        int const endpoint_0 = in[ 0 ];
+        int const endpoint_1 = in[ 1 ];
+        auto const indices   = read_little_endian( in + 2, 6 );
+        
+        std::array< int, 8 > palette;
+        palette[ 0 ] = endpoint_0;
+        palette[ 1 ] = endpoint_1;
+        if( endpoint_0 > endpoint_1 )
+        {
+            for( int i = 2; i < 8; ++i )
+            {
+                palette[ static_cast< std::size_t >( i ) ] = (
+                    ( 8 - i ) * endpoint_0 + ( i - 1 ) * endpoint_1
+                ) / 7;
+            }
+        }
+        else
+        {
+            for( int i = 2; i < 6; ++i )
+            {
+                palette[ static_cast< std::size_t >( i ) ] = (
+                    ( 6 - i ) * endpoint_0 + ( i - 1 ) * endpoint_1
+                ) / 5;
+            }
+            palette[ 6 ] = 0;
+            palette[ 7 ] = 255;
+        }
+        
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            out[ i ][ channel ] = static_cast< std::uint8_t >(
+                palette[ ( indices >> ( i * 3 ) ) & 0x7u ]
+            );
+        }
+    }
+    
+    class block_bit_reader
+    {
+    public:
+        explicit block_bit_reader( std::uint8_t const* in ) : in_{ in } {}
+        
+        unsigned int read( unsigned int bits )
+        {
+            unsigned int value = 0;
+            for( unsigned int i = 0; i < bits; ++i, ++position_ )
+            {
+                value |= (
+                    ( in_[ position_ / 8 ] >> ( position_ % 8 ) ) & 1u
+                ) << i;
+            }
+            return value;
+        }
+    
+    protected:
+        std::uint8_t const* in_;
+        unsigned int        position_ = 0;
+    };
+    
+    struct bc7_mode
+    {
+        unsigned int subsets;
+        unsigned int partition_bits;
+        unsigned int rotation_bits;
+        unsigned int index_selection_bits;
+        unsigned int color_bits;
+        unsigned int alpha_bits;
+        unsigned int endpoint_p_bits;   // One per endpoint
+        unsigned int shared_p_bits;     // One per subset
+        unsigned int index_bits;
+        unsigned int secondary_index_bits;
+    };
+    
+    constexpr std::array< bc7_mode, 8 > bc7_modes = { {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+    } };
+    
+    // Subset 1 is set in each bit
+    constexpr std::array< std::uint16_t, 64 > bc7_partitions_2 = {
+        0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+        0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+        0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+        0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+        0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+        0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+        0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+        0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+    };
+    
+    // 2 bits per pixel
+    constexpr std::array< std::uint32_t, 64 > bc7_partitions_3 = {
+        0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8,
+        0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+        0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090,
+        0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+        0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0,
+        0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+        0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400,
+        0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+        0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424,
+        0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+        0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0,
+        0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+        0xAA444444, 0x54A854A8, 0x95809580, 0x96969600,
+        0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+        0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000,
+        0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+    };
+    
+    // Pixel 0 is always subset 0's anchor, whose index has its top bit left
+    // out; these are the other subsets' anchors
+    constexpr std::array< std::uint8_t, 64 > bc7_anchors_2_1 = {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+        15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+         6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+    };
+    constexpr std::array< std::uint8_t, 64 > bc7_anchors_3_1 = {
+         3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+         3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+         8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+         3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+    };
+    constexpr std::array< std::uint8_t, 64 > bc7_anchors_3_2 = {
+        15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+        15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+        15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+        15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+    };
+    
+    constexpr std::array< int, 4 > bc7_weights_2 = { 0, 21, 43, 64 };
+    constexpr std::array< int, 8 > bc7_weights_3 = {
+        0, 9, 18, 27, 37, 46, 55, 64
+    };
+    
+    int bc7_interpolate(
+        int          e_0,
+        int          e_1,
+        unsigned int index,
+        unsigned int bits
+    )
+    {
+        auto const weight = (
+            bits == 2 ? bc7_weights_2[ index ]
+            : bits == 3 ? bc7_weights_3[ index ]
+            : bc7_weights_4[ index ]
+        );
+        return ( ( 64 - weight ) * e_0 + weight * e_1 + 32 ) >> 6;
+    }
+    
+    void decode_bc7_block( std::uint8_t const* in, decoded_block& out )
+    {
+        // The mode is the position of the lowest set bit
+        std::size_t mode_number = 0;
+        while( mode_number < 8 && !( ( in[ 0 ] >> mode_number ) & 1u ) )
+        {
+            ++mode_number;
+        }
+        if( mode_number == 8 )
+        {
+            // Reserved; decodes as transparent black
+            for( auto& pixel : out )
+            {
+                pixel = { 0, 0, 0, 0 };
+            }
+            return;
+        }
+        auto const& mode = bc7_modes[ mode_number ];
+        
+        block_bit_reader bits{ in };
+        bits.read( static_cast< unsigned int >( mode_number + 1 ) );
+        auto const partition       = bits.read( mode.partition_bits       );
+        auto const rotation        = bits.read( mode.rotation_bits        );
+        auto const index_selection = bits.read( mode.index_selection_bits );
+        
+        // Endpoints are stored channel by channel
+        std::array< std::array< int, 4 >, 6 > endpoints;
+        auto const endpoint_count = mode.subsets * 2;
+        for( std::size_t c = 0; c < 4; ++c )
+        {
+            auto const channel_bits = (
+                c < 3 ? mode.color_bits : mode.alpha_bits
+            );
+            for( std::size_t e = 0; e < endpoint_count; ++e )
+            {
+                endpoints[ e ][ c ] = static_cast< int >(
+                    bits.read( channel_bits )
+                );
+            }
+        }
+        
+        // P-bits are appended as each channel's lowest bit, then every
+        // channel is expanded to 8 bits by repeating its top bits
+        std::array< unsigned int, 6 > p_bits{};
+        if( mode.endpoint_p_bits )
+        {
+            for( std::size_t e = 0; e < endpoint_count; ++e )
+            {
+                p_bits[ e ] = bits.read( 1 );
+            }
+        }
+        else if( mode.shared_p_bits )
+        {
+            for( std::size_t s = 0; s < mode.subsets; ++s )
+            {
+                auto const p = bits.read( 1 );
+                p_bits[ s * 2     ] = p;
+                p_bits[ s * 2 + 1 ] = p;
+            }
+        }
+        auto const has_p_bit = mode.endpoint_p_bits || mode.shared_p_bits;
+        for( std::size_t e = 0; e < endpoint_count; ++e )
+        {
+            for( std::size_t c = 0; c < 4; ++c )
+            {
+                auto channel_bits = (
+                    c < 3 ? mode.color_bits : mode.alpha_bits
+                );
+                if( channel_bits == 0 )
+                {
+                    endpoints[ e ][ c ] = 255;
+                    continue;
+                }
+                auto value = endpoints[ e ][ c ];
+                if( has_p_bit )
+                {
+                    value = ( value << 1 ) | static_cast< int >( p_bits[ e ] );
+                    ++channel_bits;
+                }
+                value <<= 8 - channel_bits;
+                endpoints[ e ][ c ] = value | ( value >> channel_bits );
+            }
+        }
+        
+        auto const subset_of = [ & ]( std::size_t pixel ) -> std::size_t {
+            switch( mode.subsets )
+            {
+            case 2:
+                return ( bc7_partitions_2[ partition ] >> pixel ) & 0x1u;
+            case 3:
+                return (
+                    bc7_partitions_3[ partition ] >> ( pixel * 2 )
+                ) & 0x3u;
+            default:
+                return 0;
+            }
+        };
+        auto const is_anchor = [ & ]( std::size_t pixel ){
+            switch( mode.subsets )
+            {
+            case 2:
+                return pixel == 0 || pixel == bc7_anchors_2_1[ partition ];
+            case 3:
+                return (
+                    pixel == 0
+                    || pixel == bc7_anchors_3_1[ partition ]
+                    || pixel == bc7_anchors_3_2[ partition ]
+                );
+            default:
+                return pixel == 0;
+            }
+        };
+        
+        std::array< unsigned int, 16 > indices;
+        std::array< unsigned int, 16 > secondary_indices{};
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            indices[ i ] = bits.read(
+                mode.index_bits - ( is_anchor( i ) ? 1 : 0 )
+            );
+        }
+        if( mode.secondary_index_bits )
+        {
+            for( std::size_t i = 0; i < 16; ++i )
+            {
+                secondary_indices[ i ] = bits.read(
+                    mode.secondary_index_bits - ( i == 0 ? 1 : 0 )
+                );
+            }
+        }
+        
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            auto const  subset = subset_of( i );
+            auto const& e_0    = endpoints[ subset * 2     ];
+            auto const& e_1    = endpoints[ subset * 2 + 1 ];
+            
+            // With two sets of indices, one is for color & the other alpha
+            auto color_index = indices[ i ];
+            auto color_bits  = mode.index_bits;
+            auto alpha_index = indices[ i ];
+            auto alpha_bits  = mode.index_bits;
+            if( mode.secondary_index_bits )
+            {
+                alpha_index = secondary_indices[ i ];
+                alpha_bits  = mode.secondary_index_bits;
+                if( index_selection )
+                {
+                    std::swap( color_index, alpha_index );
+                    std::swap( color_bits , alpha_bits  );
+                }
+            }
+            
+            std::array< int, 4 > pixel;
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                pixel[ c ] = bc7_interpolate(
+                    e_0[ c ],
+                    e_1[ c ],
+                    color_index,
+                    color_bits
+                );
+            }
+            pixel[ 3 ] = bc7_interpolate(
+                e_0[ 3 ],
+                e_1[ 3 ],
+                alpha_index,
+                alpha_bits
+            );
+            
+            // Rotation swaps alpha with one of the color channels
+            if( rotation )
+            {
+                std::swap( pixel[ 3 ], pixel[ rotation - 1 ] );
+            }
+            
+            for( std::size_t c = 0; c < 4; ++c )
+            {
+                out[ i ][ c ] = static_cast< std::uint8_t >( pixel[ c ] );
+            }
+        }
+    }
+    
+    JadeMatrix::yavsg::gl::texture_data_pointer decompress_level(
+        std::uint8_t const* in,
+        GLint               gl_internal_format,
+        std::size_t         width,
+        std::size_t         height,
+        std::size_t         channels
+    )
+    {
+        auto const blocks_wide = ( width  + 3 ) / 4;
+        auto const blocks_high = ( height + 3 ) / 4;
+        auto const bytes       = JadeMatrix::yavsg::gl::block_compressed_size(
+            gl_internal_format,
+            4,
+            4
+        );
+        
+        auto decompressed = JadeMatrix::yavsg::gl::make_texture_data(
+            width * height * channels
+        );
+        auto const out = reinterpret_cast< std::uint8_t* >(
+            decompressed.get()
+        );
+        
+        JadeMatrix::yavsg::parallel_for(
+            blocks_high,
+            [ & ]( std::size_t block_y ){
+                for( std::size_t block_x = 0; block_x < blocks_wide; ++block_x )
+                {
+                    auto const block = in + (
+                        ( block_y * blocks_wide + block_x ) * bytes
+                    );
+                    
+                    decoded_block pixels;
+                    for( auto& pixel : pixels )
+                    {
+                        pixel = { 0, 0, 0, 255 };
+                    }
+                    switch( gl_internal_format )
+                    {
+                    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+                        decode_bc1_block( block, false, pixels );
+                        break;
+                    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+                        decode_bc1_block( block + 8, true, pixels );
+                        decode_bc4_block( block, 3, pixels );
+                        break;
+                    case GL_COMPRESSED_RED_RGTC1:
+                        decode_bc4_block( block, 0, pixels );
+                        break;
+                    case GL_COMPRESSED_RG_RGTC2:
+                        decode_bc4_block( block    , 0, pixels );
+                        decode_bc4_block( block + 8, 1, pixels );
+                        break;
+                    default:
+                        decode_bc7_block( block, pixels );
+                        break;
+                    }
+                    
+                    // Partial blocks at the edges are cropped
+                    for( std::size_t i = 0; i < 16; ++i )
+                    {
+                        auto const x = block_x * 4 + i % 4;
+                        auto const y = block_y * 4 + i / 4;
+                        if( x >= width || y >= height )
+                        {
+                            continue;
+                        }
+                        std::copy_n(
+                            pixels[ i ].begin(),
+                            channels,
+                            out + ( y * width + x ) * channels
+                        );
+                    }
+                }
+            }
+        );
+        
+        return decompressed;
+    }
+}
+
+
+GLint JadeMatrix::yavsg::gl::block_compressed_internal_format(
+    block_compression compression,
+    bool              srgb
+)
+{
+    switch( compression )
+    {
+    case block_compression::bc1:
+        return (
+            srgb
+            ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+            : GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+        );
+    case block_compression::bc3:
+        return (
+            srgb
+            ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+            : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        );
+    case block_compression::bc4:
+        if( !srgb ) return GL_COMPRESSED_RED_RGTC1;
+        break;
+    case block_compression::bc5:
+        if( !srgb ) return GL_COMPRESSED_RG_RGTC2;
+        break;
+    case block_compression::bc7:
+        return (
+            srgb
+            ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+            : GL_COMPRESSED_RGBA_BPTC_UNORM
+        );
+    }
+    
+    throw std::invalid_argument(
+        "BC4 & BC5 have no sRGB formats for "
+        "yavsg::gl::block_compressed_internal_format()"
+    );
+}
+
+bool JadeMatrix::yavsg::gl::is_block_compressed_format(
+    GLint gl_internal_format
+)
+{
+    return block_compressed_size( gl_internal_format, 1, 1 ) > 0;
+}
+
+std::size_t JadeMatrix::yavsg::gl::block_compressed_size(
+    GLint       gl_internal_format,
+    std::size_t width,
+    std::size_t height
+)
+{
+    std::size_t bytes_per_block;
+    switch( gl_internal_format )
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1:
+        bytes_per_block = 8;
+        break;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        bytes_per_block = 16;
+        break;
+    default:
+        return 0;
+    }
+    
+    return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * bytes_per_block;
+}
+
+JadeMatrix::yavsg::gl::texture_upload_data
+JadeMatrix::yavsg::gl::compress_texture_data(
+    texture_upload_data upload_data,
+    block_compression   compression,
+    bool                srgb
+)
+{
+    if( !upload_data.data )
+    {
+        throw std::invalid_argument(
+            "null data to yavsg::gl::compress_texture_data()"
+        );
+    }
+    if( upload_data.gl_incoming_type != GL_UNSIGNED_BYTE )
+    {
+        throw std::runtime_error( fmt::format(
+            "unsupported OpenGL type {} for "
+                "yavsg::gl::compress_texture_data(), only 8-bit data can be "
+                "compressed"sv,
+            upload_data.gl_incoming_type
+        ) );
+    }
+    
+    source_level source{
+        reinterpret_cast< std::uint8_t const* >( upload_data.data.get() ),
+        upload_data.width,
+        upload_data.height,
+        0,
+        false
+    };
+    switch( upload_data.gl_incoming_format )
+    {
+    case GL_RED : source.channels = 1;                     break;
+    case GL_RG  : source.channels = 2;                     break;
+    case GL_RGB : source.channels = 3;                     break;
+    case GL_BGR : source.channels = 3; source.bgr = true; break;
+    case GL_RGBA: source.channels = 4;                     break;
+    case GL_BGRA: source.channels = 4; source.bgr = true; break;
+    default:
+        throw std::runtime_error( fmt::format(
+            "uknown/unsupported OpenGL pixel format {} for "
+                "yavsg::gl::compress_texture_data()"sv,
+            upload_data.gl_incoming_format
+        ) );
+    }
+    
+    upload_data.data = compress_level( source, compression );
+    for( auto& level : upload_data.mipmaps )
+    {
+        source.data   = reinterpret_cast< std::uint8_t const* >( level.get() );
+        source.width  = std::max< std::size_t >( 1, source.width  / 2 );
+        source.height = std::max< std::size_t >( 1, source.height / 2 );
+        level = compress_level( source, compression );
+    }
+    
+    upload_data.gl_internal_format = block_compressed_internal_format(
+        compression,
+        srgb
+    );
+    upload_data.gl_incoming_format = 0;
+    upload_data.gl_incoming_type   = 0;
+    
+    return upload_data;
+}
+
+bool JadeMatrix::yavsg::gl::block_compressed_format_supported(
+    GLint gl_internal_format
+)
+{
+    switch( gl_internal_format )
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return static_cast< bool >( GLEW_EXT_texture_compression_s3tc );
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        return (
+            static_cast< bool >( GLEW_EXT_texture_compression_s3tc )
+            && static_cast< bool >( GLEW_EXT_texture_sRGB )
+        );
+    case GL_COMPRESSED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2:
+        // Core since OpenGL 3.0
+        return true;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        return (
+            static_cast< bool >( GLEW_ARB_texture_compression_bptc )
+            || static_cast< bool >( GLEW_VERSION_4_2 )
+        );
+    default:
+        return false;
+    }
+}
+
+JadeMatrix::yavsg::gl::texture_upload_data
+JadeMatrix::yavsg::gl::decompress_texture_data(
+    texture_upload_data upload_data
+)
+{
+    if( !upload_data.data )
+    {
+        throw std::invalid_argument(
+            "null data to yavsg::gl::decompress_texture_data()"
+        );
+    }
+    
+    GLint  gl_internal_format;
+    GLenum gl_incoming_format;
+    switch( upload_data.gl_internal_format )
+    {
+    case GL_COMPRESSED_RED_RGTC1:
+        gl_internal_format = GL_R8;
+        gl_incoming_format = GL_RED;
+        break;
+    case GL_COMPRESSED_RG_RGTC2:
+        gl_internal_format = GL_RG8;
+        gl_incoming_format = GL_RG;
+        break;
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        gl_internal_format = GL_SRGB8_ALPHA8;
+        gl_incoming_format = GL_RGBA;
+        break;
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        gl_internal_format = GL_RGBA8;
+        gl_incoming_format = GL_RGBA;
+        break;
+    default:
+        throw std::invalid_argument( fmt::format(
+            "OpenGL format {} to yavsg::gl::decompress_texture_data() isn't "
+                "block-compressed"sv,
+            upload_data.gl_internal_format
+        ) );
+    }
+    auto const channels = std::size_t{
+        gl_incoming_format == GL_RED ? 1u
+        : gl_incoming_format == GL_RG ? 2u
+        : 4u
+    };
+    
+    auto width  = upload_data.width;
+    auto height = upload_data.height;
+    auto const decompress = [ & ]( texture_data_pointer const& level ){
+        return decompress_level(
+            reinterpret_cast< std::uint8_t const* >( level.get() ),
+            upload_data.gl_internal_format,
+            width,
+            height,
+            channels
+        );
+    };
+    
+    upload_data.data = decompress( upload_data.data );
+    for( auto& level : upload_data.mipmaps )
+    {
+        width  = std::max< std::size_t >( 1, width  / 2 );
+        height = std::max< std::size_t >( 1, height / 2 );
+        level  = decompress( level );
+    }
+    
+    upload_data.gl_internal_format = gl_internal_format;
+    upload_data.gl_incoming_format = gl_incoming_format;
+    upload_data.gl_incoming_type   = GL_UNSIGNED_BYTE;
+    
+    return upload_data;
+}
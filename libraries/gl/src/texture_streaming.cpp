@@ -0,0 +1,775 @@
+#include <yavsg/gl/texture_streaming.hpp>
+
+#include <yavsg/gl/texture_compression.hpp>
+
+#include <doctest/doctest.h>    // REQUIRE
+
+#include <algorithm>    // min, max
+#include <array>
+#include <atomic>
+#include <cstdint>      // int64_t
+#include <cstring>      // memcpy
+#include <limits>
+#include <stdexcept>    // invalid_argument
+#include <string>
+#include <utility>      // move
+
+
+namespace // Budget ////////////////////////////////////////////////////////////
+{
+    using clock_type = std::chrono::steady_clock;
+    
+    // The budget may be set from any thread
+    std::atomic< std::size_t  > budget_bytes{ 16 * 1024 * 1024 };
+    std::atomic< std::int64_t > budget_microseconds{ 2000 };
+    
+    // Only touched on the GPU thread
+    std::size_t            frame_bytes_spent = 0;
+    clock_type::duration   frame_time_spent{ 0 };
+    
+    bool budget_left( clock_type::duration extra_time )
+    {
+        auto const bytes        = budget_bytes       .load();
+        auto const microseconds = budget_microseconds.load();
+        
+        if( bytes > 0 && frame_bytes_spent >= bytes )
+        {
+            return false;
+        }
+        if(
+            microseconds > 0
+            && frame_time_spent + extra_time >= std::chrono::microseconds{
+                microseconds
+            }
+        )
+        {
+            return false;
+        }
+        return true;
+    }
+    
+    // Bytes that can still be uploaded this frame under a byte budget
+    std::size_t bytes_left()
+    {
+        auto const bytes = budget_bytes.load();
+        return bytes > frame_bytes_spent ? bytes - frame_bytes_spent : 0;
+    }
+}
+
+
+namespace // Staging buffers ///////////////////////////////////////////////////
+{
+    namespace gl = JadeMatrix::yavsg::gl;
+    
+    // Together these are as big as the default per-frame byte budget, so a
+    // frame's worth of uploads never has to wait on an earlier transfer
+    constexpr std::size_t staging_buffer_count = 4;
+    constexpr std::size_t staging_buffer_size  = 4 * 1024 * 1024;
+    
+    struct staging_buffer
+    {
+        GLuint gl_id = 0;
+        GLsync fence = nullptr;
+    };
+    
+    class staging_ring
+    {
+    public:
+        staging_ring()
+        {
+            for( auto& buffer : buffers_ )
+            {
+                gl::GenBuffers( 1, &buffer.gl_id );
+                gl::BindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer.gl_id );
+                gl::BufferData(
+                    GL_PIXEL_UNPACK_BUFFER,
+                    static_cast< GLsizeiptr >( staging_buffer_size ),
+                    nullptr,
+                    GL_STREAM_DRAW
+                );
+            }
+            gl::BindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+        }
+        
+        // The ring lives as long as the OpenGL context, so its buffers are
+        // left to be freed along with it
+        
+        // Returns the next buffer in the ring if the GPU has finished reading
+        // from it, or null rather than waiting if it hasn't
+        staging_buffer* acquire()
+        {
+            auto& buffer = buffers_[ next_ ];
+            if( buffer.fence )
+            {
+                if(
+                    gl::ClientWaitSync( buffer.fence, 0, 0 )
+                    == GL_TIMEOUT_EXPIRED
+                )
+                {
+                    return nullptr;
+                }
+                gl::DeleteSync( buffer.fence );
+                buffer.fence = nullptr;
+            }
+            next_ = ( next_ + 1 ) % buffers_.size();
+            return &buffer;
+        }
+        
+        // Marks the buffer as in use by every command issued so far
+        void release( staging_buffer& buffer )
+        {
+            buffer.fence = gl::FenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+        }
+    
+    protected:
+        std::array< staging_buffer, staging_buffer_count > buffers_;
+        std::size_t next_ = 0;
+    };
+    
+    // Created on first use, which is always on the GPU thread
+    staging_ring& staging()
+    {
+        static staging_ring ring;
+        return ring;
+    }
+}
+
+
+namespace // Layers ////////////////////////////////////////////////////////////
+{
+    bool same_shape(
+        gl::texture_upload_data const& a,
+        gl::texture_upload_data const& b
+    )
+    {
+        return (
+               a.gl_internal_format == b.gl_internal_format
+            && a.width              == b.width
+            && a.height             == b.height
+            && a.gl_incoming_format == b.gl_incoming_format
+            && a.gl_incoming_type   == b.gl_incoming_type
+            && a.mipmaps.size()     == b.mipmaps.size()
+        );
+    }
+}
+
+
+namespace JadeMatrix::yavsg::gl // Budget implementation ///////////////////////
+{
+    void set_texture_upload_budget( texture_upload_budget const& budget )
+    {
+        budget_bytes       .store( budget.bytes_per_frame        );
+        budget_microseconds.store( budget.time_per_frame.count() );
+    }
+    
+    texture_upload_budget texture_upload_budget_setting()
+    {
+        return {
+            budget_bytes.load(),
+            std::chrono::microseconds{ budget_microseconds.load() }
+        };
+    }
+    
+    void begin_texture_upload_frame()
+    {
+        frame_bytes_spent = 0;
+        frame_time_spent  = clock_type::duration{ 0 };
+    }
+    
+    bool texture_upload_budget_left()
+    {
+        return budget_left( clock_type::duration{ 0 } );
+    }
+}
+
+
+namespace JadeMatrix::yavsg::gl // Texture upload stream implementation ////////
+{
+    texture_upload_stream::texture_upload_stream(
+        GLuint                         gl_id,
+        texture_upload_data            upload_data,
+        texture_filter_settings const& settings
+    ) :
+        gl_id_     { gl_id         },
+        target_    { GL_TEXTURE_2D },
+        settings_  { settings      },
+        compressed_{ is_block_compressed_format(
+            upload_data.gl_internal_format
+        ) }
+    {
+        layers_.push_back( std::move( upload_data ) );
+        
+        resident_level_  = level_count();
+        allocated_level_ = level_count();
+    }
+    
+    texture_upload_stream::texture_upload_stream(
+        GLuint                             gl_id,
+        std::vector< texture_upload_data > layers,
+        texture_filter_settings     const& settings
+    ) :
+        gl_id_   { gl_id               },
+        target_  { GL_TEXTURE_2D_ARRAY },
+        layers_  { std::move( layers ) },
+        settings_{ settings            }
+    {
+        using namespace std::string_literals;
+        
+        if( layers_.empty() )
+        {
+            throw std::invalid_argument(
+                "yavsg::gl::texture_upload_stream needs at least one layer"s
+            );
+        }
+        
+        auto const& first = layers_.front();
+        for( auto const& layer : layers_ )
+        {
+            if( !same_shape( layer, first ) || !layer.data )
+            {
+                throw std::invalid_argument(
+                    "yavsg::gl::texture_upload_stream layers must all share "
+                    "the same formats, size, & mip levels"s
+                );
+            }
+        }
+        
+        compressed_ = is_block_compressed_format( first.gl_internal_format );
+        
+        resident_level_  = level_count();
+        allocated_level_ = level_count();
+    }
+    
+    bool texture_upload_stream::upload_some()
+    {
+        if( finished() )
+        {
+            return true;
+        }
+        if( !texture_upload_budget_left() )
+        {
+            return false;
+        }
+        
+        auto const start_time = clock_type::now();
+        
+        gl::BindTexture( target_, gl_id_ );
+        gl::PixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        
+        auto const& first         = layers_.front();
+        auto const  rows_per_unit = std::size_t{ compressed_ ? 4u : 1u };
+        
+        while(
+            resident_level_ > target_level_
+            && budget_left( clock_type::now() - start_time )
+        )
+        {
+            // Levels are uploaded smallest first, so there's always something
+            // to sample as soon as the first one is done
+            auto const level = resident_level_ - 1;
+            if( allocated_level_ > level )
+            {
+                allocate_level( level );
+            }
+            
+            auto const width     = level_width ( level );
+            auto const height    = level_height( level );
+            auto const row_size  = incoming_row_size( first, width );
+            auto const row_count = (
+                ( height + rows_per_unit - 1 ) / rows_per_unit
+            );
+            
+            // Always upload at least one row so every frame makes progress
+            auto rows = std::min(
+                row_count - row_,
+                std::max< std::size_t >( 1, staging_buffer_size / row_size )
+            );
+            if( budget_bytes.load() > 0 )
+            {
+                rows = std::min(
+                    rows,
+                    std::max< std::size_t >( 1, bytes_left() / row_size )
+                );
+            }
+            
+            auto const chunk_size = rows * row_size;
+            auto const& data      = level_data( layers_[ layer_ ], level );
+            REQUIRE( data );
+            auto const  source    = data.get() + row_ * row_size;
+            
+            auto const y_offset     = row_ * rows_per_unit;
+            auto const chunk_height = std::min(
+                rows * rows_per_unit,
+                height - y_offset
+            );
+            
+            REQUIRE( width        <= std::numeric_limits< GLsizei >::max() );
+            REQUIRE( chunk_height <= std::numeric_limits< GLsizei >::max() );
+            REQUIRE( y_offset     <= std::numeric_limits< GLint   >::max() );
+            REQUIRE( chunk_size   <= std::numeric_limits< GLsizei >::max() );
+            
+            auto const upload_rows = [ & ]( void const* data ){
+                auto const gl_level = static_cast< GLint   >( level        );
+                auto const gl_y     = static_cast< GLint   >( y_offset     );
+                auto const gl_width = static_cast< GLsizei >( width        );
+                auto const gl_rows  = static_cast< GLsizei >( chunk_height );
+                auto const gl_layer = static_cast< GLint   >( layer_       );
+                
+                if( target_ == GL_TEXTURE_2D_ARRAY && compressed_ )
+                {
+                    gl::CompressedTexSubImage3D(
+                        target_, gl_level,
+                        0, gl_y, gl_layer,
+                        gl_width, gl_rows, 1,
+                        static_cast< GLenum >( first.gl_internal_format ),
+                        static_cast< GLsizei >( chunk_size ),
+                        data
+                    );
+                }
+                else if( target_ == GL_TEXTURE_2D_ARRAY )
+                {
+                    gl::TexSubImage3D(
+                        target_, gl_level,
+                        0, gl_y, gl_layer,
+                        gl_width, gl_rows, 1,
+                        first.gl_incoming_format,
+                        first.gl_incoming_type,
+                        data
+                    );
+                }
+                else if( compressed_ )
+                {
+                    gl::CompressedTexSubImage2D(
+                        target_, gl_level,
+                        0, gl_y,
+                        gl_width, gl_rows,
+                        static_cast< GLenum >( first.gl_internal_format ),
+                        static_cast< GLsizei >( chunk_size ),
+                        data
+                    );
+                }
+                else
+                {
+                    gl::TexSubImage2D(
+                        target_, gl_level,
+                        0, gl_y,
+                        gl_width, gl_rows,
+                        first.gl_incoming_format,
+                        first.gl_incoming_type,
+                        data
+                    );
+                }
+            };
+            
+            if( chunk_size > staging_buffer_size )
+            {
+                // A single row too wide to stage; rare enough to just upload
+                // it directly
+                upload_rows( source );
+            }
+            else
+            {
+                auto const buffer = staging().acquire();
+                if( !buffer )
+                {
+                    // Every staging buffer is still in flight, so continue
+                    // next frame rather than waiting on the GPU
+                    break;
+                }
+                
+                gl::BindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer->gl_id );
+                auto const mapped = gl::MapBufferRange(
+                    GL_PIXEL_UNPACK_BUFFER,
+                    0,
+                    static_cast< GLsizeiptr >( chunk_size ),
+                    // The fence already guarantees the GPU is done with it
+                    (
+                          GL_MAP_WRITE_BIT
+                        | GL_MAP_INVALIDATE_BUFFER_BIT
+                        | GL_MAP_UNSYNCHRONIZED_BIT
+                    )
+                );
+                std::memcpy( mapped, source, chunk_size );
+                auto const intact = gl::UnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+                
+                // The data pointer is an offset into the bound buffer
+                if( intact )
+                {
+                    upload_rows( nullptr );
+                    staging().release( *buffer );
+                }
+                gl::BindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+                
+                if( !intact )
+                {
+                    // The buffer's contents were lost (e.g. by a display mode
+                    // change), so try the same rows again next frame
+                    break;
+                }
+            }
+            
+            frame_bytes_spent += chunk_size;
+            
+            row_ += rows;
+            if( row_ >= row_count )
+            {
+                row_ = 0;
+                if( ++layer_ >= layers_.size() )
+                {
+                    layer_ = 0;
+                    finish_level( level );
+                }
+            }
+        }
+        
+        frame_time_spent += clock_type::now() - start_time;
+        
+        return finished();
+    }
+    
+    bool texture_upload_stream::finished() const
+    {
+        return resident_level_ <= target_level_;
+    }
+    
+    GLuint texture_upload_stream::gl_texture_id() const
+    {
+        return gl_id_;
+    }
+    
+    std::size_t texture_upload_stream::level_count() const
+    {
+        return layers_.front().mipmaps.size() + 1;
+    }
+    
+    std::size_t texture_upload_stream::level_width( std::size_t level ) const
+    {
+        return std::max< std::size_t >( 1, layers_.front().width >> level );
+    }
+    
+    std::size_t texture_upload_stream::level_height( std::size_t level ) const
+    {
+        return std::max< std::size_t >( 1, layers_.front().height >> level );
+    }
+    
+    std::size_t texture_upload_stream::level_bytes( std::size_t level ) const
+    {
+        auto const& first  = layers_.front();
+        auto const  width  = level_width ( level );
+        auto const  height = level_height( level );
+        
+        auto const layer_bytes = (
+            compressed_
+            ? block_compressed_size( first.gl_internal_format, width, height )
+            : incoming_row_size( first, width ) * height
+        );
+        return layer_bytes * layers_.size();
+    }
+    
+    std::size_t texture_upload_stream::allocated_bytes() const
+    {
+        std::size_t bytes = 0;
+        for( auto level = allocated_level_; level < level_count(); ++level )
+        {
+            bytes += level_bytes( level );
+        }
+        return bytes;
+    }
+    
+    std::size_t texture_upload_stream::resident_level() const
+    {
+        return resident_level_;
+    }
+    
+    std::size_t texture_upload_stream::target_level() const
+    {
+        return target_level_;
+    }
+    
+    void texture_upload_stream::target_level( std::size_t level )
+    {
+        target_level_ = std::min( level, level_count() - 1 );
+        
+        if( allocated_level_ >= target_level_ )
+        {
+            return;
+        }
+        
+        gl::BindTexture( target_, gl_id_ );
+        
+        // Stop sampling from the evicted levels before freeing them
+        if( resident_level_ < target_level_ )
+        {
+            resident_level_ = target_level_;
+            gl::TexParameteri(
+                target_,
+                GL_TEXTURE_BASE_LEVEL,
+                static_cast< GLint >( resident_level_ )
+            );
+        }
+        
+        for( auto free = allocated_level_; free < target_level_; ++free )
+        {
+            release_level( free );
+        }
+        allocated_level_ = target_level_;
+        
+        // Any partially-uploaded level was just freed
+        layer_ = 0;
+        row_   = 0;
+    }
+    
+    void texture_upload_stream::allocate_level( std::size_t level )
+    {
+        auto const& first = layers_.front();
+        
+        if( allocated_level_ == level_count() )
+        {
+            // First allocation, so the smallest level; with storage allocated
+            // one level at a time the level range has to be set explicitly
+            if( compressed_ || level_count() > 1 )
+            {
+                gl::TexParameteri(
+                    target_,
+                    GL_TEXTURE_MAX_LEVEL,
+                    static_cast< GLint >( level_count() - 1 )
+                );
+            }
+        }
+        
+        auto const full_width  = level_width ( level );
+        auto const full_height = level_height( level );
+        auto const full_size   = level_bytes ( level );
+        
+        REQUIRE( full_width     <= std::numeric_limits< GLsizei >::max() );
+        REQUIRE( full_height    <= std::numeric_limits< GLsizei >::max() );
+        REQUIRE( full_size      <= std::numeric_limits< GLsizei >::max() );
+        REQUIRE( layers_.size() <= std::numeric_limits< GLsizei >::max() );
+        auto const gl_level = static_cast< GLint   >( level          );
+        auto const width    = static_cast< GLsizei >( full_width     );
+        auto const height   = static_cast< GLsizei >( full_height    );
+        auto const size     = static_cast< GLsizei >( full_size      );
+        auto const depth    = static_cast< GLsizei >( layers_.size() );
+        
+        if( target_ == GL_TEXTURE_2D_ARRAY && compressed_ )
+        {
+            gl::CompressedTexImage3D(
+                target_,
+                gl_level,
+                static_cast< GLenum >( first.gl_internal_format ),
+                width,
+                height,
+                depth,
+                0,
+                size,
+                nullptr
+            );
+        }
+        else if( target_ == GL_TEXTURE_2D_ARRAY )
+        {
+            gl::TexImage3D(
+                target_,
+                gl_level,
+                first.gl_internal_format,
+                width,
+                height,
+                depth,
+                0,
+                first.gl_incoming_format,
+                first.gl_incoming_type,
+                nullptr
+            );
+        }
+        else if( compressed_ )
+        {
+            gl::CompressedTexImage2D(
+                target_,
+                gl_level,
+                static_cast< GLenum >( first.gl_internal_format ),
+                width,
+                height,
+                0,
+                size,
+                nullptr
+            );
+        }
+        else
+        {
+            gl::TexImage2D(
+                target_,
+                gl_level,
+                first.gl_internal_format,
+                width,
+                height,
+                0,
+                first.gl_incoming_format,
+                first.gl_incoming_type,
+                nullptr
+            );
+        }
+        
+        allocated_level_ = level;
+    }
+    
+    void texture_upload_stream::release_level( std::size_t level )
+    {
+        auto const& first    = layers_.front();
+        auto const  gl_level = static_cast< GLint >( level );
+        
+        // Redefining a level as empty frees its storage, which is only
+        // possible because these textures are never made immutable
+        if( target_ == GL_TEXTURE_2D_ARRAY && compressed_ )
+        {
+            gl::CompressedTexImage3D(
+                target_,
+                gl_level,
+                static_cast< GLenum >( first.gl_internal_format ),
+                0, 0, 0,
+                0,
+                0,
+                nullptr
+            );
+        }
+        else if( target_ == GL_TEXTURE_2D_ARRAY )
+        {
+            gl::TexImage3D(
+                target_,
+                gl_level,
+                first.gl_internal_format,
+                0, 0, 0,
+                0,
+                first.gl_incoming_format,
+                first.gl_incoming_type,
+                nullptr
+            );
+        }
+        else if( compressed_ )
+        {
+            gl::CompressedTexImage2D(
+                target_,
+                gl_level,
+                static_cast< GLenum >( first.gl_internal_format ),
+                0, 0,
+                0,
+                0,
+                nullptr
+            );
+        }
+        else
+        {
+            gl::TexImage2D(
+                target_,
+                gl_level,
+                first.gl_internal_format,
+                0, 0,
+                0,
+                first.gl_incoming_format,
+                first.gl_incoming_type,
+                nullptr
+            );
+        }
+    }
+    
+    void texture_upload_stream::finish_level( std::size_t level )
+    {
+        if( resident_level_ == level_count() )
+        {
+            // The first level to finish makes the texture usable
+            set_bound_texture_filtering(
+                settings_,
+                !compressed_ && level_count() == 1,
+                target_
+            );
+        }
+        
+        resident_level_ = level;
+        gl::TexParameteri(
+            target_,
+            GL_TEXTURE_BASE_LEVEL,
+            static_cast< GLint >( resident_level_ )
+        );
+        
+        if( discard_uploaded_ )
+        {
+            for( auto& layer : layers_ )
+            {
+                level_data( layer, level ).reset();
+            }
+        }
+    }
+    
+    void texture_upload_stream::discard_uploaded_data()
+    {
+        discard_uploaded_ = true;
+        for( auto level = resident_level_; level < level_count(); ++level )
+        {
+            for( auto& layer : layers_ )
+            {
+                level_data( layer, level ).reset();
+            }
+        }
+    }
+    
+    bool texture_upload_stream::level_data_available(
+        std::size_t level
+    ) const
+    {
+        for( auto const& layer : layers_ )
+        {
+            auto const& data = (
+                level == 0 ? layer.data : layer.mipmaps[ level - 1 ]
+            );
+            if( !data )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void texture_upload_stream::restore_data(
+        std::vector< texture_upload_data > layers
+    )
+    {
+        using namespace std::string_literals;
+        
+        if( layers.size() != layers_.size() )
+        {
+            throw std::invalid_argument(
+                "yavsg::gl::texture_upload_stream can only restore data for "
+                "every layer at once"s
+            );
+        }
+        for( std::size_t i = 0; i < layers.size(); ++i )
+        {
+            if( !same_shape( layers[ i ], layers_[ i ] ) )
+            {
+                throw std::invalid_argument(
+                    "yavsg::gl::texture_upload_stream restored data must "
+                    "match the original formats, size, & mip levels"s
+                );
+            }
+        }
+        
+        // Resident levels don't need their data, so only the rest is kept
+        for( std::size_t i = 0; i < layers.size(); ++i )
+        {
+            for( std::size_t level = 0; level < resident_level_; ++level )
+            {
+                auto& data = level_data( layers_[ i ], level );
+                if( !data )
+                {
+                    data = std::move( level_data( layers[ i ], level ) );
+                }
+            }
+        }
+    }
+    
+    texture_data_pointer& texture_upload_stream::level_data(
+        texture_upload_data& layer,
+        std::size_t          level
+    )
+    {
+        return level == 0 ? layer.data : layer.mipmaps[ level - 1 ];
+    }
+}
@@ -1,23 +1,51 @@
 #include <yavsg/gl/texture_utilities.hpp>
 
 #include <yavsg/gl/error.hpp>
+#include <yavsg/gl/texture_compression.hpp>
 #include <yavsg/math/scalar_operations.hpp> // power
+#include <yavsg/tasking/parallel_for.hpp>
 
 #include <fmt/format.h>
 #include <doctest/doctest.h>    // REQUIRE
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>      // uint32_t, int64_t, uint64_t
+#include <cstring>      // memcpy
+#include <functional>
+#include <iterator>     // prev
 #include <limits>
+#include <map>          // multimap
+#include <memory>       // unique_ptr, make_unique
 #include <mutex>        // mutex, once_flag, call_once
-#include <stdexcept>    // runtime_error
-#include <type_traits>  // conditional, is_floating_point, enable_if_t
-#include <utility>      // swap
+#include <stdexcept>    // runtime_error, invalid_argument
+#include <string>
+#include <type_traits>  // conditional, is_floating_point, enable_if_t, is_same
+#include <utility>      // move
+#include <vector>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+    #define YAVSG_TEXTURE_UTILITIES_SSE
+    #include <emmintrin.h>
+#endif
+
+// GCC & Clang only define `__F16C__` when it's enabled, which `-mavx2` alone
+// doesn't do; MSVC has no such macro, but every CPU with AVX2 has F16C
+#if defined( __F16C__ ) || ( defined( _MSC_VER ) && defined( __AVX2__ ) )
+    #define YAVSG_TEXTURE_UTILITIES_F16C
+    #include <immintrin.h>
+#endif
 
 
 namespace
 {
     using namespace std::string_literals;
     using namespace std::string_view_literals;
+    
+    // Preprocessing is split into tiles of whole rows of about this many
+    // pixels so large textures are spread over task workers
+    constexpr std::size_t pixels_per_preprocess_tile = 64 * 1024;
 }
 
 
@@ -48,6 +76,13 @@ namespace // Anisotropic filtering support /////////////////////////////////////
 }
 
 
+namespace // Immutable storage support /////////////////////////////////////////
+{
+    std::once_flag texture_storage_flag;
+    bool           texture_storage_value;
+}
+
+
 namespace // Alpha & gamma preprocess functions ////////////////////////////////
 {
     template< typename T > T linearize_sample( T sample )
@@ -211,11 +246,703 @@ namespace // Alpha & gamma preprocess functions ////////////////////////////////
 }
 
 
+namespace // Lookup-table preprocess kernels ///////////////////////////////////
+{
+    // Same conversion as `premultiply<>()` above for a single sample
+    template< typename T > T convert_sample(
+        std::size_t sample,
+        std::size_t alpha,
+        bool        multiply_alpha,
+        bool        linearize
+    )
+    {
+        auto const max = static_cast< double >(
+            std::numeric_limits< T >::max()
+        );
+        
+        auto in_sample = static_cast< double >( sample ) / max;
+        if( multiply_alpha )
+        {
+            in_sample *= static_cast< double >( alpha ) / max;
+        }
+        if( linearize )
+        {
+            in_sample = linearize_sample( in_sample );
+        }
+        return static_cast< T >( in_sample * max );
+    }
+    
+    // Tables mapping every possible sample value to its converted value, built
+    // the first time each combination of conversions is needed.  8-bit tables
+    // also have a row for every alpha value so premultiplication is part of the
+    // lookup; 16-bit tables would be far too large for that, so they're only
+    // ever indexed by sample.
+    template< typename T > T const* conversion_table(
+        bool multiply_alpha,
+        bool linearize
+    )
+    {
+        constexpr auto values = static_cast< std::size_t >(
+            std::numeric_limits< T >::max()
+        ) + 1;
+        constexpr auto alpha_rows = sizeof( T ) == 1;
+        
+        multiply_alpha = multiply_alpha && alpha_rows;
+        
+        static std::array< std::once_flag           , 4 > built;
+        static std::array< std::unique_ptr< T[] >, 4 > tables;
+        
+        auto const index = ( multiply_alpha ? 2u : 0u ) + ( linearize ? 1u : 0u );
+        std::call_once( built[ index ], [ & ](){
+            auto const rows  = multiply_alpha ? values : 1;
+            auto       table = std::make_unique< T[] >( rows * values );
+            for( std::size_t row = 0; row < rows; ++row )
+            {
+                auto const alpha = multiply_alpha ? row : values - 1;
+                for( std::size_t sample = 0; sample < values; ++sample )
+                {
+                    table[ row * values + sample ] = convert_sample< T >(
+                        sample,
+                        alpha,
+                        multiply_alpha,
+                        linearize
+                    );
+                }
+            }
+            tables[ index ] = std::move( table );
+        } );
+        
+        return tables[ index ].get();
+    }
+    
+    // Checks whether every pixel of 4-channel data has an alpha of 100%
+    template< typename T > bool alpha_is_opaque(
+        T const*    data,
+        std::size_t sample_count
+    )
+    {
+        constexpr auto max = std::numeric_limits< T >::max();
+        
+        std::size_t i = 0;
+        
+    #ifdef YAVSG_TEXTURE_UTILITIES_SSE
+        // Each 16-byte load covers 4 8-bit or 2 16-bit pixels; only the bytes
+        // of the alpha samples are checked in the comparison mask
+        constexpr std::size_t pixels_per_load = 16 / ( sizeof( T ) * 4 );
+        constexpr int alpha_mask = sizeof( T ) == 1 ? 0x8888 : 0xC0C0;
+        
+        auto const all_max = _mm_set1_epi8( static_cast< char >( 0xFF ) );
+        for( ; i + pixels_per_load <= sample_count; i += pixels_per_load )
+        {
+            auto const pixels = _mm_loadu_si128(
+                reinterpret_cast< __m128i const* >( data + i * 4 )
+            );
+            auto const equal = _mm_movemask_epi8(
+                _mm_cmpeq_epi8( pixels, all_max )
+            );
+            if( ( equal & alpha_mask ) != alpha_mask )
+            {
+                return false;
+            }
+        }
+    #endif
+        
+        for( ; i < sample_count; ++i )
+        {
+            if( data[ i * 4 + 3 ] != max )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Drop-in replacement for `premultiply<>()` for unsigned 8- & 16-bit data
+    // that uses the lookup tables above instead of converting every sample to
+    // `double` & calling `pow()`
+    template< typename T > bool premultiply_lut(
+        void const* data,
+        void      * preprocessed_data,
+        std::size_t sample_count,
+        std::size_t channels,
+        JadeMatrix::yavsg::gl::texture_flags_type flags
+    )
+    {
+        static_assert( sizeof( T ) <= 2, "lookup tables only up to 16 bits" );
+        
+        constexpr auto values = static_cast< std::size_t >(
+            std::numeric_limits< T >::max()
+        ) + 1;
+        constexpr auto max = std::uint32_t{ std::numeric_limits< T >::max() };
+        
+        auto const multiply_alpha = !(
+            flags
+            & JadeMatrix::yavsg::gl::texture_flag::disable_premultiplied_alpha
+        );
+        auto const linearize = !(
+            flags
+            & JadeMatrix::yavsg::gl::texture_flag::linear_input
+        );
+        
+        auto  in_data = static_cast< T const* >(              data );
+        auto out_data = static_cast< T      * >( preprocessed_data );
+        
+        auto const has_varying_alpha = (
+            channels > 3
+            && !alpha_is_opaque( in_data, sample_count )
+        );
+        // Premultiplying by 100% alpha does nothing, so a fully-opaque texture
+        // can use the smaller table
+        auto const use_alpha = multiply_alpha && has_varying_alpha;
+        
+        auto const table = conversion_table< T >( use_alpha, linearize );
+        auto const color_channels = std::min< std::size_t >( channels, 3 );
+        
+        for( std::size_t i = 0; i < sample_count; ++i )
+        {
+            auto const pixel_in  =  in_data + channels * i;
+            auto const pixel_out = out_data + channels * i;
+            
+            auto row = table;
+            if constexpr( sizeof( T ) == 1 )
+            {
+                if( use_alpha )
+                {
+                    row += values * pixel_in[ 3 ];
+                }
+            }
+            
+            for( std::size_t j = 0; j < color_channels; ++j )
+            {
+                auto sample = pixel_in[ j ];
+                if constexpr( sizeof( T ) > 1 )
+                {
+                    if( use_alpha )
+                    {
+                        sample = static_cast< T >(
+                            std::uint32_t{ sample } * pixel_in[ 3 ] / max
+                        );
+                    }
+                }
+                pixel_out[ j ] = row[ sample ];
+            }
+            
+            // No conversions applied to alpha channel
+            for( std::size_t j = color_channels; j < channels; ++j )
+            {
+                pixel_out[ j ] = pixel_in[ j ];
+            }
+        }
+        
+        return has_varying_alpha;
+    }
+}
+
+namespace // Mipmap generation /////////////////////////////////////////////////
+{
+    std::size_t incoming_channels( GLenum gl_incoming_format )
+    {
+        switch( gl_incoming_format )
+        {
+        case GL_RED : return 1;
+        case GL_RG  : return 2;
+        case GL_RGB :
+        case GL_BGR : return 3;
+        case GL_RGBA:
+        case GL_BGRA: return 4;
+        default:
+            throw std::runtime_error( fmt::format(
+                "uknown/unsupported OpenGL pixel format {} for "
+                    "yavsg::gl::process_texture_data()"sv,
+                gl_incoming_format
+            ) );
+        }
+    }
+    
+    // Wide enough to sum four samples of `T` without overflowing
+    template< typename T > using box_sum_type = std::conditional_t<
+        std::is_floating_point< T >::value,
+        T,
+        std::conditional_t<
+            std::is_signed< T >::value,
+            std::int64_t,
+            std::uint64_t
+        >
+    >;
+    
+    template< typename T > T box_average( box_sum_type< T > sum )
+    {
+        if constexpr( std::is_floating_point< T >::value )
+        {
+            return sum / static_cast< T >( 4 );
+        }
+        else if constexpr( std::is_signed< T >::value )
+        {
+            return static_cast< T >( ( sum + ( sum < 0 ? -2 : 2 ) ) / 4 );
+        }
+        else
+        {
+            return static_cast< T >( ( sum + 2 ) / 4 );
+        }
+    }
+
+#ifdef YAVSG_TEXTURE_UTILITIES_SSE
+    // Averages 2x2 blocks of 8-bit RGBA pixels two destination pixels at a
+    // time; returns how many destination pixels were written
+    std::size_t box_downsample_rgba8_sse(
+        GLubyte const* row_0,
+        GLubyte const* row_1,
+        GLubyte      * destination,
+        std::size_t    width
+    )
+    {
+        auto const zero     = _mm_setzero_si128();
+        auto const rounding = _mm_set1_epi16( 2 );
+        
+        std::size_t x = 0;
+        for( ; x + 2 <= width; x += 2 )
+        {
+            auto const top = _mm_loadu_si128(
+                reinterpret_cast< __m128i const* >( row_0 + x * 8 )
+            );
+            auto const bottom = _mm_loadu_si128(
+                reinterpret_cast< __m128i const* >( row_1 + x * 8 )
+            );
+            
+            // Vertical sums of source pixels 0 & 1, then 2 & 3
+            auto const low = _mm_add_epi16(
+                _mm_unpacklo_epi8( top   , zero ),
+                _mm_unpacklo_epi8( bottom, zero )
+            );
+            auto const high = _mm_add_epi16(
+                _mm_unpackhi_epi8( top   , zero ),
+                _mm_unpackhi_epi8( bottom, zero )
+            );
+            
+            // Horizontal sums, giving destination pixels 0 & 1
+            auto const sums = _mm_add_epi16(
+                _mm_unpacklo_epi64( low, high ),
+                _mm_unpackhi_epi64( low, high )
+            );
+            auto const averages = _mm_srli_epi16(
+                _mm_add_epi16( sums, rounding ),
+                2
+            );
+            
+            _mm_storel_epi64(
+                reinterpret_cast< __m128i* >( destination + x * 4 ),
+                _mm_packus_epi16( averages, zero )
+            );
+        }
+        
+        return x;
+    }
+#endif
+    
+    // Box-filters rows `[first_row, first_row + row_count)` of a mip level from
+    // the level above it; odd source dimensions drop their last row/column,
+    // same as OpenGL's own level sizes
+    template< typename T > void box_downsample_rows(
+        T const*    source,
+        std::size_t source_width,
+        std::size_t source_height,
+        T         * destination,
+        std::size_t width,
+        std::size_t first_row,
+        std::size_t row_count,
+        std::size_t channels
+    )
+    {
+        for( auto y = first_row; y < first_row + row_count; ++y )
+        {
+            auto const row_0 = source + (
+                std::min( y * 2    , source_height - 1 ) * source_width * channels
+            );
+            auto const row_1 = source + (
+                std::min( y * 2 + 1, source_height - 1 ) * source_width * channels
+            );
+            auto const row_out = destination + y * width * channels;
+            
+            std::size_t x = 0;
+            
+        #ifdef YAVSG_TEXTURE_UTILITIES_SSE
+            if constexpr( std::is_same< T, GLubyte >::value )
+            {
+                // The vector path reads four whole source pixels per pair of
+                // destination pixels, which is only guaranteed when the
+                // source is at least twice as wide
+                if( channels == 4 && source_width >= width * 2 )
+                {
+                    x = box_downsample_rgba8_sse(
+                        row_0,
+                        row_1,
+                        row_out,
+                        width
+                    );
+                }
+            }
+        #endif
+            
+            for( ; x < width; ++x )
+            {
+                auto const x_0 = std::min( x * 2    , source_width - 1 );
+                auto const x_1 = std::min( x * 2 + 1, source_width - 1 );
+                
+                for( std::size_t c = 0; c < channels; ++c )
+                {
+                    row_out[ x * channels + c ] = box_average< T >(
+                          box_sum_type< T >( row_0[ x_0 * channels + c ] )
+                        + box_sum_type< T >( row_0[ x_1 * channels + c ] )
+                        + box_sum_type< T >( row_1[ x_0 * channels + c ] )
+                        + box_sum_type< T >( row_1[ x_1 * channels + c ] )
+                    );
+                }
+            }
+        }
+    }
+    
+    // 8-bit sRGB-encoded values decoded to linear
+    std::array< float, 256 > const& srgb_decode_table()
+    {
+        static auto const table = [](){
+            std::array< float, 256 > table;
+            for( std::size_t i = 0; i < table.size(); ++i )
+            {
+                table[ i ] = static_cast< float >(
+                    linearize_sample( static_cast< double >( i ) / 255.0 )
+                );
+            }
+            return table;
+        }();
+        return table;
+    }
+    
+    // Linear values quantized to 16 bits encoded back to 8-bit sRGB, which is
+    // fine enough to round-trip every 8-bit sRGB value
+    GLubyte const* srgb_encode_table()
+    {
+        static auto const table = [](){
+            auto table = std::make_unique< GLubyte[] >( 65536 );
+            for( std::size_t i = 0; i < 65536; ++i )
+            {
+                auto const linear = static_cast< double >( i ) / 65535.0;
+                auto const encoded = (
+                    linear <= 0.0031308
+                    ? linear * 12.92
+                    : 1.055 * JadeMatrix::yavsg::power(
+                        linear,
+                        1.0 / 2.4
+                    ) - 0.055
+                );
+                table[ i ] = static_cast< GLubyte >( encoded * 255.0 + 0.5 );
+            }
+            return table;
+        }();
+        return table.get();
+    }
+    
+    // Same as `box_downsample_rows()`, but color channels are averaged in
+    // linear space & re-encoded for textures stored as sRGB
+    void box_downsample_rows_srgb(
+        GLubyte const* source,
+        std::size_t    source_width,
+        std::size_t    source_height,
+        GLubyte      * destination,
+        std::size_t    width,
+        std::size_t    first_row,
+        std::size_t    row_count,
+        std::size_t    channels
+    )
+    {
+        auto const& decode = srgb_decode_table();
+        auto const  encode = srgb_encode_table();
+        auto const  color_channels = std::min< std::size_t >( channels, 3 );
+        
+        for( auto y = first_row; y < first_row + row_count; ++y )
+        {
+            auto const row_0 = source + (
+                std::min( y * 2    , source_height - 1 ) * source_width * channels
+            );
+            auto const row_1 = source + (
+                std::min( y * 2 + 1, source_height - 1 ) * source_width * channels
+            );
+            auto const row_out = destination + y * width * channels;
+            
+            for( std::size_t x = 0; x < width; ++x )
+            {
+                auto const p_0 = std::min( x * 2    , source_width - 1 ) * channels;
+                auto const p_1 = std::min( x * 2 + 1, source_width - 1 ) * channels;
+                
+                for( std::size_t c = 0; c < color_channels; ++c )
+                {
+                    auto const linear = 0.25f * (
+                          decode[ row_0[ p_0 + c ] ]
+                        + decode[ row_0[ p_1 + c ] ]
+                        + decode[ row_1[ p_0 + c ] ]
+                        + decode[ row_1[ p_1 + c ] ]
+                    );
+                    row_out[ x * channels + c ] = encode[
+                        static_cast< std::size_t >( linear * 65535.0f + 0.5f )
+                    ];
+                }
+                
+                // Alpha is always linear
+                for( std::size_t c = color_channels; c < channels; ++c )
+                {
+                    row_out[ x * channels + c ] = box_average< GLubyte >(
+                          box_sum_type< GLubyte >( row_0[ p_0 + c ] )
+                        + box_sum_type< GLubyte >( row_0[ p_1 + c ] )
+                        + box_sum_type< GLubyte >( row_1[ p_0 + c ] )
+                        + box_sum_type< GLubyte >( row_1[ p_1 + c ] )
+                    );
+                }
+            }
+        }
+    }
+    
+    // Preprocessed data is linear & (unless disabled) alpha-premultiplied, so
+    // a plain box filter is gamma-correct & doesn't bleed transparent colors;
+    // data left sRGB-encoded for OpenGL to decode is filtered accordingly.  A
+    // 2x2 box is the cheapest filter & the easiest to vectorize, but a wider
+    // windowed-sinc one such as Kaiser keeps lower levels noticeably sharper &
+    // lets through less aliasing from fine detail; odd sizes also just drop
+    // the last row/column (a width of 5 becomes 2 from columns 0-3) rather
+    // than weighting it into its neighbors
+    template< typename T > void generate_mipmaps(
+        JadeMatrix::yavsg::gl::texture_upload_data& upload_data,
+        std::size_t                                 channels,
+        bool                                        srgb_encoded
+    )
+    {
+        auto source        = reinterpret_cast< T const* >(
+            upload_data.data.get()
+        );
+        auto source_width  = upload_data.width;
+        auto source_height = upload_data.height;
+        
+        if( source_width == 0 || source_height == 0 )
+        {
+            return;
+        }
+        
+        while( source_width > 1 || source_height > 1 )
+        {
+            auto const width  = std::max< std::size_t >( 1, source_width  / 2 );
+            auto const height = std::max< std::size_t >( 1, source_height / 2 );
+            
+            auto level = JadeMatrix::yavsg::gl::make_texture_data(
+                width * height * channels * sizeof( T )
+            );
+            auto const destination = reinterpret_cast< T* >( level.get() );
+            
+            auto const rows_per_tile = std::max< std::size_t >(
+                1,
+                pixels_per_preprocess_tile / width
+            );
+            auto const tile_count = ( height + rows_per_tile - 1 ) / rows_per_tile;
+            
+            JadeMatrix::yavsg::parallel_for(
+                tile_count,
+                [ & ]( std::size_t tile ){
+                    auto const first_row = tile * rows_per_tile;
+                    auto const row_count = std::min(
+                        rows_per_tile,
+                        height - first_row
+                    );
+                    
+                    if constexpr( std::is_same< T, GLubyte >::value )
+                    {
+                        if( srgb_encoded )
+                        {
+                            box_downsample_rows_srgb(
+                                source,
+                                source_width,
+                                source_height,
+                                destination,
+                                width,
+                                first_row,
+                                row_count,
+                                channels
+                            );
+                            return;
+                        }
+                    }
+                    
+                    box_downsample_rows(
+                        source,
+                        source_width,
+                        source_height,
+                        destination,
+                        width,
+                        first_row,
+                        row_count,
+                        channels
+                    );
+                }
+            );
+            
+            upload_data.mipmaps.push_back( std::move( level ) );
+            
+            source        = destination;
+            source_width  = width;
+            source_height = height;
+        }
+    }
+}
+
+namespace // Half-float conversion /////////////////////////////////////////////
+{
+    void convert_to_half(
+        GLfloat const* in,
+        GLhalf       * out,
+        std::size_t    count
+    )
+    {
+        std::size_t i = 0;
+        
+    #ifdef YAVSG_TEXTURE_UTILITIES_F16C
+        for( ; i + 4 <= count; i += 4 )
+        {
+            _mm_storel_epi64(
+                reinterpret_cast< __m128i* >( out + i ),
+                _mm_cvtps_ph( _mm_loadu_ps( in + i ), _MM_FROUND_TO_NEAREST_INT )
+            );
+        }
+    #endif
+        
+        for( ; i < count; ++i )
+        {
+            out[ i ] = JadeMatrix::yavsg::gl::float_to_half( in[ i ] );
+        }
+    }
+    
+    JadeMatrix::yavsg::gl::texture_data_pointer convert_to_half(
+        JadeMatrix::yavsg::gl::texture_data_pointer const& data,
+        std::size_t                                        sample_count
+    )
+    {
+        auto converted = JadeMatrix::yavsg::gl::make_texture_data(
+            sample_count * sizeof( GLhalf )
+        );
+        
+        auto const in  = reinterpret_cast< GLfloat const* >( data.get() );
+        auto const out = reinterpret_cast< GLhalf* >( converted.get() );
+        
+        auto const tile_count = (
+            ( sample_count + pixels_per_preprocess_tile - 1 )
+            / pixels_per_preprocess_tile
+        );
+        JadeMatrix::yavsg::parallel_for( tile_count, [ & ]( std::size_t tile ){
+            auto const first = tile * pixels_per_preprocess_tile;
+            convert_to_half(
+                in + first,
+                out + first,
+                std::min( pixels_per_preprocess_tile, sample_count - first )
+            );
+        } );
+        
+        return converted;
+    }
+}
+
+namespace // Staging buffer pool ///////////////////////////////////////////////
+{
+    // Texture data comes in a few large sizes (whole images & their mip
+    // levels), & each fresh allocation that large is mapped straight from the
+    // OS, so every page of it faults when first written; buffers are kept here
+    // when freed so the next texture of a similar size can reuse them
+    class staging_buffer_pool
+    {
+    public:
+        // Allocating anything smaller is cheap enough as-is
+        static constexpr std::size_t min_pooled_size = 64 * 1024;
+        
+        // Idle buffers past this are freed, largest first
+        static constexpr std::size_t max_idle_bytes = 128 * 1024 * 1024;
+        
+        JadeMatrix::yavsg::gl::texture_data_pointer allocate( std::size_t size )
+        {
+            if( size < min_pooled_size )
+            {
+                return JadeMatrix::yavsg::gl::texture_data_pointer{
+                    new std::byte[ size ],
+                    []( std::byte* data ){ delete[] data; }
+                };
+            }
+            
+            std::unique_ptr< std::byte[] > buffer;
+            auto capacity = size;
+            {
+                std::unique_lock lock( mutex_ );
+                
+                // Only reuse close fits, so a small texture doesn't hold on to
+                // a much larger buffer
+                auto const found = idle_.lower_bound( size );
+                if( found != idle_.end() && found->first <= size + size / 4 )
+                {
+                    capacity     = found->first;
+                    buffer       = std::move( found->second );
+                    idle_bytes_ -= capacity;
+                    idle_.erase( found );
+                }
+            }
+            if( !buffer )
+            {
+                buffer.reset( new std::byte[ size ] );
+            }
+            
+            return JadeMatrix::yavsg::gl::texture_data_pointer{
+                buffer.release(),
+                [ this, capacity ]( std::byte* data ){
+                    release( data, capacity );
+                }
+            };
+        }
+    
+    private:
+        void release( std::byte* data, std::size_t capacity )
+        {
+            std::unique_ptr< std::byte[] > buffer( data );
+            if( capacity > max_idle_bytes )
+            {
+                return;
+            }
+            
+            std::unique_lock lock( mutex_ );
+            while( idle_bytes_ + capacity > max_idle_bytes )
+            {
+                auto const largest = std::prev( idle_.end() );
+                idle_bytes_ -= largest->first;
+                idle_.erase( largest );
+            }
+            idle_bytes_ += capacity;
+            idle_.emplace( capacity, std::move( buffer ) );
+        }
+        
+        std::mutex mutex_;
+        std::multimap< std::size_t, std::unique_ptr< std::byte[] > > idle_;
+        std::size_t idle_bytes_ = 0;
+    };
+    
+    staging_buffer_pool& staging_buffers()
+    {
+        // Never destroyed, as texture data may outlive other statics
+        static auto const pool = new staging_buffer_pool;
+        return *pool;
+    }
+}
+
 namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
 {
+    texture_data_pointer make_texture_data( std::size_t size )
+    {
+        return staging_buffers().allocate( size );
+    }
+    
     texture_upload_data process_texture_data(
-        texture_upload_data upload_data,
-        texture_flags_type  flags
+        texture_upload_data            upload_data,
+        texture_flags_type             flags,
+        texture_filter_settings const& settings
     )
     {
         if( flags & texture_flag::allocate_only )
@@ -236,8 +963,10 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
         switch( upload_data.gl_internal_format )
         {
         case GL_RGBA:
+        case GL_RGBA8:
         case GL_RGBA8I:
         case GL_RGBA8UI:
+        case GL_RGBA16:
         case GL_RGBA16I:
         case GL_RGBA16UI:
         case GL_RGBA32I:
@@ -245,11 +974,29 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
         case GL_RGBA16F:
         case GL_RGBA32F:
         // case GL_RGBA64F:
+        case GL_SRGB8_ALPHA8:
+        case GL_RGB10_A2:
             internal_has_alpha = true;
             break;
         }
         
-        auto sample_count = upload_data.width * upload_data.height;
+        // OpenGL decodes sRGB formats when sampling, so the data is left
+        // encoded (premultiplying still happens in encoded space, which
+        // matches what linearizing on the CPU would have produced)
+        auto const internal_is_srgb = (
+               upload_data.gl_internal_format == GL_SRGB8
+            || upload_data.gl_internal_format == GL_SRGB8_ALPHA8
+        );
+        if( internal_is_srgb )
+        {
+            flags |= texture_flag::linear_input;
+        }
+        
+        // Alpha that won't be stored shouldn't darken the color channels
+        if( !internal_has_alpha )
+        {
+            flags |= texture_flag::disable_premultiplied_alpha;
+        }
         
         auto const needs_alpha_pass = (
             internal_has_alpha
@@ -268,22 +1015,9 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
             || needs_gamma_pass
         ) )
         {
-            std::size_t channels;
-            std::unique_ptr< std::byte[] > preprocessed_data;
-            
-            switch( upload_data.gl_incoming_format )
-            {
-            case GL_RED : channels = 1; break;
-            case GL_RG  : channels = 2; break;
-            case GL_RGB : channels = 3; break;
-            case GL_RGBA: channels = 4; break;
-            default:
-                throw std::runtime_error( fmt::format(
-                    "uknown/unsupported OpenGL pixel format {} for "
-                        "yavsg::gl::process_texture_data()"sv,
-                    upload_data.gl_incoming_type
-                ) );
-            }
+            auto const channels = incoming_channels(
+                upload_data.gl_incoming_format
+            );
             
             texture_flags_type modified_flags = flags;
             if( upload_data.gl_incoming_format != GL_RGBA )
@@ -308,7 +1042,7 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
                 break;
             case GL_UNSIGNED_BYTE:
                 type_size = sizeof( GLubyte );
-                type_premultiply = premultiply< GLubyte >;
+                type_premultiply = premultiply_lut< GLubyte >;
                 break;
             case GL_SHORT:
                 type_size = sizeof( GLshort );
@@ -316,7 +1050,7 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
                 break;
             case GL_UNSIGNED_SHORT:
                 type_size = sizeof( GLushort );
-                type_premultiply = premultiply< GLushort >;
+                type_premultiply = premultiply_lut< GLushort >;
                 break;
             case GL_INT:
                 type_size = sizeof( GLint );
@@ -346,18 +1080,41 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
                 ) );
             }
             
-            preprocessed_data = std::unique_ptr< std::byte[] >( new std::byte[
-                sample_count * channels * type_size
-            ] );
-            internal_has_alpha = type_premultiply(
-                upload_data.data.get(),
-                preprocessed_data.get(),
-                sample_count,
-                channels,
-                modified_flags
+            auto const rows_per_tile = std::max< std::size_t >(
+                1,
+                pixels_per_preprocess_tile / std::max< std::size_t >(
+                    1,
+                    upload_data.width
+                )
             );
+            auto const tile_count = (
+                ( upload_data.height + rows_per_tile - 1 ) / rows_per_tile
+            );
+            auto const bytes_per_row = upload_data.width * channels * type_size;
             
-            std::swap( upload_data.data, preprocessed_data );
+            // Every preprocess function only ever reads a pixel before writing
+            // it, so this is done in place
+            std::atomic< bool > any_varying_alpha{ false };
+            parallel_for( tile_count, [ & ]( std::size_t tile ){
+                auto const first_row = tile * rows_per_tile;
+                auto const row_count = std::min(
+                    rows_per_tile,
+                    upload_data.height - first_row
+                );
+                auto const offset = first_row * bytes_per_row;
+                
+                if( type_premultiply(
+                    upload_data.data.get() + offset,
+                    upload_data.data.get() + offset,
+                    row_count * upload_data.width,
+                    channels,
+                    modified_flags
+                ) )
+                {
+                    any_varying_alpha.store( true, std::memory_order_relaxed );
+                }
+            } );
+            internal_has_alpha = any_varying_alpha.load();
         }
         
         // Don't bother storing alpha channel in OpenGL memory if it's all 100%
@@ -366,25 +1123,131 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
         {
             switch( upload_data.gl_internal_format )
             {
-            case GL_RGBA    : upload_data.gl_internal_format = GL_RGB    ; break;
-            case GL_RGBA8I  : upload_data.gl_internal_format = GL_RGB8I  ; break;
-            case GL_RGBA8UI : upload_data.gl_internal_format = GL_RGB8UI ; break;
-            case GL_RGBA16I : upload_data.gl_internal_format = GL_RGB16I ; break;
-            case GL_RGBA16UI: upload_data.gl_internal_format = GL_RGB16UI; break;
-            case GL_RGBA32I : upload_data.gl_internal_format = GL_RGB32I ; break;
-            case GL_RGBA32UI: upload_data.gl_internal_format = GL_RGB32UI; break;
-            case GL_RGBA16F : upload_data.gl_internal_format = GL_RGB16F ; break;
-            case GL_RGBA32F : upload_data.gl_internal_format = GL_RGB32F ; break;
+            case GL_RGBA         : upload_data.gl_internal_format = GL_RGB    ; break;
+            case GL_RGBA8        : upload_data.gl_internal_format = GL_RGB8   ; break;
+            case GL_RGBA8I       : upload_data.gl_internal_format = GL_RGB8I  ; break;
+            case GL_RGBA8UI      : upload_data.gl_internal_format = GL_RGB8UI ; break;
+            case GL_RGBA16       : upload_data.gl_internal_format = GL_RGB16  ; break;
+            case GL_RGBA16I      : upload_data.gl_internal_format = GL_RGB16I ; break;
+            case GL_RGBA16UI     : upload_data.gl_internal_format = GL_RGB16UI; break;
+            case GL_RGBA32I      : upload_data.gl_internal_format = GL_RGB32I ; break;
+            case GL_RGBA32UI     : upload_data.gl_internal_format = GL_RGB32UI; break;
+            case GL_RGBA16F      : upload_data.gl_internal_format = GL_RGB16F ; break;
+            case GL_RGBA32F      : upload_data.gl_internal_format = GL_RGB32F ; break;
+            case GL_SRGB8_ALPHA8 : upload_data.gl_internal_format = GL_SRGB8  ; break;
+            // No 10-bit RGB format without alpha is guaranteed to exist, so
+            // GL_RGB10_A2 is kept
+            }
+        }
+        
+        if(
+               upload_data.data
+            && settings.mipmaps != texture_filter_settings::mipmap_type::none
+        )
+        {
+            auto const channels = incoming_channels(
+                upload_data.gl_incoming_format
+            );
+            
+            switch( upload_data.gl_incoming_type )
+            {
+            case GL_BYTE:
+                generate_mipmaps< GLbyte   >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            case GL_UNSIGNED_BYTE:
+                generate_mipmaps< GLubyte  >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            case GL_SHORT:
+                generate_mipmaps< GLshort  >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            case GL_UNSIGNED_SHORT:
+                generate_mipmaps< GLushort >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            case GL_INT:
+                generate_mipmaps< GLint    >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            case GL_UNSIGNED_INT:
+                generate_mipmaps< GLuint   >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            case GL_FLOAT:
+                generate_mipmaps< GLfloat  >(
+                    upload_data,
+                    channels,
+                    internal_is_srgb
+                );
+                break;
+            default:
+                // Leave it to OpenGL
+                break;
+            }
+        }
+        
+        // Half-float formats are uploaded as half floats so OpenGL doesn't
+        // have to convert them on the GPU thread
+        auto const internal_is_half = (
+               upload_data.gl_internal_format == GL_R16F
+            || upload_data.gl_internal_format == GL_RG16F
+            || upload_data.gl_internal_format == GL_RGB16F
+            || upload_data.gl_internal_format == GL_RGBA16F
+        );
+        if(
+               upload_data.data
+            && internal_is_half
+            && upload_data.gl_incoming_type == GL_FLOAT
+        )
+        {
+            auto const channels = incoming_channels(
+                upload_data.gl_incoming_format
+            );
+            auto width  = upload_data.width;
+            auto height = upload_data.height;
+            
+            upload_data.data = convert_to_half(
+                upload_data.data,
+                width * height * channels
+            );
+            for( auto& level : upload_data.mipmaps )
+            {
+                width  = std::max< std::size_t >( 1, width  / 2 );
+                height = std::max< std::size_t >( 1, height / 2 );
+                level = convert_to_half( level, width * height * channels );
             }
+            
+            upload_data.gl_incoming_type = GL_HALF_FLOAT;
         }
         
         return upload_data;
     }
     
     texture_upload_data process_texture_data(
-        SDL_Surface      * sdl_surface,
-        texture_flags_type flags,
-        GLint              gl_internal_format
+        SDL_Surface                  * sdl_surface,
+        texture_flags_type             flags,
+        texture_filter_settings const& settings,
+        GLint                          gl_internal_format
     )
     {
         // Surface is passed as a pointer for consistency with the SDL API, so
@@ -398,9 +1261,9 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
         
         GLenum incoming_format;
         GLenum incoming_type = GL_UNSIGNED_BYTE;
-        SDL_Surface* converted_surface = nullptr;
         
         std::size_t channels;
+        auto target_format = sdl_surface->format->format;
         
         if( sdl_surface->format->format == SDL_PIXELFORMAT_RGBA8888 )
         {
@@ -412,20 +1275,10 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
             incoming_format = GL_BGRA; // Bgr + A
             channels = 4;
         }
-        else if( sdl_surface->format->format == SDL_PIXELFORMAT_RGB888 )
-        {
-            incoming_format = GL_RGB;  // Rgb
-            channels = 3;
-        }
-        else if( sdl_surface->format->format == SDL_PIXELFORMAT_BGR888 )
-        {
-            incoming_format = GL_BGR;  // Bgr
-            channels = 3;
-        }
+        // `SDL_PIXELFORMAT_RGB888` & `SDL_PIXELFORMAT_BGR888` have an unused
+        // fourth byte per pixel, so they're converted to packed RGB below
         else // Convert pixels
         {
-            SDL_PixelFormat* new_format = nullptr;
-            
             bool format_has_alpha = false;
             switch( sdl_surface->format->format )
             {
@@ -450,36 +1303,61 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
             
             if( format_has_alpha )
             {
-                new_format = SDL_AllocFormat( SDL_PIXELFORMAT_RGBA32 );
+                target_format = SDL_PIXELFORMAT_RGBA32;
                 incoming_format = GL_RGBA;
                 channels = 4;
             }
             else
             {
-                new_format = SDL_AllocFormat( SDL_PIXELFORMAT_RGB24 );\
+                target_format = SDL_PIXELFORMAT_RGB24;
                 incoming_format = GL_RGB;
                 channels = 3;
             }
+        }
+        
+        std::size_t width  = static_cast< std::size_t >( sdl_surface->w );
+        std::size_t height = static_cast< std::size_t >( sdl_surface->h );
+        auto const row_size = channels * width;
+        
+        texture_data_pointer data;
+        
+        if(
+               target_format == sdl_surface->format->format
+            && static_cast< std::size_t >( sdl_surface->pitch ) == row_size
+            && !SDL_MUSTLOCK( sdl_surface )
+        )
+        {
+            // The surface's pixels can be used as-is, so take ownership of the
+            // surface along with them rather than copying
+            data = texture_data_pointer{
+                static_cast< std::byte* >( sdl_surface->pixels ),
+                [ sdl_surface ]( std::byte* ){ SDL_FreeSurface( sdl_surface ); }
+            };
+        }
+        else
+        {
+            // Convert straight into the final buffer, which also removes any
+            // row padding; this is the only copy made
+            REQUIRE(
+                static_cast< std::size_t >( SDL_BYTESPERPIXEL( target_format ) )
+                == channels
+            );
+            data = make_texture_data( row_size * height );
             
-            if( !new_format )
-            {
-                throw std::runtime_error( fmt::format(
-                    "couldn't allocate SDL format for "
-                        "yavsg::gl::process_texture_data(): {}"sv,
-                    SDL_GetError()
-                ) );
-            }
-            
-            converted_surface = SDL_ConvertSurface(
-                sdl_surface,
-                new_format,
-                0x00 // Flags (unused)
+            auto const result = SDL_ConvertPixels(
+                sdl_surface->w,
+                sdl_surface->h,
+                sdl_surface->format->format,
+                sdl_surface->pixels,
+                sdl_surface->pitch,
+                target_format,
+                data.get(),
+                static_cast< int >( row_size )
             );
             
-            // Free format before possibly throwing an error
-            SDL_FreeFormat( new_format );
+            SDL_FreeSurface( sdl_surface );
             
-            if( !converted_surface )
+            if( result != 0 )
             {
                 throw std::runtime_error( fmt::format(
                     "couldn't convert SDL surface for "
@@ -487,27 +1365,8 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
                     SDL_GetError()
                 ) );
             }
-            
-            std::swap( sdl_surface, converted_surface );
-            SDL_FreeSurface( converted_surface );
         }
         
-        std::size_t width  = static_cast< std::size_t >( sdl_surface->w );
-        std::size_t height = static_cast< std::size_t >( sdl_surface->h );
-        
-        // Copy data; need to do this because the data may/will be freed
-        // elsewhere and be freed with `delete[]`, but SDL allocates with
-        // `malloc()` since it's written in C
-        auto sample_count = channels * width * height;
-        auto sdl_surface_data = new std::byte[ sample_count ];
-        std::copy_n(
-            static_cast< std::byte* >( sdl_surface->pixels ),
-            sample_count,
-            sdl_surface_data
-        );
-        
-        SDL_FreeSurface( sdl_surface );
-        
         return process_texture_data(
             {
                 gl_internal_format,
@@ -515,10 +1374,74 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
                 height,
                 incoming_format,
                 incoming_type,
-                std::unique_ptr< std::byte[] >{ sdl_surface_data }
+                std::move( data ),
+                {}
             },
-            flags
+            flags,
+            settings
+        );
+    }
+    
+    std::size_t incoming_row_size(
+        texture_upload_data const& upload_data,
+        std::size_t                width
+    )
+    {
+        if( is_block_compressed_format( upload_data.gl_internal_format ) )
+        {
+            return block_compressed_size(
+                upload_data.gl_internal_format,
+                width,
+                4
+            );
+        }
+        
+        std::size_t type_size;
+        switch( upload_data.gl_incoming_type )
+        {
+        case GL_BYTE          : type_size = sizeof( GLbyte   ); break;
+        case GL_UNSIGNED_BYTE : type_size = sizeof( GLubyte  ); break;
+        case GL_SHORT         : type_size = sizeof( GLshort  ); break;
+        case GL_UNSIGNED_SHORT: type_size = sizeof( GLushort ); break;
+        case GL_HALF_FLOAT    : type_size = sizeof( GLhalf   ); break;
+        case GL_INT           : type_size = sizeof( GLint    ); break;
+        case GL_UNSIGNED_INT  : type_size = sizeof( GLuint   ); break;
+        case GL_FLOAT         : type_size = sizeof( GLfloat  ); break;
+        // Packed types hold a whole pixel
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            return width * sizeof( GLuint );
+        default:
+            throw std::runtime_error( fmt::format(
+                "uknown/unsupported OpenGL type {} for "
+                    "yavsg::gl::incoming_row_size()"sv,
+                upload_data.gl_incoming_type
+            ) );
+        }
+        
+        return (
+            width
+            * incoming_channels( upload_data.gl_incoming_format )
+            * type_size
+        );
+    }
+    
+    bool immutable_texture_storage_supported()
+    {
+        std::call_once(
+            texture_storage_flag,
+            [](){
+            #ifdef __APPLE__
+                // macOS stops at OpenGL 4.1 without the extension
+                texture_storage_value = false;
+            #else
+                texture_storage_value = static_cast< bool >(
+                    GLEW_ARB_texture_storage
+                );
+            #endif
+            }
         );
+        
+        return texture_storage_value;
     }
     
     void upload_texture_data(
@@ -534,22 +1457,312 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
         auto data_width  = static_cast< GLsizei >( upload_data.width  );
         auto data_height = static_cast< GLsizei >( upload_data.height );
         
-        gl::TexImage2D(   // Loads starting at 0,0 as bottom left
-            GL_TEXTURE_2D,
-            0,                              // LoD, 0 = base
-            upload_data.gl_internal_format, // Internal format
-            data_width,                     // Width
-            data_height,                    // Height
-            0,                              // Border; must be 0
-            upload_data.gl_incoming_format, // Incoming format
-            upload_data.gl_incoming_type,   // Pixel type
-            upload_data.data.get()          // Pixel data
+        // Rows are tightly packed, which 3-channel & small mip levels rely on
+        gl::PixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        
+        // Block-compressed data (e.g. from a KTX file) always comes with all
+        // the mip levels it's going to have, as OpenGL can't be relied on to
+        // generate them for compressed formats
+        auto const compressed = is_block_compressed_format(
+            upload_data.gl_internal_format
+        );
+        auto const generate_mipmaps = (
+            !compressed
+            && upload_data.mipmaps.empty()
+            && settings.mipmaps != texture_filter_settings::mipmap_type::none
+        );
+        
+        auto const immutable = immutable_texture_storage_supported();
+        if( immutable )
+        {
+            // Levels OpenGL will generate need storage too
+            auto levels = static_cast< GLsizei >(
+                upload_data.mipmaps.size() + 1
+            );
+            if( generate_mipmaps )
+            {
+                for(
+                    auto size = std::max( data_width, data_height );
+                    size > 1;
+                    size /= 2
+                )
+                {
+                    ++levels;
+                }
+            }
+            
+            gl::TexStorage2D(
+                GL_TEXTURE_2D,
+                levels,
+                static_cast< GLenum >( upload_data.gl_internal_format ),
+                data_width,
+                data_height
+            );
+        }
+        
+        auto const upload_level = [ & ]( GLint level, std::byte const* data ){
+            if( immutable && !data )
+            {
+                // Allocate-only; `glTexStorage2D()` already did the work
+                return;
+            }
+            else if( compressed )
+            {
+                auto const size = block_compressed_size(
+                    upload_data.gl_internal_format,
+                    static_cast< std::size_t >( data_width  ),
+                    static_cast< std::size_t >( data_height )
+                );
+                REQUIRE( size <= std::numeric_limits< GLsizei >::max() );
+                
+                if( immutable )
+                {
+                    gl::CompressedTexSubImage2D(
+                        GL_TEXTURE_2D,
+                        level,
+                        0,
+                        0,
+                        data_width,
+                        data_height,
+                        static_cast< GLenum >( upload_data.gl_internal_format ),
+                        static_cast< GLsizei >( size ),
+                        data
+                    );
+                }
+                else
+                {
+                    gl::CompressedTexImage2D(
+                        GL_TEXTURE_2D,
+                        level,
+                        static_cast< GLenum >( upload_data.gl_internal_format ),
+                        data_width,
+                        data_height,
+                        0,
+                        static_cast< GLsizei >( size ),
+                        data
+                    );
+                }
+            }
+            else if( immutable )
+            {
+                gl::TexSubImage2D(
+                    GL_TEXTURE_2D,
+                    level,
+                    0,
+                    0,
+                    data_width,
+                    data_height,
+                    upload_data.gl_incoming_format,
+                    upload_data.gl_incoming_type,
+                    data
+                );
+            }
+            else
+            {
+                gl::TexImage2D(   // Loads starting at 0,0 as bottom left
+                    GL_TEXTURE_2D,
+                    level,                          // LoD, 0 = base
+                    upload_data.gl_internal_format, // Internal format
+                    data_width,                     // Width
+                    data_height,                    // Height
+                    0,                              // Border; must be 0
+                    upload_data.gl_incoming_format, // Incoming format
+                    upload_data.gl_incoming_type,   // Pixel type
+                    data                            // Pixel data
+                );
+            }
+        };
+        
+        upload_level( 0, upload_data.data.get() );
+        
+        for( std::size_t i = 0; i < upload_data.mipmaps.size(); ++i )
+        {
+            data_width  = std::max< GLsizei >( 1, data_width  / 2 );
+            data_height = std::max< GLsizei >( 1, data_height / 2 );
+            
+            upload_level(
+                static_cast< GLint >( i + 1 ),
+                upload_data.mipmaps[ i ].get()
+            );
+        }
+        
+        if( compressed || !upload_data.mipmaps.empty() )
+        {
+            gl::TexParameteri(
+                GL_TEXTURE_2D,
+                GL_TEXTURE_MAX_LEVEL,
+                static_cast< GLint >( upload_data.mipmaps.size() )
+            );
+        }
+        
+        set_bound_texture_filtering(
+            settings,
+            !compressed && upload_data.mipmaps.empty()
+        );
+    }
+    
+    void upload_texture_array_data(
+        GLuint                             gl_id,
+        std::vector< texture_upload_data > layers,
+        texture_filter_settings     const& settings
+    )
+    {
+        using namespace std::string_literals;
+        
+        if( layers.empty() )
+        {
+            throw std::invalid_argument(
+                "yavsg::gl::upload_texture_array_data() needs at least one "
+                "layer"s
+            );
+        }
+        
+        auto const& first = layers.front();
+        for( auto const& layer : layers )
+        {
+            if(
+                   layer.gl_internal_format != first.gl_internal_format
+                || layer.width              != first.width
+                || layer.height             != first.height
+                || layer.gl_incoming_format != first.gl_incoming_format
+                || layer.gl_incoming_type   != first.gl_incoming_type
+                || layer.mipmaps.size()     != first.mipmaps.size()
+                || !layer.data
+            )
+            {
+                throw std::invalid_argument(
+                    "yavsg::gl::upload_texture_array_data() layers must all "
+                    "share the same formats, size, & mip levels"s
+                );
+            }
+        }
+        
+        gl::BindTexture( GL_TEXTURE_2D_ARRAY, gl_id );
+        
+        REQUIRE( first.width   <= std::numeric_limits< GLsizei >::max() );
+        REQUIRE( first.height  <= std::numeric_limits< GLsizei >::max() );
+        REQUIRE( layers.size() <= std::numeric_limits< GLsizei >::max() );
+        auto       data_width  = static_cast< GLsizei >( first.width   );
+        auto       data_height = static_cast< GLsizei >( first.height  );
+        auto const layer_count = static_cast< GLsizei >( layers.size() );
+        
+        gl::PixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        
+        auto const compressed = is_block_compressed_format(
+            first.gl_internal_format
         );
+        auto const level_count = first.mipmaps.size() + 1;
+        
+        // Each level's storage is allocated for all layers at once, then the
+        // layers are copied in one by one so they never need to be gathered
+        // into a single buffer
+        for( std::size_t level = 0; level < level_count; ++level )
+        {
+            auto const gl_level = static_cast< GLint >( level );
+            
+            if( compressed )
+            {
+                auto const size = block_compressed_size(
+                    first.gl_internal_format,
+                    static_cast< std::size_t >( data_width  ),
+                    static_cast< std::size_t >( data_height )
+                );
+                REQUIRE(
+                    size * layers.size()
+                    <= std::numeric_limits< GLsizei >::max()
+                );
+                
+                gl::CompressedTexImage3D(
+                    GL_TEXTURE_2D_ARRAY,
+                    gl_level,
+                    static_cast< GLenum >( first.gl_internal_format ),
+                    data_width,
+                    data_height,
+                    layer_count,
+                    0,
+                    static_cast< GLsizei >( size * layers.size() ),
+                    nullptr
+                );
+                
+                for( std::size_t i = 0; i < layers.size(); ++i )
+                {
+                    gl::CompressedTexSubImage3D(
+                        GL_TEXTURE_2D_ARRAY,
+                        gl_level,
+                        0,
+                        0,
+                        static_cast< GLint >( i ),
+                        data_width,
+                        data_height,
+                        1,
+                        static_cast< GLenum >( first.gl_internal_format ),
+                        static_cast< GLsizei >( size ),
+                        level == 0
+                        ? layers[ i ].data.get()
+                        : layers[ i ].mipmaps[ level - 1 ].get()
+                    );
+                }
+            }
+            else
+            {
+                gl::TexImage3D(
+                    GL_TEXTURE_2D_ARRAY,
+                    gl_level,
+                    first.gl_internal_format,
+                    data_width,
+                    data_height,
+                    layer_count,
+                    0,
+                    first.gl_incoming_format,
+                    first.gl_incoming_type,
+                    nullptr
+                );
+                
+                for( std::size_t i = 0; i < layers.size(); ++i )
+                {
+                    gl::TexSubImage3D(
+                        GL_TEXTURE_2D_ARRAY,
+                        gl_level,
+                        0,
+                        0,
+                        static_cast< GLint >( i ),
+                        data_width,
+                        data_height,
+                        1,
+                        first.gl_incoming_format,
+                        first.gl_incoming_type,
+                        level == 0
+                        ? layers[ i ].data.get()
+                        : layers[ i ].mipmaps[ level - 1 ].get()
+                    );
+                }
+            }
+            
+            data_width  = std::max< GLsizei >( 1, data_width  / 2 );
+            data_height = std::max< GLsizei >( 1, data_height / 2 );
+        }
         
-        set_bound_texture_filtering( settings );
+        if( compressed || level_count > 1 )
+        {
+            gl::TexParameteri(
+                GL_TEXTURE_2D_ARRAY,
+                GL_TEXTURE_MAX_LEVEL,
+                static_cast< GLint >( level_count - 1 )
+            );
+        }
+        
+        set_bound_texture_filtering(
+            settings,
+            !compressed && level_count == 1,
+            GL_TEXTURE_2D_ARRAY
+        );
     }
     
-    void set_bound_texture_filtering( texture_filter_settings const& settings )
+    void set_bound_texture_filtering(
+        texture_filter_settings const& settings,
+        bool                           generate_mipmaps,
+        GLenum                         target
+    )
     {
         using magnify_mode = texture_filter_settings::magnify_mode;
         using  minify_mode = texture_filter_settings::minify_mode;
@@ -564,7 +1777,7 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
         case magnify_mode::linear : mag_filter = GL_LINEAR ; break;
         }
         
-        gl::TexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter );
+        gl::TexParameteri( target, GL_TEXTURE_MAG_FILTER, mag_filter );
         
         switch( settings.minify )
         {
@@ -602,11 +1815,14 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
             break;
         }
         
-        gl::TexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter );
+        gl::TexParameteri( target, GL_TEXTURE_MIN_FILTER, min_filter );
         
         if( settings.mipmaps != mipmap_type::none )
         {
-            gl::GenerateMipmap( GL_TEXTURE_2D );
+            if( generate_mipmaps )
+            {
+                gl::GenerateMipmap( target );
+            }
             
             if( anisotropic_filtering_supported() )
             {
@@ -616,7 +1832,7 @@ namespace JadeMatrix::yavsg::gl // Texture data processing implementation //////
                     &max_anisotropic_level
                 );
                 gl::TexParameterf(
-                    GL_TEXTURE_2D,
+                    target,
                     GL_TEXTURE_MAX_ANISOTROPY_EXT,
                     max_anisotropic_level
                 );
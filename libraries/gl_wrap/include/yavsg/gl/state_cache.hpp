@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <cstdint>  // uint64_t
+
+
+// Shadow copy of the most frequently-changed OpenGL bindings (program, VAO,
+// buffers, texture units, & framebuffers) so that the generated wrappers in
+// `gl_wrap.hpp` can skip calls that wouldn't change anything.  OpenGL contexts
+// are only ever current on one thread, so the cache is kept per-thread.
+//
+// The cache only sees calls made through the wrappers; anything else that
+// changes bindings (e.g. another library sharing the context) must be followed
+// by a call to `invalidate_state_cache()`.
+
+
+namespace JadeMatrix::yavsg::gl
+{
+    struct state_cache_counters
+    {
+        std::uint64_t issued = 0;
+        std::uint64_t elided = 0;
+    };
+    
+    // Enabled by default; disabling also invalidates the cache
+    void use_state_cache( bool );
+    
+    // Forget all shadowed state for the calling thread's context
+    void invalidate_state_cache();
+    
+    // Counts of cacheable calls made on the calling thread
+    state_cache_counters state_cache_counts();
+    void reset_state_cache_counts();
+}
+
+
+namespace JadeMatrix::yavsg::gl::state_cache_hooks
+{
+    // Called by the generated wrappers before issuing the OpenGL call; these
+    // update the shadowed state and return false if the call can be skipped
+    bool ActiveTexture  ( ::GLenum texture                     );
+    bool BindBuffer     ( ::GLenum target, ::GLuint buffer      );
+    bool BindFramebuffer( ::GLenum target, ::GLuint framebuffer );
+    bool BindTexture    ( ::GLenum target, ::GLuint texture     );
+    bool BindVertexArray( ::GLuint array                        );
+    bool UseProgram     ( ::GLuint program                      );
+    
+    // Called by the generated wrappers after issuing calls that change
+    // bindings as a side effect
+    void BindBufferRange(
+        ::GLenum     target,
+        ::GLuint     index,
+        ::GLuint     buffer,
+        ::GLintptr   offset,
+        ::GLsizeiptr size
+    );
+    
+    // Called by the generated wrappers after deleting objects so stale IDs
+    // aren't matched if OpenGL hands them out again
+    void DeleteBuffers     ( ::GLsizei n, ::GLuint const* buffers      );
+    void DeleteFramebuffers( ::GLsizei n, ::GLuint const* framebuffers );
+    void DeleteProgram     ( ::GLuint program                          );
+    void DeleteTextures    ( ::GLsizei n, ::GLuint const* textures     );
+    void DeleteVertexArrays( ::GLsizei n, ::GLuint const* arrays       );
+}
@@ -0,0 +1,333 @@
+#include <yavsg/gl/state_cache.hpp>
+
+#include <array>
+#include <cstddef>  // size_t
+#include <optional>
+
+
+namespace
+{
+    // OpenGL never hands out this ID, so use it to mark unknown bindings
+    constexpr GLuint unknown = ~GLuint{ 0 };
+    
+    // Texture units beyond this are passed straight through
+    constexpr std::size_t tracked_texture_units = 32;
+    
+    enum buffer_slot : std::size_t
+    {
+        array_buffer_slot,
+        element_array_buffer_slot,
+        uniform_buffer_slot,
+        pixel_pack_buffer_slot,
+        pixel_unpack_buffer_slot,
+        copy_read_buffer_slot,
+        copy_write_buffer_slot,
+        buffer_slot_count
+    };
+    
+    enum texture_slot : std::size_t
+    {
+        texture_2d_slot,
+        texture_2d_array_slot,
+        texture_slot_count
+    };
+    
+    std::optional< std::size_t > buffer_slot_for( GLenum target )
+    {
+        switch( target )
+        {
+        case GL_ARRAY_BUFFER        : return        array_buffer_slot;
+        case GL_ELEMENT_ARRAY_BUFFER: return element_array_buffer_slot;
+        case GL_UNIFORM_BUFFER      : return      uniform_buffer_slot;
+        case GL_PIXEL_PACK_BUFFER   : return   pixel_pack_buffer_slot;
+        case GL_PIXEL_UNPACK_BUFFER : return pixel_unpack_buffer_slot;
+        case GL_COPY_READ_BUFFER    : return    copy_read_buffer_slot;
+        case GL_COPY_WRITE_BUFFER   : return   copy_write_buffer_slot;
+        default                     : return std::nullopt;
+        }
+    }
+    
+    std::optional< std::size_t > texture_slot_for( GLenum target )
+    {
+        switch( target )
+        {
+        case GL_TEXTURE_2D      : return       texture_2d_slot;
+        case GL_TEXTURE_2D_ARRAY: return texture_2d_array_slot;
+        default                 : return std::nullopt;
+        }
+    }
+    
+    struct cached_state
+    {
+        GLuint program;
+        GLuint vertex_array;
+        GLuint draw_framebuffer;
+        GLuint read_framebuffer;
+        GLenum active_texture;
+        
+        std::array< GLuint, buffer_slot_count > buffers;
+        std::array<
+            std::array< GLuint, texture_slot_count >,
+            tracked_texture_units
+        > textures;
+        
+        JadeMatrix::yavsg::gl::state_cache_counters counters;
+        
+        cached_state()
+        {
+            invalidate();
+        }
+        
+        void invalidate()
+        {
+            program          = unknown;
+            vertex_array     = unknown;
+            draw_framebuffer = unknown;
+            read_framebuffer = unknown;
+            active_texture   = unknown;
+            buffers.fill( unknown );
+            for( auto& unit : textures )
+            {
+                unit.fill( unknown );
+            }
+        }
+        
+        // Records a binding & returns whether the call needs to be issued
+        bool update( GLuint& cached, GLuint value )
+        {
+            if( cached == value )
+            {
+                ++counters.elided;
+                return false;
+            }
+            cached = value;
+            ++counters.issued;
+            return true;
+        }
+        
+        bool pass_through()
+        {
+            ++counters.issued;
+            return true;
+        }
+        
+        void forget( GLuint& cached, GLuint deleted )
+        {
+            if( cached == deleted )
+            {
+                cached = unknown;
+            }
+        }
+    };
+    
+    thread_local cached_state state;
+    
+    auto state_cache_enabled = true;
+}
+
+
+void JadeMatrix::yavsg::gl::use_state_cache( bool enabled )
+{
+    ::state_cache_enabled = enabled;
+    state.invalidate();
+}
+
+void JadeMatrix::yavsg::gl::invalidate_state_cache()
+{
+    state.invalidate();
+}
+
+JadeMatrix::yavsg::gl::state_cache_counters
+JadeMatrix::yavsg::gl::state_cache_counts()
+{
+    return state.counters;
+}
+
+void JadeMatrix::yavsg::gl::reset_state_cache_counts()
+{
+    state.counters = {};
+}
+
+
+bool JadeMatrix::yavsg::gl::state_cache_hooks::ActiveTexture( ::GLenum texture )
+{
+    if( !::state_cache_enabled )
+    {
+        return state.pass_through();
+    }
+    return state.update( state.active_texture, texture );
+}
+
+bool JadeMatrix::yavsg::gl::state_cache_hooks::BindBuffer(
+    ::GLenum target,
+    ::GLuint buffer
+)
+{
+    auto const slot = buffer_slot_for( target );
+    if( !::state_cache_enabled || !slot )
+    {
+        return state.pass_through();
+    }
+    return state.update( state.buffers[ *slot ], buffer );
+}
+
+bool JadeMatrix::yavsg::gl::state_cache_hooks::BindFramebuffer(
+    ::GLenum target,
+    ::GLuint framebuffer
+)
+{
+    if( !::state_cache_enabled )
+    {
+        return state.pass_through();
+    }
+    
+    switch( target )
+    {
+    case GL_DRAW_FRAMEBUFFER:
+        return state.update( state.draw_framebuffer, framebuffer );
+    case GL_READ_FRAMEBUFFER:
+        return state.update( state.read_framebuffer, framebuffer );
+    case GL_FRAMEBUFFER:
+        if(
+               state.draw_framebuffer == framebuffer
+            && state.read_framebuffer == framebuffer
+        )
+        {
+            ++state.counters.elided;
+            return false;
+        }
+        state.draw_framebuffer = framebuffer;
+        state.read_framebuffer = framebuffer;
+        return state.pass_through();
+    default:
+        return state.pass_through();
+    }
+}
+
+bool JadeMatrix::yavsg::gl::state_cache_hooks::BindTexture(
+    ::GLenum target,
+    ::GLuint texture
+)
+{
+    auto const slot = texture_slot_for( target );
+    if(
+           !::state_cache_enabled
+        || !slot
+        || state.active_texture == unknown
+        || state.active_texture - GL_TEXTURE0 >= tracked_texture_units
+    )
+    {
+        return state.pass_through();
+    }
+    return state.update(
+        state.textures[ state.active_texture - GL_TEXTURE0 ][ *slot ],
+        texture
+    );
+}
+
+bool JadeMatrix::yavsg::gl::state_cache_hooks::BindVertexArray(
+    ::GLuint array
+)
+{
+    if( !::state_cache_enabled )
+    {
+        return state.pass_through();
+    }
+    if( state.update( state.vertex_array, array ) )
+    {
+        // The element array buffer binding is part of VAO state
+        state.buffers[ element_array_buffer_slot ] = unknown;
+        return true;
+    }
+    return false;
+}
+
+bool JadeMatrix::yavsg::gl::state_cache_hooks::UseProgram( ::GLuint program )
+{
+    if( !::state_cache_enabled )
+    {
+        return state.pass_through();
+    }
+    return state.update( state.program, program );
+}
+
+
+void JadeMatrix::yavsg::gl::state_cache_hooks::BindBufferRange(
+    ::GLenum     target,
+    ::GLuint     /* index  */,
+    ::GLuint     buffer,
+    ::GLintptr   /* offset */,
+    ::GLsizeiptr /* size   */
+)
+{
+    // Binding an indexed range also binds the buffer to the generic target
+    if( auto const slot = buffer_slot_for( target ); slot )
+    {
+        state.buffers[ *slot ] = buffer;
+    }
+}
+
+void JadeMatrix::yavsg::gl::state_cache_hooks::DeleteBuffers(
+    ::GLsizei       n,
+    ::GLuint const* buffers
+)
+{
+    for( ::GLsizei i = 0; i < n; ++i )
+    {
+        for( auto& binding : state.buffers )
+        {
+            state.forget( binding, buffers[ i ] );
+        }
+    }
+}
+
+void JadeMatrix::yavsg::gl::state_cache_hooks::DeleteFramebuffers(
+    ::GLsizei       n,
+    ::GLuint const* framebuffers
+)
+{
+    for( ::GLsizei i = 0; i < n; ++i )
+    {
+        state.forget( state.draw_framebuffer, framebuffers[ i ] );
+        state.forget( state.read_framebuffer, framebuffers[ i ] );
+    }
+}
+
+void JadeMatrix::yavsg::gl::state_cache_hooks::DeleteProgram(
+    ::GLuint program
+)
+{
+    state.forget( state.program, program );
+}
+
+void JadeMatrix::yavsg::gl::state_cache_hooks::DeleteTextures(
+    ::GLsizei       n,
+    ::GLuint const* textures
+)
+{
+    for( ::GLsizei i = 0; i < n; ++i )
+    {
+        for( auto& unit : state.textures )
+        {
+            for( auto& binding : unit )
+            {
+                state.forget( binding, textures[ i ] );
+            }
+        }
+    }
+}
+
+void JadeMatrix::yavsg::gl::state_cache_hooks::DeleteVertexArrays(
+    ::GLsizei       n,
+    ::GLuint const* arrays
+)
+{
+    for( ::GLsizei i = 0; i < n; ++i )
+    {
+        if( state.vertex_array == arrays[ i ] )
+        {
+            state.vertex_array = unknown;
+            state.buffers[ element_array_buffer_slot ] = unknown;
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "frame_uniforms.hpp"
 #include "render_step.hpp"
 
 #include <yavsg/gl/attribute_buffer.hpp>
@@ -10,6 +11,7 @@
 #include <yavsg/math/vector.hpp>
 
 #include <filesystem>
+#include <memory>     // shared_ptr
 
 
 namespace JadeMatrix::yavsg
@@ -40,5 +42,8 @@ namespace JadeMatrix::yavsg
             source_type          const& source,
             gl::write_only_framebuffer& target
         ) override;
+        
+    protected:
+        std::shared_ptr< frame_uniforms > uniforms;
     };
 }
@@ -2,6 +2,7 @@
 
 
 #include "camera.hpp"
+#include "frame_uniforms.hpp"
 #include "render_step.hpp"
 
 #include <yavsg/gl/attribute_buffer.hpp>
@@ -10,6 +11,8 @@
 #include <yavsg/gl/texture.hpp>
 #include <yavsg/math/vector.hpp>
 
+#include <memory>   // shared_ptr
+
 
 namespace JadeMatrix::yavsg
 {
@@ -39,5 +42,8 @@ namespace JadeMatrix::yavsg
             source_type          const& source,
             gl::write_only_framebuffer& target
         ) override;
+        
+    protected:
+        std::shared_ptr< frame_uniforms > uniforms;
     };
 }
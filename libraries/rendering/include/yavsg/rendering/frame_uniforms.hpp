@@ -0,0 +1,111 @@
+#pragma once
+
+
+#include "camera.hpp"
+#include "shader_variable_names.hpp"
+
+#include <yavsg/gl_wrap.hpp>
+#include <yavsg/gl/uniform_buffer.hpp>
+#include <yavsg/math/matrix.hpp>
+
+#include <cstddef>  // size_t
+#include <memory>   // shared_ptr
+
+
+namespace JadeMatrix::yavsg
+{
+    // Standard uniform blocks shared by all programs
+#if 0
+    layout( std140 ) uniform CAMERA
+    {
+        mat4  view;
+        mat4  projection;
+        float near;
+        float focal;
+        float far;
+    } camera;
+    
+    layout( std140 ) uniform FRAMEBUFFER_TARGET
+    {
+        float width;
+        float height;
+    } framebuffer_target;
+    
+    // Layout depends on the material type, see material.hpp
+    layout( std140 ) uniform MATERIAL
+    {
+        ...
+    } material;
+#endif
+    
+    enum uniform_block_binding : GLuint
+    {
+        camera_block_binding,
+        framebuffer_target_block_binding,
+        material_block_binding
+    };
+    
+    struct camera_uniform_block
+    {
+        square_matrix< GLfloat, 4 > view;
+        square_matrix< GLfloat, 4 > projection;
+        GLfloat near;
+        GLfloat focal;
+        GLfloat far;
+        GLfloat padding_;
+    };
+    static_assert( sizeof( camera_uniform_block ) == 144 );
+    
+    struct framebuffer_target_uniform_block
+    {
+        GLfloat width;
+        GLfloat height;
+        GLfloat padding_[ 2 ];
+    };
+    static_assert( sizeof( framebuffer_target_uniform_block ) == 16 );
+    
+    // Per-frame uniform data, uploaded once into uniform buffers bound to the
+    // fixed binding points above rather than set on every program that uses
+    // it.  All render steps share the same instance, which lives as long as
+    // any of them holds a reference; only use this on the GPU thread.
+    class frame_uniforms
+    {
+    public:
+        frame_uniforms();
+        
+        static std::shared_ptr< frame_uniforms > shared();
+        
+        // These skip the upload if nothing has changed since the last call,
+        // so steps can call them unconditionally
+        void update_camera( camera const&, GLfloat aspect_ratio );
+        void update_framebuffer_target( std::size_t width, std::size_t height );
+        
+        // Attaches whichever standard blocks the program uses to their binding
+        // points; only needs to be done once per program
+        template< class Program > static void bind_blocks( Program& );
+        
+    protected:
+        gl::uniform_buffer< camera_uniform_block > camera_buffer_;
+        gl::uniform_buffer<
+            framebuffer_target_uniform_block
+        > framebuffer_target_buffer_;
+    };
+}
+
+
+template< class Program >
+void JadeMatrix::yavsg::frame_uniforms::bind_blocks( Program& program )
+{
+    program.bind_uniform_block(
+        shader_string_id::camera_block,
+        camera_block_binding
+    );
+    program.bind_uniform_block(
+        shader_string_id::framebuffer_target_block,
+        framebuffer_target_block_binding
+    );
+    program.bind_uniform_block(
+        shader_string_id::material_block,
+        material_block_binding
+    );
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+
+#include <cstddef>      // size_t, byte
+#include <filesystem>
+#include <vector>
+
+
+namespace JadeMatrix::yavsg
+{
+    // Read-only view of a whole file, mapped into memory where the platform
+    // supports it & read into memory otherwise
+    class mapped_file
+    {
+    public:
+        // Throws `std::runtime_error` if the file can't be opened or mapped
+        mapped_file( std::filesystem::path const& filename );
+        mapped_file( mapped_file&& );
+        ~mapped_file();
+        
+        mapped_file( mapped_file const& ) = delete;
+        mapped_file& operator=( mapped_file const& ) = delete;
+        mapped_file& operator=( mapped_file&& );
+        
+        std::byte const* data() const;
+        std::size_t      size() const;
+        
+    protected:
+        std::byte const*         data_ = nullptr;
+        std::size_t              size_ = 0;
+        std::vector< std::byte > fallback_;
+    };
+}
@@ -1,27 +1,148 @@
 #pragma once
 
 
+#include "frame_uniforms.hpp"  // material_block_binding
+#include "render_command_buffer.hpp"
 #include "shader_variable_names.hpp"
+#include "texture_array_packer.hpp"
 #include "texture_reference.hpp"
+#include "texture_residency.hpp"
 
 #include <yavsg/gl/shader_program.hpp>
+#include <yavsg/gl/std140.hpp>
 #include <yavsg/gl/texture.hpp>
+#include <yavsg/gl/texture_array.hpp>
+#include <yavsg/gl/uniform_buffer.hpp>
 
-#include <cstddef>  // size_t
+#include <array>
+#include <cstddef>      // size_t, byte
+#include <memory>       // unique_ptr, make_unique
 #include <string>
 #include <tuple>
+#include <type_traits>  // false_type, true_type
+#include <utility>      // move, forward
 
 
 // When setting up materials for a render pass, it's (purposefully) not possible
 // to loop over active-texture IDs with texture::bind_as<>(), as this function
 // checks active-texture ID bounds at compile-time.  This material descriptor
-// metaclass provides a bind() method that takes an array (or similar container)
-// of names to use for binding material variables, chosing IDs at compile time
-// as they aren't meaningful in themselves anyways.
+// metaclass provides a bind() method that binds material textures, chosing IDs
+// at compile time as they aren't meaningful in themselves anyways.
+//
+// Any non-texture values are packed into a `std140` uniform block laid out in
+// tuple order, which is uploaded only when the values change & bound to
+// `material_block_binding` along with the textures.  Sampler uniforms never
+// change for a given program, so they're set separately & only once through
+// bind_samplers().
+//
+// Texture array layers (see texture_array_packer.hpp) are both: the array is
+// bound like any other texture, & the layer index is packed into the block as
+// an `int` so the shader knows which layer to sample.
+
+
+namespace JadeMatrix::yavsg // Material uniform block layout ///////////////////
+{
+    template< typename T > struct is_material_texture : std::false_type {};
+    template< typename DataType, std::size_t Channels >
+    struct is_material_texture< texture_reference< DataType, Channels > >
+        : std::true_type {};
+    template< typename DataType, std::size_t Channels >
+    struct is_material_texture< texture_layer_reference< DataType, Channels > >
+        : std::true_type {};
+        
+    template< typename T > struct is_material_texture_layer : std::false_type
+    {};
+    template< typename DataType, std::size_t Channels >
+    struct is_material_texture_layer<
+        texture_layer_reference< DataType, Channels >
+    > : std::true_type {};
+    
+    template< typename T > constexpr std::size_t material_value_alignment()
+    {
+        if constexpr( is_material_texture_layer< T >::value )
+        {
+            return gl::std140_traits< GLint >::alignment;
+        }
+        else if constexpr( is_material_texture< T >::value )
+        {
+            return 1;
+        }
+        else
+        {
+            return gl::std140_traits< T >::alignment;
+        }
+    }
+    
+    template< typename T > constexpr std::size_t material_value_size()
+    {
+        if constexpr( is_material_texture_layer< T >::value )
+        {
+            return gl::std140_traits< GLint >::size;
+        }
+        else if constexpr( is_material_texture< T >::value )
+        {
+            return 0;
+        }
+        else
+        {
+            return gl::std140_traits< T >::size;
+        }
+    }
+    
+    template< std::size_t Count > struct material_block_layout_data
+    {
+        // Textures aren't stored in the block & get an offset of 0, but texture
+        // array layers store their layer index
+        std::array< std::size_t, Count > offsets;
+        std::size_t size;
+    };
+    
+    template< typename... Values >
+    constexpr material_block_layout_data< sizeof...( Values ) >
+    compute_material_block_layout()
+    {
+        material_block_layout_data< sizeof...( Values ) > layout{ {}, 0 };
+        std::size_t index = 0;
+        
+        auto const add_value = [ & ]( auto alignment, auto size ){
+            if( size > 0 )
+            {
+                auto const offset = (
+                    ( layout.size + alignment - 1 ) / alignment * alignment
+                );
+                layout.offsets[ index ] = offset;
+                layout.size = offset + size;
+            }
+            ++index;
+        };
+        ( add_value(
+            material_value_alignment< Values >(),
+            material_value_size< Values >()
+        ), ... );
+        
+        // Round up to a whole vec4 so consecutive blocks stay aligned
+        layout.size = ( layout.size + 15 ) / 16 * 16;
+        return layout;
+    }
+    
+    template< typename TupleType > struct material_block_layout;
+    
+    template< typename... Values >
+    struct material_block_layout< std::tuple< Values... > >
+    {
+        static constexpr auto layout = compute_material_block_layout<
+            Values...
+        >();
+        static constexpr auto offsets = layout.offsets;
+        static constexpr auto size    = layout.size;
+    };
+}
 
 
 namespace JadeMatrix::yavsg // Binding attributes //////////////////////////////
 {
+    // Non-texture values live in the material's uniform block, so there's
+    // nothing to do for them when binding
     template<
         typename T,
         typename AttributeBuffer,
@@ -30,71 +151,138 @@ namespace JadeMatrix::yavsg // Binding attributes //////////////////////////////
     {
         static constexpr std::size_t increment_active_texture = 0;
         
+        template< std::size_t ActiveTexture, typename Name >
+        static void bind_sampler(
+            gl::shader_program< AttributeBuffer, Framebuffer >&,
+            Name const&
+        ) {}
+        
         template< std::size_t ActiveTexture > static void bind_one(
+            T const&
+        ) {}
+        
+        template< std::size_t ActiveTexture > static void record_one(
+            render_command_buffer&,
+            T              const&
+        ) {}
+    };
+    
+    template<
+        typename AttributeBuffer,
+        typename Framebuffer,
+        typename DataType,
+        std::size_t Channels
+    > struct bind_attributes<
+        texture_reference< DataType, Channels >,
+        AttributeBuffer,
+        Framebuffer
+    >
+    {
+        static constexpr std::size_t increment_active_texture = 1;
+        
+        using tex_ref_type = texture_reference< DataType, Channels >;
+        
+        // Works with either names or string IDs
+        template< std::size_t ActiveTexture, typename Name >
+        static void bind_sampler(
             gl::shader_program< AttributeBuffer, Framebuffer >& program,
-            std::string const& name,
-            T           const& value
+            Name const& name
         )
         {
-            program.template set_uniform< T >( name, value );
+            program.template set_uniform< GLint >( name, ActiveTexture );
         }
         
         template< std::size_t ActiveTexture > static void bind_one(
-            gl::shader_program< AttributeBuffer, Framebuffer >& program,
-            shader_string_id name_id,
-            T         const& value
+            tex_ref_type const& reference_to_bind
         )
         {
-            bind_one< ActiveTexture >(
-                program,
-                shader_string( name_id ),
-                value
+            if( reference_to_bind )
+            {
+                reference_to_bind->template bind_as< ActiveTexture >();
+                texture_residency::instance().touch(
+                    reference_to_bind->gl_texture_id()
+                );
+            }
+            else
+            {
+                gl::unbind_texture< ActiveTexture >();
+            }
+        }
+        
+        template< std::size_t ActiveTexture > static void record_one(
+            render_command_buffer& commands,
+            tex_ref_type    const& reference_to_bind
+        )
+        {
+            commands.bind_texture(
+                ActiveTexture,
+                GL_TEXTURE_2D,
+                reference_to_bind ? reference_to_bind->gl_texture_id() : 0
             );
         }
     };
-    
+}
+
+
+namespace JadeMatrix::yavsg // Binding texture array layers ////////////////////
+{
     template<
         typename AttributeBuffer,
         typename Framebuffer,
         typename DataType,
         std::size_t Channels
     > struct bind_attributes<
-        texture_reference< DataType, Channels >,
+        texture_layer_reference< DataType, Channels >,
         AttributeBuffer,
         Framebuffer
     >
     {
         static constexpr std::size_t increment_active_texture = 1;
         
-        using tex_ref_type = texture_reference< DataType, Channels >;
+        using layer_ref_type = texture_layer_reference< DataType, Channels >;
         
-        template< std::size_t ActiveTexture > static void bind_one(
+        // Works with either names or string IDs
+        template< std::size_t ActiveTexture, typename Name >
+        static void bind_sampler(
             gl::shader_program< AttributeBuffer, Framebuffer >& program,
-            std::string  const& name,
-            tex_ref_type const& reference_to_bind
+            Name const& name
+        )
+        {
+            program.template set_uniform< GLint >( name, ActiveTexture );
+        }
+        
+        template< std::size_t ActiveTexture > static void bind_one(
+            layer_ref_type const& reference_to_bind
         )
         {
             if( reference_to_bind )
             {
-                reference_to_bind->template bind_as< ActiveTexture >();
-                program. template set_uniform< GLint >( name, ActiveTexture );
+                reference_to_bind.array().template bind_as< ActiveTexture >();
+                texture_residency::instance().touch(
+                    reference_to_bind.array().gl_texture_id()
+                );
             }
             else
             {
-                gl::unbind_texture< ActiveTexture >();
+                gl::unbind_texture_array< ActiveTexture >();
             }
         }
         
-        template< std::size_t ActiveTexture > static void bind_one(
-            gl::shader_program< AttributeBuffer, Framebuffer >& program,
-            shader_string_id    name_id,
-            tex_ref_type const& reference_to_bind
+        // Materials sharing an array record the same bind, which the state
+        // cache then drops when replaying
+        template< std::size_t ActiveTexture > static void record_one(
+            render_command_buffer& commands,
+            layer_ref_type  const& reference_to_bind
         )
         {
-            bind_one< ActiveTexture >(
-                program,
-                shader_string( name_id ),
-                reference_to_bind
+            commands.bind_texture(
+                ActiveTexture,
+                GL_TEXTURE_2D_ARRAY,
+                (
+                    reference_to_bind
+                    ? reference_to_bind.array().gl_texture_id()
+                    : 0
+                )
             );
         }
     };
@@ -111,39 +299,58 @@ namespace JadeMatrix::yavsg // Specializable bind delegation ///////////////////
         typename    Framebuffer
     > struct bind_material_values
     {
-        template< typename IndexableNames > static void bind(
+        using value_type = typename std::tuple_element<
+            TupleIndex - 1,
+            TupleType
+        >::type;
+        using bind_attributes_type = bind_attributes<
+            value_type,
+            AttributeBuffer,
+            Framebuffer
+        >;
+        using next_type = bind_material_values<
+            (
+                FirstActiveTexture
+                + bind_attributes_type::increment_active_texture
+            ),
+            TupleIndex - 1,
+            TupleType,
+            AttributeBuffer,
+            Framebuffer
+        >;
+        
+        template< typename IndexableNames > static void bind_samplers(
             gl::shader_program< AttributeBuffer, Framebuffer >& program,
-            IndexableNames const& names,
-            TupleType      const& values
+            IndexableNames const& names
         )
         {
-            using value_type = typename std::tuple_element<
-                TupleIndex - 1,
-                TupleType
-            >::type;
-            using bind_attributes_type = bind_attributes<
-                value_type,
-                AttributeBuffer,
-                Framebuffer
-            >;
-            
-            bind_attributes_type::template bind_one< FirstActiveTexture >(
+            bind_attributes_type::template bind_sampler< FirstActiveTexture >(
                 program,
-                std::get< TupleIndex - 1 >( names  ),
+                std::get< TupleIndex - 1 >( names )
+            );
+            next_type::bind_samplers( program, names );
+        }
+        
+        static void bind( TupleType const& values )
+        {
+            bind_attributes_type::template bind_one< FirstActiveTexture >(
                 std::get< TupleIndex - 1 >( values )
             );
-            
-            bind_material_values<
-                (
-                    FirstActiveTexture
-                    + bind_attributes_type::increment_active_texture
-                ),
-                TupleIndex - 1,
-                TupleType,
-                AttributeBuffer,
-                Framebuffer
-            >::bind( program, names, values );
+            next_type::bind( values );
+        }
+        
+        static void record(
+            render_command_buffer& commands,
+            TupleType       const& values
+        )
+        {
+            bind_attributes_type::template record_one< FirstActiveTexture >(
+                commands,
+                std::get< TupleIndex - 1 >( values )
+            );
+            next_type::record( commands, values );
         }
+    
     };
     
     template<
@@ -159,11 +366,67 @@ namespace JadeMatrix::yavsg // Specializable bind delegation ///////////////////
         Framebuffer
     >
     {
-        template< typename IndexableNames > static void bind(
+        template< typename IndexableNames > static void bind_samplers(
             gl::shader_program< AttributeBuffer, Framebuffer >&,
-            IndexableNames const&,
-            TupleType      const&
+            IndexableNames const&
         ) {}
+        
+        static void bind( TupleType const& ) {}
+        
+        static void record( render_command_buffer&, TupleType const& ) {}
+    };
+    
+    // Writes the non-texture values & texture array layer indices into a block
+    // laid out according to `material_block_layout< TupleType >`; returns
+    // false if any layers are still being uploaded, as their indices aren't
+    // known yet
+    template<
+        std::size_t TupleIndex,
+        typename    TupleType
+    > struct pack_material_values
+    {
+        static bool pack( std::byte* block, TupleType const& values )
+        {
+            using value_type = typename std::tuple_element<
+                TupleIndex - 1,
+                TupleType
+            >::type;
+            
+            auto const destination = (
+                block
+                + material_block_layout< TupleType >::offsets[ TupleIndex - 1 ]
+            );
+            auto complete = true;
+            
+            if constexpr( is_material_texture_layer< value_type >::value )
+            {
+                auto const& reference = std::get< TupleIndex - 1 >( values );
+                gl::std140_traits< GLint >::write(
+                    destination,
+                    reference.layer()
+                );
+                complete = !reference.pending();
+            }
+            else if constexpr( !is_material_texture< value_type >::value )
+            {
+                gl::std140_traits< value_type >::write(
+                    destination,
+                    std::get< TupleIndex - 1 >( values )
+                );
+            }
+            
+            auto const rest_complete = pack_material_values<
+                TupleIndex - 1,
+                TupleType
+            >::pack( block, values );
+            return complete && rest_complete;
+        }
+    };
+    
+    template< typename TupleType >
+    struct pack_material_values< 0, TupleType >
+    {
+        static bool pack( std::byte*, TupleType const& ) { return true; }
     };
 }
 
@@ -174,22 +437,66 @@ namespace JadeMatrix::yavsg // Material descriptor /////////////////////////////
     {
     public:
         using tuple_type = std::tuple< Attributes... >;
+        using block_layout_type = material_block_layout< tuple_type >;
+        
+        static constexpr bool has_block = block_layout_type::size > 0;
         
         // TODO: enable move construction of values
         material( Attributes... args ) : values{ args... } {}
-        material( material&& o ) : values( std::move( o.values ) ) {}
+        material( material&& o ) :
+            values( std::move( o.values ) ),
+            block_( std::move( o.block_ ) ),
+            block_dirty_( o.block_dirty_ )
+        {}
         
         virtual ~material() {}
         
-        // TODO: "starting at ID" parameter so more than one material can be
-        // bound at once
+        template< std::size_t N > auto const& get() const
+        {
+            return std::get< N >( values );
+        }
+        
+        // Use this rather than changing values directly so the uniform block
+        // is re-uploaded
+        template< std::size_t N, typename T > void set( T&& value )
+        {
+            std::get< N >( values ) = std::forward< T >( value );
+            block_dirty_ = true;
+        }
+        
+        // Sets each texture's sampler uniform to the texture unit it's bound
+        // to; these don't depend on the material's values, so only need to be
+        // set once per program
         template<
             class AttributeBuffer,
             class Framebuffer,
             class IndexableNames
-        > void bind(
+        > static void bind_samplers(
             gl::shader_program< AttributeBuffer, Framebuffer >& program,
             IndexableNames const& names
+        )
+        {
+            bind_material_values<
+                0,
+                sizeof...( Attributes ),
+                tuple_type,
+                AttributeBuffer,
+                Framebuffer
+            >::bind_samplers( program, names );
+        }
+        
+        // (Re-)uploads the uniform block if any values have changed since the
+        // last upload, or if any texture array layers were still pending last
+        // time; must be called on the GPU thread
+        void upload_block() const;
+        
+        // TODO: "starting at ID" parameter so more than one material can be
+        // bound at once
+        template<
+            class AttributeBuffer,
+            class Framebuffer
+        > void bind(
+            gl::shader_program< AttributeBuffer, Framebuffer >&
         ) const
         {
             bind_material_values<
@@ -198,10 +505,92 @@ namespace JadeMatrix::yavsg // Material descriptor /////////////////////////////
                 tuple_type,
                 AttributeBuffer,
                 Framebuffer
-            >::bind( program, names, values );
+            >::bind( values );
+            
+            if constexpr( has_block )
+            {
+                upload_block();
+                block_->bind();
+            }
         }
         
+        // Same as `bind()`, but records the binds into a command buffer; safe
+        // to call off the GPU thread as long as `upload_block()` has been
+        // called since the values last changed
+        template<
+            class AttributeBuffer,
+            class Framebuffer
+        > void record_bind(
+            gl::shader_program< AttributeBuffer, Framebuffer > const&,
+            render_command_buffer& commands
+        ) const
+        {
+            bind_material_values<
+                0,
+                sizeof...( Attributes ),
+                tuple_type,
+                AttributeBuffer,
+                Framebuffer
+            >::record( commands, values );
+            
+            if constexpr( has_block )
+            {
+                if( block_ )
+                {
+                    commands.bind_buffer_range(
+                        GL_UNIFORM_BUFFER,
+                        material_block_binding,
+                        block_->gl_buffer_id(),
+                        block_->current_offset(),
+                        static_cast< GLsizeiptr >( block_layout_type::size )
+                    );
+                }
+            }
+        }
+    
     protected:
+        using block_data_type = std::array<
+            std::byte,
+            block_layout_type::size
+        >;
+        
         tuple_type values;
+        
+        // Uniform block storage is a GPU-side cache of `values`, so it's
+        // created & updated lazily even for const materials
+        mutable std::unique_ptr<
+            gl::uniform_buffer< block_data_type, 2 >
+        > block_;
+        mutable bool block_dirty_ = true;
     };
 }
+
+
+template< typename... Attributes >
+void JadeMatrix::yavsg::material< Attributes... >::upload_block() const
+{
+    if constexpr( has_block )
+    {
+        if( !block_dirty_ )
+        {
+            return;
+        }
+        
+        if( !block_ )
+        {
+            block_ = std::make_unique<
+                gl::uniform_buffer< block_data_type, 2 >
+            >( material_block_binding );
+        }
+        
+        block_data_type block{};
+        auto const complete = pack_material_values<
+            sizeof...( Attributes ),
+            tuple_type
+        >::pack( block.data(), values );
+        block_->update( block );
+        
+        // Keep re-packing until every layer index is known
+        block_dirty_ = !complete;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+
+#include "mapped_file.hpp"
+#include "scene.hpp"
+
+#include <yavsg/gl_wrap.hpp>
+#include <yavsg/math/vector.hpp>
+
+#include <cstddef>      // size_t, byte
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+// Binary caches of parsed meshes, written next to the source file the first
+// time it's loaded so later loads can skip parsing entirely.  Vertices &
+// indices are stored exactly as they're uploaded, each aligned in the file, so
+// a cache is memory-mapped & its blobs handed straight to the buffers.
+//
+// A cache records the size & modification time of every file it was built
+// from (the mesh & its material libraries) as well as the vertex layout it was
+// written with; if any of those differ when it's read, it's ignored & rebuilt.
+// Caches are only meant to be read on the machine that wrote them.
+
+
+namespace JadeMatrix::yavsg
+{
+    // Texture map filenames for one material, relative to the material
+    // directory; empty if the material doesn't have that map
+    struct mesh_material_maps
+    {
+        std::string color;
+        std::string normal;
+        std::string specular;
+    };
+    
+    struct mesh_cache_contents
+    {
+        vector< GLfloat, 3 > bounds_min{ 0.0f, 0.0f, 0.0f };
+        vector< GLfloat, 3 > bounds_max{ 0.0f, 0.0f, 0.0f };
+        std::vector< mesh_material_maps    > materials;
+        std::vector< scene::vertex_type    > vertices;
+        // One list of indices per material
+        std::vector< std::vector< GLuint > > indices;
+    };
+    
+    class cached_mesh
+    {
+    public:
+        struct index_range
+        {
+            GLuint const* indices;
+            std::size_t   count;
+        };
+        
+        cached_mesh( mapped_file&& file );
+        
+        vector< GLfloat, 3 > const& bounds_min() const;
+        vector< GLfloat, 3 > const& bounds_max() const;
+        
+        std::vector< mesh_material_maps > const& materials() const;
+        
+        scene::vertex_type const* vertices() const;
+        std::size_t vertex_count() const;
+        
+        // One range per material, pointing into the mapped file
+        std::vector< index_range > const& indices() const;
+        
+    protected:
+        mapped_file                       file_;
+        vector< GLfloat, 3 >              bounds_min_{ 0.0f, 0.0f, 0.0f };
+        vector< GLfloat, 3 >              bounds_max_{ 0.0f, 0.0f, 0.0f };
+        std::vector< mesh_material_maps > materials_;
+        scene::vertex_type const*         vertices_;
+        std::size_t                       vertex_count_;
+        std::vector< index_range >        indices_;
+    };
+    
+    std::filesystem::path mesh_cache_filename(
+        std::filesystem::path const& source_filename
+    );
+    
+    // Returns nothing if there's no cache or it's out of date; a cache that
+    // can't be read is logged & treated as missing
+    std::optional< cached_mesh > read_mesh_cache(
+        std::filesystem::path const& cache_filename
+    );
+    
+    // `dependencies` are the source files the mesh was built from; throws
+    // `std::runtime_error` if the cache can't be written
+    void write_mesh_cache(
+        std::filesystem::path                const& cache_filename,
+        std::vector< std::filesystem::path > const& dependencies,
+        mesh_cache_contents                  const& contents
+    );
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include "scene.hpp"
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <cstddef>      // size_t
+#include <vector>
+
+
+// Reordering of triangle lists for the GPU, run on task workers before a mesh
+// is uploaded.  None of these change what's drawn, only the order it's drawn
+// in & the order vertices are stored in:
+//
+//   1. `optimize_vertex_cache()` reorders triangles so vertices are reused
+//      while they're still in the post-transform cache (Forsyth's algorithm)
+//   2. `optimize_overdraw()` splits that order into clusters wherever the
+//      cache would have been cold anyways & sorts the clusters so those
+//      facing away from the mesh's center are drawn first, which lets early
+//      depth testing reject more of what's behind them
+//   3. `optimize_vertex_fetch()` stores vertices in the order they're first
+//      used so vertex fetches are mostly sequential
+//
+// `analyze_vertex_cache()` measures the result without a GPU by simulating a
+// FIFO post-transform cache.
+
+
+namespace JadeMatrix::yavsg
+{
+    struct vertex_cache_statistics
+    {
+        std::size_t triangles   = 0;
+        std::size_t vertices    = 0;    // Unique vertices referenced
+        std::size_t transformed = 0;    // Cache misses
+        
+        // Average cache miss ratio, transformed vertices per triangle; 0.5 is
+        // the best possible for a regular grid & 3 the worst
+        double acmr() const;
+        
+        // Average transform to vertex ratio; 1 is ideal
+        double atvr() const;
+        
+        // Combines the statistics of separate index lists
+        vertex_cache_statistics& operator+=( vertex_cache_statistics const& );
+    };
+    
+    constexpr std::size_t default_vertex_cache_size = 16;
+    
+    vertex_cache_statistics analyze_vertex_cache(
+        std::vector< GLuint > const& indices,
+        std::size_t                  vertex_count,
+        std::size_t                  cache_size = default_vertex_cache_size
+    );
+    
+    void optimize_vertex_cache(
+        std::vector< GLuint >& indices,
+        std::size_t            vertex_count
+    );
+    
+    // Expects `indices` to already be in vertex cache order
+    void optimize_overdraw(
+        std::vector< GLuint                        >      & indices,
+        std::vector< scene::vertex_attributes_type > const& vertices,
+        std::size_t                                         cache_size
+            = default_vertex_cache_size
+    );
+    
+    // Reorders `vertices` by first use across all the index lists & remaps
+    // them to match; vertices that aren't used at all are dropped
+    void optimize_vertex_fetch(
+        std::vector< scene::vertex_attributes_type >& vertices,
+        std::vector< std::vector< GLuint >          >& index_lists
+    );
+}
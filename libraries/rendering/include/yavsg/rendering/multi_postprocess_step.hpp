@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "frame_uniforms.hpp"
 #include "render_step.hpp"
 
 #include <yavsg/gl/attribute_buffer.hpp>
@@ -10,6 +11,7 @@
 #include <yavsg/gl/texture.hpp>
 #include <yavsg/math/vector.hpp>
 
+#include <memory>   // shared_ptr
 #include <string>
 #include <vector>
 
@@ -44,6 +46,8 @@ namespace JadeMatrix::yavsg
             gl::framebuffer< gl::texture< GLfloat, 3 > >
         > multi_program;
         
+        std::shared_ptr< frame_uniforms > uniforms;
+        
         gl::shader generate_fragment_shader(
             std::vector< std::string > const& function_names
         );
@@ -1,18 +1,40 @@
 #pragma once
 
 
+#include "mesh_cache.hpp"
+#include "obj_parser.hpp"
 #include "render_object_manager.hpp"
 #include "scene.hpp"
 
+#include <yavsg/gl_wrap.hpp>
+#include <yavsg/math/vector.hpp>
 #include <yavsg/tasking/task.hpp>
 #include <yavsg/tasking/tasking.hpp>
 
+#include <cstddef>  // size_t
 #include <filesystem>
+#include <optional>
 #include <utility>  // move
+#include <vector>
 
 
 namespace JadeMatrix::yavsg
 {
+    struct obj_mesh
+    {
+        std::vector< scene::vertex_attributes_type > vertices;
+        // One list of indices per material
+        std::vector< std::vector< GLuint > > indices;
+        // Tight around the vertices, or both at the origin if there are none
+        vector< GLfloat, 3 > bounds_min{ 0.0f, 0.0f, 0.0f };
+        vector< GLfloat, 3 > bounds_max{ 0.0f, 0.0f, 0.0f };
+        std::size_t corner_count = 0;
+    };
+    
+    // Creates a vertex for each distinct face corner of a parsed OBJ file;
+    // corners are only all given their own vertex if `deduplicate` is false
+    obj_mesh build_obj_mesh( obj_data const& obj, bool deduplicate = true );
+    
     class load_obj_task : public yavsg::task
     {
     public:
@@ -21,11 +43,15 @@ namespace JadeMatrix::yavsg
             // destroyed before this executes
             scene::render_object_manager_type& om,
             std::filesystem::path              fn,
-            std::filesystem::path              md
+            std::filesystem::path              md,
+            // Whether the mesh should also be used as an occluder; only worth
+            // it for large, simple meshes
+            bool                               oc = false
         ) :
             object_manager   { om              },
             obj_filename     { std::move( fn ) },
             obj_mtl_directory{ std::move( md ) },
+            occluder         { oc              },
             upload_mode      { false           }
         {}
         
@@ -39,15 +65,17 @@ namespace JadeMatrix::yavsg
         std::filesystem::path              obj_mtl_directory;
         
         std::vector< scene::material_description > materials;
-        std::vector< scene::vertex_type          > vertices;
-        std::vector< std::vector< GLuint >       > indices;
-        GLfloat obj_max_x;
-        GLfloat obj_min_x;
-        GLfloat obj_max_y;
-        GLfloat obj_min_y;
-        GLfloat obj_max_z;
-        GLfloat obj_min_z;
         
+        // Exactly one of these is filled in, depending on whether the mesh
+        // was read from its cache or parsed
+        std::optional< cached_mesh > cached;
+        mesh_cache_contents          parsed;
+        
+        bool occluder;
         bool upload_mode;
+        
+        void load_materials(
+            std::vector< mesh_material_maps > const& material_maps
+        );
     };
 }
@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+// Reader for Wavefront OBJ meshes & their MTL material libraries, built for
+// large meshes.  The OBJ file is memory-mapped & split at line boundaries into
+// chunks that are parsed in parallel on task workers, then the per-chunk
+// attribute arrays are merged.  Only what the renderer uses is read:
+// positions (with optional vertex colors), normals, texture coordinates,
+// faces, `usemtl`, & `mtllib`; everything else is skipped.  Field names
+// follow tinyobjloader's, which this replaces.
+
+
+namespace JadeMatrix::yavsg
+{
+    // Zero-based; -1 where the face corner doesn't have that attribute
+    struct obj_index
+    {
+        int vertex_index;
+        int normal_index;
+        int texcoord_index;
+    };
+    
+    struct obj_material
+    {
+        std::string name;
+        std::string diffuse_texname;
+        std::string bump_texname;
+        std::string specular_texname;
+    };
+    
+    struct obj_data
+    {
+        std::vector< GLfloat > vertices;    // x, y, z per position
+        std::vector< GLfloat > colors;      // r, g, b per position; 1 if unset
+        std::vector< GLfloat > normals;     // x, y, z
+        std::vector< GLfloat > texcoords;   // u, v
+        
+        // Polygons are triangulated as fans, so there are three of these per
+        // face
+        std::vector< obj_index > indices;
+        
+        // One per face; -1 for faces without a known material
+        std::vector< int > material_ids;
+        
+        std::vector< obj_material > materials;
+        
+        // Every `mtllib` the OBJ file names, resolved against the material
+        // directory, whether or not it could be read
+        std::vector< std::filesystem::path > material_libraries;
+    };
+    
+    // Throws `std::runtime_error` if the OBJ file can't be read or is
+    // malformed; material libraries that can't be read are logged & skipped
+    obj_data parse_obj_file(
+        std::filesystem::path const& obj_filename,
+        std::filesystem::path const& mtl_directory
+    );
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 
+#include "frame_uniforms.hpp"
+#include "occlusion_buffer.hpp"
+#include "render_command_buffer.hpp"
 #include "render_step.hpp"
 #include "scene.hpp"
 
@@ -9,6 +12,9 @@
 #include <yavsg/gl/texture.hpp>
 #include <yavsg/math/vector.hpp>
 
+#include <memory>   // shared_ptr
+#include <vector>
+
 
 namespace JadeMatrix::yavsg
 {
@@ -26,7 +32,14 @@ namespace JadeMatrix::yavsg
         void run( scene const&, gl::write_only_framebuffer& ) override;
         
     protected:
+        std::shared_ptr< frame_uniforms > uniforms;
+        
         // TODO: get rid of thise once shader programs & VAOs are separate
         bool first_run;
+        
+        occlusion_buffer occlusion;
+        
+        // Reused between frames to keep their allocations
+        std::vector< render_command_buffer > command_buffers;
     };
 }
@@ -0,0 +1,88 @@
+#pragma once
+
+
+#include <yavsg/math/matrix.hpp>
+#include <yavsg/math/vector.hpp>
+
+#include <cstddef>  // size_t
+#include <vector>
+
+
+namespace JadeMatrix::yavsg
+{
+    // Low-resolution CPU depth buffer for occlusion culling.  Selected
+    // occluders are rasterized into it each frame, then object bounding boxes
+    // can be tested against it before their draws are submitted.  This doesn't
+    // touch OpenGL at all, so it can be used from any thread.
+    //
+    // Depths are normalized device depths mapped to [0,1], with 1 being the far
+    // plane; the buffer is cleared to 1.
+    class occlusion_buffer
+    {
+    public:
+        using    point_type = vector< float, 3 >;
+        using   matrix_type = square_matrix< float, 4 >;
+        
+        static constexpr std::size_t default_width  = 256;
+        static constexpr std::size_t default_height = 128;
+        
+        // Rows are rasterized in bands of this height, one band per task
+        static constexpr std::size_t band_height = 16;
+        
+        // Width is rounded up to a multiple of 4 and height up to a multiple of
+        // `band_height`
+        occlusion_buffer(
+            std::size_t width  = default_width,
+            std::size_t height = default_height
+        );
+        
+        std::size_t  width() const;
+        std::size_t height() const;
+        
+        // Resets depth to the far plane and discards any queued occluders
+        void clear();
+        
+        // Queue a triangle list (every three points form a triangle) for the
+        // next `rasterize()`.  Triangles crossing the near plane are skipped,
+        // which keeps the buffer conservative.
+        void add_occluder(
+            std::vector< point_type > const& triangles,
+            matrix_type               const& model_view_projection
+        );
+        
+        // Rasterize all queued occluders, spreading bands across task workers
+        void rasterize();
+        
+        // Returns false only if the axis-aligned box is definitely hidden
+        // behind rasterized occluders or entirely outside the view; without
+        // any occluders this is only a frustum test
+        bool test_bounds(
+            point_type  const& bounds_min,
+            point_type  const& bounds_max,
+            matrix_type const& model_view_projection
+        ) const;
+        
+        float depth_at( std::size_t x, std::size_t y ) const;
+        
+    protected:
+        // Triangle in buffer-space pixels, wound counter-clockwise
+        struct screen_triangle
+        {
+            float x[ 3 ];
+            float y[ 3 ];
+            float z[ 3 ];
+        };
+        
+        std::size_t                    width_;
+        std::size_t                    height_;
+        std::vector< float           > depth_;
+        std::vector< screen_triangle > triangles_;
+        
+        void rasterize_band( std::size_t band );
+        void rasterize_triangle(
+            screen_triangle const& triangle,
+            std::size_t            first_row,
+            std::size_t            end_row
+        );
+    };
+}
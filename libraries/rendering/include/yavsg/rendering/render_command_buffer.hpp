@@ -0,0 +1,154 @@
+#pragma once
+
+
+#include <yavsg/gl_wrap.hpp>
+#include <yavsg/gl/shader_program.hpp> // set_current_program_uniform
+
+#include <cstddef>      // size_t, byte
+#include <cstring>      // memcpy
+#include <string>
+#include <type_traits>  // is_trivially_copyable_v
+#include <vector>
+
+
+namespace JadeMatrix::yavsg
+{
+    // Linear buffer of recorded OpenGL commands.  Recording never touches
+    // OpenGL, so buffers can be filled on any worker thread as long as all the
+    // object IDs & uniform locations they reference were looked up beforehand;
+    // `replay()` then issues the commands in order and must be called on the
+    // GPU thread.
+    //
+    // Redundant program, VAO, & buffer binds are dropped while recording, so
+    // keeping each buffer sorted by state is worthwhile.
+    class render_command_buffer
+    {
+    public:
+        render_command_buffer();
+        
+        // Discards all recorded commands but keeps the allocated memory
+        void clear();
+        bool empty() const;
+        
+        void use_program      ( GLuint program_id );
+        void bind_vertex_array( GLuint vao_id     );
+        void bind_buffer      ( GLenum target, GLuint buffer_id );
+        void bind_buffer_range(
+            GLenum     target,
+            GLuint     index,
+            GLuint     buffer_id,
+            GLintptr   offset,
+            GLsizeiptr size
+        );
+        void bind_texture(
+            GLuint texture_unit,
+            GLenum target,
+            GLuint texture_id
+        );
+        
+        // Any type with a `gl::set_current_program_uniform<>()` specialization
+        // can be recorded; uniforms apply to the last program used
+        template< typename T > void set_uniform(
+            GLint    location,
+            T const& value
+        );
+        
+        void draw_arrays( GLenum mode, GLint first, GLsizei count );
+        // Indices are always `GLuint`
+        void draw_elements(
+            GLenum      mode,
+            GLsizei     count,
+            std::size_t first_index
+        );
+        
+        void replay() const;
+        
+    protected:
+        enum class opcode : unsigned char
+        {
+            use_program,
+            bind_vertex_array,
+            bind_buffer,
+            bind_buffer_range,
+            bind_texture,
+            set_uniform,
+            draw_arrays,
+            draw_elements
+        };
+        
+        // Applies a recorded uniform, returning the position just past it
+        using uniform_setter = std::byte const* (*)(
+            GLint            location,
+            std::byte const* value
+        );
+        
+        std::vector< std::byte > commands_;
+        
+        // Recording-time state used to drop redundant binds
+        GLuint current_program_;
+        GLuint current_vao_;
+        GLuint current_array_buffer_;
+        GLuint current_element_buffer_;
+        
+        template< typename T > void write( T const& value );
+        
+        template< typename T > static std::byte const* apply_uniform(
+            GLint            location,
+            std::byte const* value
+        );
+    };
+}
+
+
+template< typename T >
+void JadeMatrix::yavsg::render_command_buffer::set_uniform(
+    GLint    location,
+    T const& value
+)
+{
+    static_assert(
+        std::is_trivially_copyable_v< T >,
+        "recorded uniform values must be trivially copyable"
+    );
+    
+    // Setting a uniform at location -1 is silently ignored by OpenGL anyways
+    if( location == -1 )
+    {
+        return;
+    }
+    
+    write( opcode::set_uniform );
+    write( &apply_uniform< T > );
+    write( location );
+    write( value );
+}
+
+template< typename T >
+void JadeMatrix::yavsg::render_command_buffer::write( T const& value )
+{
+    auto const offset = commands_.size();
+    commands_.resize( offset + sizeof( T ) );
+    std::memcpy( commands_.data() + offset, &value, sizeof( T ) );
+}
+
+template< typename T >
+std::byte const* JadeMatrix::yavsg::render_command_buffer::apply_uniform(
+    GLint            location,
+    std::byte const* value
+)
+{
+    // Recorded values are packed without padding, so copy into suitably-
+    // aligned storage before use
+    alignas( T ) std::byte storage[ sizeof( T ) ];
+    std::memcpy( storage, value, sizeof( T ) );
+    
+    GLuint program_id = 0;
+    gl::set_current_program_uniform< T >(
+        location,
+        *reinterpret_cast< T const* >( storage ),
+        std::string{},
+        program_id
+    );
+    
+    return value + sizeof( T );
+}
@@ -55,6 +55,14 @@ namespace JadeMatrix::yavsg
             vector< GLfloat, 3 > scale;
             versor< GLfloat > rotation;
             
+            // Object-space bounding box, used for occlusion culling
+            vector< GLfloat, 3 > bounds_min;
+            vector< GLfloat, 3 > bounds_max;
+            
+            // Object-space triangle list rasterized into the occlusion buffer
+            // each frame; most objects should leave this empty
+            std::vector< vector< GLfloat, 3 > > occluder_vertices;
+            
             // render_object() = default;
             render_object( render_object const& o ) = delete;
             
@@ -63,13 +71,17 @@ namespace JadeMatrix::yavsg
                 AttributeBuffer            && v,
                 vector< GLfloat, 3 >   const& p,
                 vector< GLfloat, 3 >   const& s,
-                versor< GLfloat >      const& r
+                versor< GLfloat >      const& r,
+                vector< GLfloat, 3 >   const& bmin,
+                vector< GLfloat, 3 >   const& bmax
             ) :
                 render_groups( std::move( rg ) ),
                 vertices(      std::move( v  ) ),
                 position( p ),
                 scale(    s ),
-                rotation( r )
+                rotation( r ),
+                bounds_min( bmin ),
+                bounds_max( bmax )
             {}
             
             render_object( render_object&& o ) :
@@ -77,7 +89,10 @@ namespace JadeMatrix::yavsg
                 vertices(      std::move( o.vertices      ) ),
                 position(      std::move( o.position      ) ),
                 scale(         std::move( o.scale         ) ),
-                rotation(      std::move( o.rotation      ) )
+                rotation(      std::move( o.rotation      ) ),
+                bounds_min(    std::move( o.bounds_min    ) ),
+                bounds_max(    std::move( o.bounds_max    ) ),
+                occluder_vertices( std::move( o.occluder_vertices ) )
             {}
             
             square_matrix< GLfloat, 4 > transform_model() const
@@ -119,7 +134,7 @@ namespace JadeMatrix::yavsg
             {
                 return &parent.objects;
             }
-            
+        
         protected:
             render_object_manager& parent;
             bool should_unlock = false;
@@ -160,7 +175,7 @@ namespace JadeMatrix::yavsg
             {
                 return &parent.objects;
             }
-            
+        
         protected:
             render_object_manager& parent;
             bool should_unlock = false;
@@ -185,7 +200,7 @@ namespace JadeMatrix::yavsg
         {
             return write_reference( *this );
         }
-        
+    
     protected:
         // Possibly different in the future
         std::mutex mutable read_mutex;
@@ -4,10 +4,15 @@
 #include "material.hpp"
 #include "camera.hpp"
 #include "render_object_manager.hpp"
-#include "texture_reference.hpp"
+#include "texture_array_packer.hpp"
 
+#include <yavsg/gl/component_types.hpp>
+#include <yavsg/math/matrix.hpp>
+#include <yavsg/math/vector.hpp>
+
+#include <array>
 #include <utility>  // size_t
-#include <tuple>    // tuple_size_v
+#include <tuple>    // tuple, tuple_size_v
 
 
 namespace JadeMatrix::yavsg
@@ -18,31 +23,44 @@ namespace JadeMatrix::yavsg
         
         // Material structures /////////////////////////////////////////////////
         
-        using material_texture_type = texture_reference< GLfloat, 4 >;
+        // Each map uses the smallest format that keeps its precision: color
+        // maps stay sRGB-encoded like their source images, normals only need
+        // 8 bits per component, & specular maps are a single intensity.  Maps
+        // are packed into texture arrays so materials with same-size maps
+        // share their texture binds.
+        using color_map_type    = texture_layer_reference< gl::srgb, 4 >;
+        using normal_map_type   = texture_layer_reference<
+            gl::normalized< GLubyte >,
+            3
+        >;
+        using specular_map_type = texture_layer_reference<
+            gl::normalized< GLubyte >,
+            1
+        >;
         
         using material_description_base = material<
-            material_texture_type,
-            material_texture_type,
-            material_texture_type
+            color_map_type,
+            normal_map_type,
+            specular_map_type
         >;
         
         class material_description : public material_description_base
         {
         public:
-            material_texture_type      &    color_map()       { return std::get< 0 >( values ); }
-            material_texture_type      &   normal_map()       { return std::get< 1 >( values ); }
-            material_texture_type      & specular_map()       { return std::get< 2 >( values ); }
-            material_texture_type const&    color_map() const { return std::get< 0 >( values ); }
-            material_texture_type const&   normal_map() const { return std::get< 1 >( values ); }
-            material_texture_type const& specular_map() const { return std::get< 2 >( values ); }
+            color_map_type         &    color_map()       { return std::get< 0 >( values ); }
+            normal_map_type        &   normal_map()       { return std::get< 1 >( values ); }
+            specular_map_type      & specular_map()       { return std::get< 2 >( values ); }
+            color_map_type    const&    color_map() const { return std::get< 0 >( values ); }
+            normal_map_type   const&   normal_map() const { return std::get< 1 >( values ); }
+            specular_map_type const& specular_map() const { return std::get< 2 >( values ); }
             
             using material_description_base::material;
             
             material_description() : material_description_base( {}, {}, {} ) {}
             material_description(
-                material_texture_type& c,
-                material_texture_type& n,
-                material_texture_type& s
+                color_map_type   & c,
+                normal_map_type  & n,
+                specular_map_type& s
             ) : material_description_base( c, n, s ) {}
             material_description( material_description const& o ) = delete;
             material_description( material_description&& o ) :
@@ -60,13 +78,60 @@ namespace JadeMatrix::yavsg
         
         // Vertex structures ///////////////////////////////////////////////////
         
-        using attribute_buffer_type = gl::attribute_buffer<
+        // Vertices as loaders build them, before they're packed
+        using vertex_attributes_type = std::tuple<
             vector< GLfloat, 3 >,    // position
             vector< GLfloat, 3 >,    // normal
             vector< GLfloat, 3 >,    // color
             vector< GLfloat, 2 >     // texture
         >;
+        
+        // Normals are octahedral-encoded either way; `shaders/obj_scene.vert`
+        // doesn't read them yet, but has `oct_decode()` ready for when its
+        // `vertex_in_normal` input is enabled
+    #ifdef YAVSG_PACKED_VERTICES
+        // 20 bytes instead of 40; normalized attributes still reach the
+        // shader as floats
+        using attribute_buffer_type = gl::attribute_buffer<
+            // position, quantized to the mesh's bounds; W is padding
+            std::array< gl::normalized< GLushort >, 4 >,
+            // normal, octahedral-encoded
+            std::array< gl::normalized< GLshort  >, 2 >,
+            // color, A is padding
+            std::array< gl::normalized< GLubyte  >, 4 >,
+            // texture
+            std::array< gl::half, 2 >
+        >;
+    #else
+        using attribute_buffer_type = gl::attribute_buffer<
+            vector< GLfloat, 3 >,    // position
+            vector< GLfloat, 2 >,    // normal, octahedral-encoded
+            vector< GLfloat, 3 >,    // color
+            vector< GLfloat, 2 >     // texture
+        >;
+    #endif
         using vertex_type = attribute_buffer_type::tuple_type;
+        
+        // Packing depends on the bounding box of the mesh the vertex belongs
+        // to, as positions are stored relative to it; for render objects,
+        // that's their `bounds_min` & `bounds_max`
+        static vertex_type pack_vertex(
+            vertex_attributes_type const& attributes,
+            vector< GLfloat, 3 >   const& bounds_min,
+            vector< GLfloat, 3 >   const& bounds_max
+        );
+        static vector< GLfloat, 3 > unpack_position(
+            vertex_type          const& vertex,
+            vector< GLfloat, 3 > const& bounds_min,
+            vector< GLfloat, 3 > const& bounds_max
+        );
+        
+        // Maps positions as they're stored in vertices to object space
+        static square_matrix< GLfloat, 4 > vertex_position_transform(
+            vector< GLfloat, 3 > const& bounds_min,
+            vector< GLfloat, 3 > const& bounds_max
+        );
+        
         using render_object_manager_type = render_object_manager<
             attribute_buffer_type,
             material_description
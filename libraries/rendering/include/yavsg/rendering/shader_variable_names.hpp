@@ -9,7 +9,7 @@ namespace JadeMatrix::yavsg
     // Standard declarations in shaders
 #if 0
     in vec3 vertex_in_position;
-    in vec3 vertex_in_normal;
+    in vec2 vertex_in_normal;   // Octahedral-encoded
     in vec3 vertex_in_tangent;
     in vec3 vertex_in_color;
     in vec2 vertex_in_texture;
@@ -17,8 +17,6 @@ namespace JadeMatrix::yavsg
     uniform TRANSFORM
     {
         mat4 model;
-        mat4 view;
-        mat4 projection;
     } transform;
     
     out VERTEX_OUT
@@ -44,20 +42,10 @@ namespace JadeMatrix::yavsg
         sampler2D mask;
     } map;
     
-    uniform struct
-    {
-        float near;
-        float focal;
-        float far;
-    } camera_point;
-    
     uniform sampler2D framebuffer_source_color;
     uniform sampler2D framebuffer_source_depth;
-    uniform struct
-    {
-        float width;
-        float height;
-    } framebuffer_target;
+    
+    // See also the uniform blocks in frame_uniforms.hpp
     
     out vec4 fragment_out_color;
 #endif
@@ -71,8 +59,6 @@ namespace JadeMatrix::yavsg
         vertex_in_texture,
         
         transform_model,
-        transform_view,
-        transform_projection,
         
         vertex_out_position,
         vertex_out_color,
@@ -86,15 +72,13 @@ namespace JadeMatrix::yavsg
         map_color,
         map_normal,
         map_specular,
+        material_block,
         
-        camera_point_near,
-        camera_point_focal,
-        camera_point_far,
+        camera_block,
         
         framebuffer_source_color,
         framebuffer_source_depth,
-        framebuffer_target_width,
-        framebuffer_target_height,
+        framebuffer_target_block,
         
         fragment_out_color
     };
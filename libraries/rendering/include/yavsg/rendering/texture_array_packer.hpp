@@ -0,0 +1,569 @@
+#pragma once
+
+
+#include "texture_cache.hpp"        // texture_cache_key, make_texture_cache_key
+#include "texture_reference.hpp"    // try_load_texture_file, blank_texture_data
+#include "texture_residency.hpp"
+
+#include <yavsg/gl/texture_array.hpp>
+#include <yavsg/gl/texture_streaming.hpp>
+#include <yavsg/tasking/parallel_for.hpp>
+#include <yavsg/tasking/task.hpp>
+#include <yavsg/tasking/tasking.hpp>
+
+#include <algorithm>    // min, find_if
+#include <atomic>
+#include <cstddef>      // size_t
+#include <filesystem>
+#include <map>
+#include <memory>       // shared_ptr, make_shared, unique_ptr, make_unique
+#include <optional>
+#include <stdexcept>    // invalid_argument, runtime_error
+#include <string>
+#include <tuple>
+#include <utility>      // move
+#include <vector>
+
+
+// Material maps are usually loaded as separate textures, which means a bind per
+// map per draw & a draw split wherever the material changes.  The packer
+// instead gathers every queued map of one type, loads them all, & uploads each
+// set of same-size, same-format images as the layers of one
+// `GL_TEXTURE_2D_ARRAY`.  Materials then refer to a layer in an array, so any
+// number of them can share a single set of texture binds & differ only in the
+// layer indices in their uniform block (see material.hpp).
+
+
+namespace JadeMatrix::yavsg
+{
+    // OpenGL 3.2 only guarantees this many layers per array, so larger sets of
+    // images are split across several arrays
+    constexpr std::size_t max_texture_array_layers = 256;
+    
+    template< typename DataType, std::size_t Channels >
+    class texture_array_packer;
+    
+    template< typename DataType, std::size_t Channels >
+    class pack_texture_array_task;
+    
+    // Refers to one layer of a texture array built by a `texture_array_packer`
+    template< typename DataType, std::size_t Channels >
+    class texture_layer_reference
+    {
+        friend class texture_array_packer< DataType, Channels >;
+        
+    public:
+        using texture_array_type = gl::texture_array< DataType, Channels >;
+        using packer_type        = texture_array_packer< DataType, Channels >;
+        
+        class shared_data
+        {
+        public:
+            // Keeps the array alive for as long as any of its layers are
+            // referred to; along with `layer`, only written before `array` is
+            // published
+            std::shared_ptr< texture_array_type > owner;
+            GLint                                 layer = 0;
+            
+            // Null until the array has been uploaded, after which it never
+            // changes; published with release semantics so readers only need
+            // an acquire load
+            std::atomic< texture_array_type* > array{ nullptr };
+            
+            // Set instead of `array` if the layer's file couldn't be loaded
+            std::atomic< bool > failed{ false };
+        };
+        
+        texture_layer_reference() = default;
+        
+        // Checks if this refers to a layer ready for rendering
+        operator bool() const;
+        
+        // Whether this refers to a layer that hasn't been uploaded yet, as
+        // opposed to not referring to anything or to a layer that failed to
+        // load
+        bool pending() const;
+        
+        // Throws `std::invalid_argument` if this does not refer to a layer
+        // ready for rendering
+        texture_array_type const& array() const;
+        
+        // 0 until the layer is ready for rendering
+        GLint layer() const;
+        
+    protected:
+        std::shared_ptr< shared_data > shared_data_;
+    };
+    
+    template< typename DataType, std::size_t Channels >
+    class texture_array_packer
+    {
+        friend class pack_texture_array_task< DataType, Channels >;
+        
+    public:
+        using reference_type = texture_layer_reference< DataType, Channels >;
+        
+        // Every layer in an array is sampled the same way, so the filter
+        // settings are shared by everything queued in the packer
+        texture_array_packer( gl::texture_filter_settings const& settings );
+        
+        // Queues an image or KTX file to be packed; queuing the same file with
+        // the same flags more than once returns references to the same layer
+        reference_type add(
+            std::filesystem::path  filename,
+            gl::texture_flags_type flags = gl::texture_flag::none
+        );
+        
+        // Hands everything queued so far off to a task that loads the files &
+        // uploads the arrays, after which the packer is empty & can be reused
+        void submit();
+        
+    protected:
+        using shared_data = typename reference_type::shared_data;
+        
+        struct queued_file
+        {
+            std::filesystem::path          filename;
+            gl::texture_flags_type         flags;
+            std::shared_ptr< shared_data > shared;
+        };
+        
+        gl::texture_filter_settings settings_;
+        std::vector< queued_file >  queue_;
+        std::map<
+            texture_cache_key,
+            std::shared_ptr< shared_data >
+        > queued_keys_;
+    };
+}
+
+
+namespace JadeMatrix::yavsg // Tasks ///////////////////////////////////////////
+{
+    template<
+        typename    DataType,
+        std::size_t Channels
+    > class pack_texture_array_task : public task
+    {
+    public:
+        using shared_data = typename texture_layer_reference<
+            DataType,
+            Channels
+        >::shared_data;
+        using queued_file = typename texture_array_packer<
+            DataType,
+            Channels
+        >::queued_file;
+        
+    protected:
+        std::vector< queued_file >  queue_;
+        gl::texture_filter_settings settings_;
+        
+    public:
+        pack_texture_array_task(
+            std::vector< queued_file >  queue,
+            gl::texture_filter_settings settings
+        ) :
+            queue_   { std::move( queue ) },
+            settings_{ settings           }
+        {}
+        
+        bool operator()() override;
+    };
+    
+    template<
+        typename    DataType,
+        std::size_t Channels
+    > class upload_texture_array_task : public task
+    {
+    public:
+        using shared_data = typename texture_layer_reference<
+            DataType,
+            Channels
+        >::shared_data;
+        
+    protected:
+        std::vector< gl::texture_upload_data        > layers_;
+        std::vector< std::shared_ptr< shared_data > > shared_;
+        gl::texture_filter_settings                   settings_;
+        texture_data_source                           source_;
+        
+        // Created on the first run; the upload is then spread across as many
+        // frames as the texture upload budget requires
+        std::shared_ptr< gl::texture_array< DataType, Channels > > array_;
+        std::optional< gl::texture_upload_stream >                 stream_;
+        
+    public:
+        upload_texture_array_task(
+            std::vector< gl::texture_upload_data        > layers,
+            std::vector< std::shared_ptr< shared_data > > shared,
+            gl::texture_filter_settings                   settings,
+            // Lets the uploaded data be freed & reloaded as needed
+            texture_data_source                           source = {}
+        ) :
+            layers_  { std::move( layers ) },
+            shared_  { std::move( shared ) },
+            settings_{ settings            },
+            source_  { std::move( source ) }
+        {
+            using namespace std::string_literals;
+            if( layers_.size() != shared_.size() )
+            {
+                throw std::invalid_argument(
+                    "upload_texture_array_task needs shared data for every "
+                    "layer"s
+                );
+            }
+        }
+        
+        task_flags_type flags() const override
+        {
+            return task_flag::gpu_thread;
+        }
+        
+        bool operator()() override;
+    };
+}
+
+
+// Texture layer reference implementation //////////////////////////////////////
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> JadeMatrix::yavsg::texture_layer_reference<
+    DataType,
+    Channels
+>::operator bool() const
+{
+    return (
+        shared_data_
+        && shared_data_->array.load( std::memory_order_acquire )
+    );
+}
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> bool JadeMatrix::yavsg::texture_layer_reference<
+    DataType,
+    Channels
+>::pending() const
+{
+    return (
+        shared_data_
+        && !shared_data_->array.load( std::memory_order_acquire )
+        && !shared_data_->failed.load( std::memory_order_acquire )
+    );
+}
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> typename JadeMatrix::yavsg::texture_layer_reference<
+    DataType,
+    Channels
+>::texture_array_type const& JadeMatrix::yavsg::texture_layer_reference<
+    DataType,
+    Channels
+>::array() const
+{
+    using namespace std::string_literals;
+    
+    if( shared_data_ )
+    {
+        if( auto const a = shared_data_->array.load(
+            std::memory_order_acquire
+        ); a )
+        {
+            return *a;
+        }
+    }
+    
+    throw std::invalid_argument(
+        "yavsg::texture_layer_reference does not refer to a layer ready for "
+        "rendering"s
+    );
+}
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> GLint JadeMatrix::yavsg::texture_layer_reference<
+    DataType,
+    Channels
+>::layer() const
+{
+    // The layer index is written before the array is published
+    return *this ? shared_data_->layer : 0;
+}
+
+
+// Texture array packer implementation /////////////////////////////////////////
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> JadeMatrix::yavsg::texture_array_packer<
+    DataType,
+    Channels
+>::texture_array_packer( gl::texture_filter_settings const& settings ) :
+    settings_{ settings }
+{}
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> typename JadeMatrix::yavsg::texture_array_packer<
+    DataType,
+    Channels
+>::reference_type JadeMatrix::yavsg::texture_array_packer<
+    DataType,
+    Channels
+>::add(
+    std::filesystem::path  filename,
+    gl::texture_flags_type flags
+)
+{
+    reference_type ref;
+    
+    auto& shared = queued_keys_[ make_texture_cache_key(
+        filename,
+        settings_,
+        flags
+    ) ];
+    if( !shared )
+    {
+        shared = std::make_shared< shared_data >();
+        queue_.push_back( { std::move( filename ), flags, shared } );
+    }
+    
+    ref.shared_data_ = shared;
+    return ref;
+}
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> void JadeMatrix::yavsg::texture_array_packer<
+    DataType,
+    Channels
+>::submit()
+{
+    if( queue_.empty() )
+    {
+        return;
+    }
+    
+    auto queue = std::move( queue_ );
+    queue_.clear();
+    queued_keys_.clear();
+    
+    submit_task( std::make_unique<
+        pack_texture_array_task< DataType, Channels >
+    >(
+        std::move( queue ),
+        settings_
+    ) );
+}
+
+
+// Task implementations ////////////////////////////////////////////////////////
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> bool JadeMatrix::yavsg::pack_texture_array_task<
+    DataType,
+    Channels
+>::operator()()
+{
+    using format_traits = gl::texture_format_traits< DataType, Channels >;
+    
+    // A file that can't be loaded only leaves its own layer out, rather than
+    // every layer queued along with it
+    std::vector< std::optional< gl::texture_upload_data > > loaded(
+        queue_.size()
+    );
+    parallel_for( queue_.size(), [ & ]( std::size_t i ){
+        loaded[ i ] = try_load_texture_file(
+            queue_[ i ].filename,
+            queue_[ i ].flags,
+            settings_,
+            format_traits::gl_internal_format
+        );
+    } );
+    
+    // Images can only share an array if they'd be uploaded identically; the
+    // internal format can differ between KTX & other files, & the incoming
+    // format with whether an alpha channel was dropped
+    using group_key = std::tuple<
+        GLint,          // Internal format
+        std::size_t,    // Width
+        std::size_t,    // Height
+        GLenum,         // Incoming format
+        GLenum,         // Incoming type
+        std::size_t     // Mip levels
+    >;
+    std::map< group_key, std::vector< std::size_t > > groups;
+    for( std::size_t i = 0; i < loaded.size(); ++i )
+    {
+        if( !loaded[ i ] )
+        {
+            queue_[ i ].shared->failed.store( true, std::memory_order_release );
+            continue;
+        }
+        groups[ {
+            loaded[ i ]->gl_internal_format,
+            loaded[ i ]->width,
+            loaded[ i ]->height,
+            loaded[ i ]->gl_incoming_format,
+            loaded[ i ]->gl_incoming_type,
+            loaded[ i ]->mipmaps.size()
+        } ].push_back( i );
+    }
+    
+    for( auto const& [ key, indices ] : groups )
+    {
+        for(
+            std::size_t first = 0;
+            first < indices.size();
+            first += max_texture_array_layers
+        )
+        {
+            auto const end = std::min(
+                first + max_texture_array_layers,
+                indices.size()
+            );
+            
+            std::vector< gl::texture_upload_data        > layers;
+            std::vector< std::shared_ptr< shared_data > > shared;
+            std::vector< queued_file                    > files;
+            layers.reserve( end - first );
+            shared.reserve( end - first );
+            files .reserve( end - first );
+            for( auto i = first; i < end; ++i )
+            {
+                layers.push_back( std::move( *loaded[ indices[ i ] ] ) );
+                shared.push_back( std::move( queue_[ indices[ i ] ].shared ) );
+                // Without its shared data, so reloading doesn't keep the
+                // layer alive
+                files .push_back( std::move( queue_[ indices[ i ] ] ) );
+            }
+            
+            // Reloads every layer of the array the same way they were loaded
+            // here; layers whose files have since gone missing are reloaded
+            // blank so the rest of the array can still be streamed
+            texture_data_source source = [
+                files    = std::move( files ),
+                settings = settings_
+            ](){
+                using namespace std::string_literals;
+                
+                std::vector<
+                    std::optional< gl::texture_upload_data >
+                > results( files.size() );
+                parallel_for( files.size(), [ & ]( std::size_t i ){
+                    results[ i ] = try_load_texture_file(
+                        files[ i ].filename,
+                        files[ i ].flags,
+                        settings,
+                        format_traits::gl_internal_format
+                    );
+                } );
+                
+                auto const like = std::find_if(
+                    results.begin(),
+                    results.end(),
+                    []( auto const& result ){ return result.has_value(); }
+                );
+                if( like == results.end() )
+                {
+                    throw std::runtime_error(
+                        "none of the texture array's layers could be "
+                        "reloaded"s
+                    );
+                }
+                
+                std::vector< gl::texture_upload_data > reloaded;
+                reloaded.reserve( results.size() );
+                for( auto& result : results )
+                {
+                    reloaded.push_back(
+                        result
+                        ? std::move( *result )
+                        : blank_texture_data( **like )
+                    );
+                }
+                return reloaded;
+            };
+            
+            submit_task( std::make_unique<
+                upload_texture_array_task< DataType, Channels >
+            >(
+                std::move( layers ),
+                std::move( shared ),
+                settings_,
+                std::move( source )
+            ) );
+        }
+    }
+    
+    return false;
+}
+
+template<
+    typename    DataType,
+    std::size_t Channels
+> bool JadeMatrix::yavsg::upload_texture_array_task<
+    DataType,
+    Channels
+>::operator()()
+{
+    using array_type = gl::texture_array< DataType, Channels >;
+    
+    if( !stream_ )
+    {
+        // Default array construction is only accessible to this task, so this
+        // can't use `std::make_shared<>()`
+        array_ = std::shared_ptr< array_type >( new array_type(
+            gl::texture_shape_of(
+                GL_TEXTURE_2D_ARRAY,
+                layers_.front(),
+                layers_.size()
+            )
+        ) );
+        array_->layers_ = shared_.size();
+        stream_.emplace(
+            array_->gl_texture_id(),
+            std::move( layers_ ),
+            settings_
+        );
+        stream_->target_level( initial_texture_level( *stream_ ) );
+    }
+    
+    // Requeue until the rest fits in a later frame's budget
+    if( !stream_->upload_some() )
+    {
+        return true;
+    }
+    
+    // Larger levels are streamed in by the residency manager once the array
+    // is actually drawn
+    texture_residency::instance().add(
+        std::move( *stream_ ),
+        std::move( source_ )
+    );
+    stream_.reset();
+    
+    // Only publish the layers once the smallest levels of every layer are
+    // uploaded
+    for( std::size_t i = 0; i < shared_.size(); ++i )
+    {
+        shared_[ i ]->owner = array_;
+        shared_[ i ]->layer = static_cast< GLint >( i );
+        shared_[ i ]->array.store( array_.get(), std::memory_order_release );
+    }
+    
+    return false;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+
+#include <yavsg/gl/texture_utilities.hpp>
+
+#include <algorithm>    // max
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+#include <filesystem>
+#include <map>
+#include <memory>       // shared_ptr, make_shared, weak_ptr
+#include <mutex>
+#include <tuple>
+#include <utility>      // pair
+
+
+// Textures loaded from files are shared between every reference to the same
+// file with the same settings, whether the load is still in flight or already
+// finished.  The cache only holds weak references, so a texture is freed as
+// usual once nothing refers to it; expired entries are swept out as the cache
+// grows.
+
+
+namespace JadeMatrix::yavsg
+{
+    struct texture_cache_counters
+    {
+        std::uint64_t hits      = 0;
+        std::uint64_t misses    = 0;
+        std::uint64_t evictions = 0;
+    };
+    
+    // Counts across all texture types
+    texture_cache_counters texture_cache_counts();
+    void reset_texture_cache_counts();
+    
+    // Used by `texture_cache` to update the counters
+    void count_texture_cache_lookup( bool hit );
+    void count_texture_cache_evictions( std::size_t count );
+    
+    using texture_cache_key = std::tuple<
+        std::filesystem::path,
+        gl::texture_filter_settings::magnify_mode,
+        gl::texture_filter_settings::minify_mode,
+        gl::texture_filter_settings::mipmap_type,
+        gl::texture_flags_type
+    >;
+    
+    // Paths are made canonical where possible so different spellings of the
+    // same file share an entry
+    texture_cache_key make_texture_cache_key(
+        std::filesystem::path       const& filename,
+        gl::texture_filter_settings const& settings,
+        gl::texture_flags_type             flags
+    );
+    
+    template< typename SharedData > class texture_cache
+    {
+    public:
+        static texture_cache& instance();
+        
+        // Returns the shared data for the key, & whether it was just created &
+        // still needs to be loaded by the caller
+        std::pair< std::shared_ptr< SharedData >, bool > find_or_create(
+            texture_cache_key const& key
+        );
+    
+    protected:
+        // Sweeps happen whenever the cache doubles in size since the last one,
+        // so they're amortized over insertions
+        static constexpr std::size_t minimum_sweep_size = 16;
+        
+        std::mutex mutex_;
+        std::map< texture_cache_key, std::weak_ptr< SharedData > > entries_;
+        std::size_t next_sweep_size_ = minimum_sweep_size;
+        
+        texture_cache() = default;
+        
+        // Must be called with `mutex_` held
+        void sweep();
+    };
+}
+
+
+// Texture cache implementation ////////////////////////////////////////////////
+
+template< typename SharedData >
+JadeMatrix::yavsg::texture_cache< SharedData >&
+JadeMatrix::yavsg::texture_cache< SharedData >::instance()
+{
+    static texture_cache cache;
+    return cache;
+}
+
+template< typename SharedData >
+std::pair< std::shared_ptr< SharedData >, bool >
+JadeMatrix::yavsg::texture_cache< SharedData >::find_or_create(
+    texture_cache_key const& key
+)
+{
+    std::lock_guard< std::mutex > lock( mutex_ );
+    
+    auto& entry = entries_[ key ];
+    if( auto const existing = entry.lock(); existing )
+    {
+        count_texture_cache_lookup( true );
+        return { existing, false };
+    }
+    count_texture_cache_lookup( false );
+    
+    auto const created = std::make_shared< SharedData >();
+    entry = created;
+    
+    if( entries_.size() >= next_sweep_size_ )
+    {
+        sweep();
+    }
+    
+    return { created, true };
+}
+
+template< typename SharedData >
+void JadeMatrix::yavsg::texture_cache< SharedData >::sweep()
+{
+    std::size_t evicted = 0;
+    for( auto iter = entries_.begin(); iter != entries_.end(); )
+    {
+        if( iter->second.expired() )
+        {
+            iter = entries_.erase( iter );
+            ++evicted;
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    
+    count_texture_cache_evictions( evicted );
+    next_sweep_size_ = std::max( minimum_sweep_size, entries_.size() * 2 );
+}
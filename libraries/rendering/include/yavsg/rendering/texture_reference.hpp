@@ -1,24 +1,54 @@
 #pragma once
 
 
+#include "texture_cache.hpp"
+#include "texture_residency.hpp"
+
 #include <yavsg/gl/texture.hpp>
+#include <yavsg/gl/texture_streaming.hpp>
 #include <yavsg/tasking/task.hpp>
 #include <yavsg/tasking/tasking.hpp>
 
-// TODO: Don't have this in the header
-#include <SDL2/SDL_image.h>
-
+#include <atomic>
 #include <cstddef>      // size_t
 #include <exception>    // invalid_argument, runtime_error
 #include <filesystem>
 #include <memory>       // shared_ptr, make_shared, unique_ptr, make_unique
-#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>      // move
+#include <vector>
 
 
 namespace JadeMatrix::yavsg
 {
+    // Reads an image or KTX file & preprocesses it for uploading; must not be
+    // called on the GPU thread.  KTX files hold textures that were already
+    // preprocessed & compressed along with their mip chains (see
+    // `programs/texture_cook/`), so they're returned as-is.  Throws
+    // `std::runtime_error` if the file can't be loaded.
+    gl::texture_upload_data load_texture_file(
+        std::filesystem::path       const& filename,
+        gl::texture_flags_type             flags,
+        gl::texture_filter_settings const& settings,
+        GLint                              gl_internal_format
+    );
+    
+    // As `load_texture_file()`, but logs why the file couldn't be loaded &
+    // returns nothing instead of throwing
+    std::optional< gl::texture_upload_data > try_load_texture_file(
+        std::filesystem::path       const& filename,
+        gl::texture_flags_type             flags,
+        gl::texture_filter_settings const& settings,
+        GLint                              gl_internal_format
+    );
+    
+    // Zero-filled data with the same format, size, & mip levels as `like`, to
+    // stand in for a file that can no longer be loaded
+    gl::texture_upload_data blank_texture_data(
+        gl::texture_upload_data const& like
+    );
+    
     template< typename DataType, std::size_t Channels > class texture_reference
     {
     public:
@@ -27,9 +57,11 @@ namespace JadeMatrix::yavsg
         class shared_data
         {
         public:
-            std::mutex mutable data_mutex;
+            // Null until the texture has been uploaded, after which it never
+            // changes; published with release semantics so readers only need
+            // an acquire load
             // TODO: std::unique_ptr< texture_type > texture;
-            texture_type* texture;
+            std::atomic< texture_type* > texture;
             
             shared_data();
             ~shared_data();
@@ -63,7 +95,7 @@ namespace JadeMatrix::yavsg
         {
             return *( this->operator->() );
         }
-        
+    
     protected:
         std::shared_ptr< shared_data > shared_data_;
     };
@@ -129,18 +161,27 @@ namespace JadeMatrix::yavsg // Tasks ///////////////////////////////////////////
         gl::texture_upload_data        upload_data_;
         gl::texture_filter_settings    settings_;
         gl::texture_flags_type         flags_;
+        texture_data_source            source_;
+        
+        // Created on the first run; the upload is then spread across as many
+        // frames as the texture upload budget requires
+        std::unique_ptr< gl::texture< DataType, Channels > > texture_;
+        std::optional< gl::texture_upload_stream >           stream_;
         
     public:
         upload_texture_data_task(
             std::shared_ptr< shared_data > sd,
             gl::texture_upload_data        upload_data,
             gl::texture_filter_settings    settings,
-            gl::texture_flags_type         flags
+            gl::texture_flags_type         flags,
+            // Lets the uploaded data be freed & reloaded as needed
+            texture_data_source            source = {}
         ) :
             shared_data_{ sd                       },
             upload_data_{ std::move( upload_data ) },
             settings_   { settings                 },
-            flags_      { flags                    }
+            flags_      { flags                    },
+            source_     { std::move( source )      }
         {
             using namespace std::string_literals;
             if( !shared_data_ )
@@ -158,36 +199,6 @@ namespace JadeMatrix::yavsg // Tasks ///////////////////////////////////////////
         
         bool operator()() override;
     };
-    
-    template<
-        typename   DataType,
-        std::size_t Channels
-    > class destroy_texture_data_task : public task
-    {
-    public:
-        using shared_data = typename texture_reference<
-            DataType,
-            Channels
-        >::shared_data;
-        
-    protected:
-        // TODO: std::unique_ptr< gl::texture< DataType, Channels > > texture_;
-        gl::texture< DataType, Channels >* texture_;
-        
-    public:
-        destroy_texture_data_task(
-            // TODO: std::unique_ptr< gl::texture< DataType, Channels > > texture
-            gl::texture< DataType, Channels >* texture
-        ) : texture_{ texture }
-        {}
-        
-        task_flags_type flags() const override
-        {
-            return task_flag::gpu_thread;
-        }
-        
-        bool operator()() override;
-    };
 }
 
 
@@ -212,14 +223,9 @@ template<
 >::shared_data::~shared_data()
 {
     // The shared data being destroyed means that nothing refers to the texture
-    // anymore, including any tasks operating on it
-    std::unique_lock lock( data_mutex );
-    if( texture )
-    {
-        submit_task( std::make_unique<
-            destroy_texture_data_task< DataType, Channels >
-        >( texture ) );
-    }
+    // anymore, including any tasks operating on it; this may be on any thread,
+    // but the texture only queues its name for deletion
+    delete texture.load( std::memory_order_acquire );
 }
 
 
@@ -252,13 +258,10 @@ template<
     Channels
 >::operator bool() const
 {
-    if( shared_data_ )
-    {
-        std::unique_lock lock( shared_data_->data_mutex );
-        return static_cast< bool >( shared_data_->texture );
-    }
-    
-    return false;
+    return (
+        shared_data_
+        && shared_data_->texture.load( std::memory_order_acquire )
+    );
 }
 
 template<
@@ -276,10 +279,11 @@ template<
     
     if( shared_data_ )
     {
-        std::unique_lock lock( shared_data_->data_mutex );
-        if( shared_data_->texture )
+        if( auto const t = shared_data_->texture.load(
+            std::memory_order_acquire
+        ); t )
         {
-            return shared_data_->texture;
+            return t;
         }
     }
     
@@ -304,10 +308,11 @@ template<
     
     if( shared_data_ )
     {
-        std::unique_lock lock( shared_data_->data_mutex );
-        if( shared_data_->texture )
+        if( auto const t = shared_data_->texture.load(
+            std::memory_order_acquire
+        ); t )
         {
-            return shared_data_->texture;
+            return t;
         }
     }
     
@@ -336,16 +341,28 @@ template<
     
     ref_type ref;
     
-    ref.shared_data_ = std::make_shared< ref_type::shared_data >();
-    
-    submit_task( std::make_unique<
-        load_texture_file_task< DataType, Channels >
-    >(
-        ref.shared_data_,
-        std::move( filename ),
+    // Only the first reference to a file/settings combination loads it; any
+    // others share its data, even if the load hasn't finished yet
+    auto [ shared, needs_load ] = texture_cache<
+        typename ref_type::shared_data
+    >::instance().find_or_create( make_texture_cache_key(
+        filename,
         settings,
         flags
     ) );
+    ref.shared_data_ = std::move( shared );
+    
+    if( needs_load )
+    {
+        submit_task( std::make_unique<
+            load_texture_file_task< DataType, Channels >
+        >(
+            ref.shared_data_,
+            std::move( filename ),
+            settings,
+            flags
+        ) );
+    }
     
     return ref;
 }
@@ -361,33 +378,33 @@ template<
     Channels
 >::operator()()
 {
-    using namespace std::string_literals;
+    using format_traits = gl::texture_format_traits< DataType, Channels >;
     
-    SDL_Surface* sdl_surface = IMG_Load( filename_.c_str() );
-    if( !sdl_surface )
-    {
-        // TODO: graceful failure (just don't load)
-        throw std::runtime_error(
-            "failed to load texture \""s
-            + filename_.native()
-            + "\": "s
-            + IMG_GetError()
-        );
-    }
+    texture_data_source source = [
+        filename = filename_,
+        flags    = flags_,
+        settings = settings_
+    ](){
+        std::vector< gl::texture_upload_data > layers;
+        layers.push_back( load_texture_file(
+            filename,
+            flags,
+            settings,
+            format_traits::gl_internal_format
+        ) );
+        return layers;
+    };
     
-    using format_traits = gl::texture_format_traits< DataType, Channels >;
+    auto layers = source();
     
     submit_task( std::make_unique<
         upload_texture_data_task< DataType, Channels >
     >(
         shared_data_,
-        gl::process_texture_data(
-            sdl_surface,
-            flags_,
-            format_traits::gl_internal_format
-        ),
+        std::move( layers.front() ),
         settings_,
-        flags_
+        flags_,
+        source
     ) );
     
     return false;
@@ -401,31 +418,42 @@ template<
     Channels
 >::operator()()
 {
-    std::unique_lock lock( shared_data_->data_mutex );
+    if( !stream_ )
+    {
+        // Default texture construction is only accessible to this task, so
+        // this can't use `std::make_unique<>()`
+        texture_ = std::unique_ptr< gl::texture< DataType, Channels > >(
+            new gl::texture< DataType, Channels >(
+                gl::texture_shape_of( GL_TEXTURE_2D, upload_data_ )
+            )
+        );
+        stream_.emplace(
+            texture_->gl_texture_id(),
+            std::move( upload_data_ ),
+            settings_
+        );
+        stream_->target_level( initial_texture_level( *stream_ ) );
+    }
     
-    // shared_data_->texture = std::make_unique<
-    //     gl::texture< DataType, Channels >
-    // >();
-    shared_data_->texture = new gl::texture< DataType, Channels >();
+    // Requeue until the rest fits in a later frame's budget
+    if( !stream_->upload_some() )
+    {
+        return true;
+    }
     
-    upload_texture_data(
-        shared_data_->texture->gl_texture_id(),
-        std::move( upload_data_ ),
-        settings_
+    // Larger levels are streamed in by the residency manager once the texture
+    // is actually drawn
+    texture_residency::instance().add(
+        std::move( *stream_ ),
+        std::move( source_ )
+    );
+    stream_.reset();
+    
+    // Only publish the texture once its smallest levels are uploaded
+    shared_data_->texture.store(
+        texture_.release(),
+        std::memory_order_release
     );
     
-    return false;
-}
-
-template<
-    typename    DataType,
-    std::size_t Channels
-> bool JadeMatrix::yavsg::destroy_texture_data_task<
-    DataType,
-    Channels
->::operator()()
-{
-    // TODO: texture_ = nullptr;
-    delete texture_;
     return false;
 }
@@ -0,0 +1,124 @@
+#pragma once
+
+
+#include <yavsg/gl/texture_streaming.hpp>
+#include <yavsg/gl/texture_utilities.hpp>
+#include <yavsg/gl_wrap.hpp>
+
+#include <atomic>
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+#include <functional>
+#include <memory>       // shared_ptr
+#include <unordered_map>
+#include <vector>
+
+
+// Every texture & texture array loaded from a file is handed to the residency
+// manager once its smallest mip levels are uploaded.  From then on its larger
+// levels are only streamed in while it's actually being bound for drawing, &
+// only if they fit in the texture memory budget, freeing the largest levels of
+// the least-recently-used textures to make room.  Textures that haven't been
+// drawn in a while are the first to lose detail when the budget is exceeded,
+// but never their smallest level, so anything can always be drawn.
+//
+// Textures that can be loaded again from where they came from only keep the
+// data for levels that aren't resident; once an evicted level is needed
+// again, its data is reloaded on a task worker before it's streamed back in.
+//
+// Apart from the budget functions, all of this must be used on the GPU thread.
+
+
+namespace JadeMatrix::yavsg
+{
+    // A budget of 0 doesn't limit texture memory; defaults to 1 GiB
+    void set_texture_memory_budget( std::size_t bytes );
+    std::size_t texture_memory_budget();
+    
+    struct texture_residency_counters
+    {
+        std::size_t   resident_bytes  = 0;
+        std::size_t   textures        = 0;
+        std::uint64_t streamed_levels = 0;
+        std::uint64_t evicted_levels  = 0;
+    };
+    
+    // Size of the smallest level a texture is loaded with before it's first
+    // drawn; anything already smaller than this is loaded in full
+    constexpr std::size_t initial_texture_resolution = 64;
+    
+    // The level to stream in before a texture is first published
+    std::size_t initial_texture_level( gl::texture_upload_stream const& );
+    
+    // Loads a texture's data again, one element per layer like it was first
+    // streamed with; called on task workers
+    using texture_data_source = std::function<
+        std::vector< gl::texture_upload_data >()
+    >;
+    
+    class texture_residency
+    {
+    public:
+        static texture_residency& instance();
+        
+        // Takes over streaming the texture's remaining levels; without a
+        // source, the stream keeps its data for its whole lifetime
+        void add(
+            gl::texture_upload_stream&&,
+            texture_data_source source = {}
+        );
+        
+        // Must be called once the texture is deleted, before its name can be
+        // reused (see `gl::flush_deferred_deletions()`)
+        void remove( GLuint gl_id );
+        
+        // Marks the texture as used for the current frame; textures not
+        // managed here are ignored
+        void touch( GLuint gl_id );
+        
+        // Called once per frame; evicts levels if over budget, then streams in
+        // levels of recently-used textures with the upload budget left over
+        void update();
+        
+        texture_residency_counters counts() const;
+        
+    protected:
+        // Textures count as on screen if they were bound within this many
+        // frames, so a texture that flickers in & out of view doesn't thrash
+        static constexpr std::uint64_t recent_frames = 2;
+        
+        struct reloaded_data
+        {
+            std::atomic< bool >                    ready{ false };
+            std::vector< gl::texture_upload_data > layers;
+        };
+        
+        struct entry
+        {
+            gl::texture_upload_stream stream;
+            std::uint64_t             last_used;
+            texture_data_source       source;
+            
+            // Set while data is being reloaded
+            std::shared_ptr< reloaded_data > reload;
+        };
+        
+        std::unordered_map< GLuint, entry > entries_;
+        
+        // Starts past `recent_frames` so textures that have never been drawn
+        // (last used at frame 0) don't count as recently used
+        std::uint64_t frame_           = recent_frames + 1;
+        std::uint64_t streamed_levels_ = 0;
+        std::uint64_t evicted_levels_  = 0;
+        
+        texture_residency() = default;
+        
+        // Frees the largest level (or partial level) of the texture, returning
+        // the bytes freed, or 0 if only the smallest level is left
+        std::size_t evict_one_level( entry& );
+        
+        // Whether the data for that level is available to stream in, starting
+        // a reload if it isn't
+        bool reload_data( entry&, std::size_t level );
+    };
+}
@@ -36,7 +36,8 @@ JadeMatrix::yavsg::basic_postprocess_step::basic_postprocess_step(
     indices( {
         0, 1, 2,
         2, 3, 0
-    } )
+    } ),
+    uniforms( frame_uniforms::shared() )
 {
     postprocess_program.link_attribute< 0 >(
         shader_string_id::vertex_in_position,
@@ -49,6 +50,7 @@ JadeMatrix::yavsg::basic_postprocess_step::basic_postprocess_step(
     postprocess_program.bind_target< 0 >(
         shader_string_id::fragment_out_color
     );
+    frame_uniforms::bind_blocks( postprocess_program );
 }
 
 void JadeMatrix::yavsg::basic_postprocess_step::run(
@@ -77,14 +79,7 @@ void JadeMatrix::yavsg::basic_postprocess_step::run(
         1
     );
     
-    postprocess_program.set_uniform(
-        shader_string_id::framebuffer_target_width,
-        static_cast< GLfloat >( target.width() )
-    );
-    postprocess_program.set_uniform(
-        shader_string_id::framebuffer_target_height,
-        static_cast< GLfloat >( target.height() )
-    );
+    uniforms->update_framebuffer_target( target.width(), target.height() );
     
     postprocess_program.run( vertices, indices );
 }
\ No newline at end of file
@@ -37,7 +37,8 @@ JadeMatrix::yavsg::dof_postprocess_step::dof_postprocess_step(
         0, 1, 2,
         2, 3, 0
     } ),
-    scene_camera( sc )
+    scene_camera( sc ),
+    uniforms( frame_uniforms::shared() )
 {
     postprocess_program.link_attribute< 0 >(
         shader_string_id::vertex_in_position,
@@ -50,6 +51,7 @@ JadeMatrix::yavsg::dof_postprocess_step::dof_postprocess_step(
     postprocess_program.bind_target< 0 >(
         shader_string_id::fragment_out_color
     );
+    frame_uniforms::bind_blocks( postprocess_program );
 }
 
 void JadeMatrix::yavsg::dof_postprocess_step::run(
@@ -78,27 +80,15 @@ void JadeMatrix::yavsg::dof_postprocess_step::run(
         1
     );
     
-    postprocess_program.set_uniform(
-        shader_string_id::camera_point_near,
-        scene_camera.near_point()
-    );
-    postprocess_program.set_uniform(
-        shader_string_id::camera_point_focal,
-        scene_camera.focal_point()
-    );
-    postprocess_program.set_uniform(
-        shader_string_id::camera_point_far,
-        scene_camera.far_point()
+    // Normally already uploaded by the scene step, in which case this is a
+    // no-op
+    uniforms->update_camera(
+        scene_camera,
+          static_cast< GLfloat >( target.width () )
+        / static_cast< GLfloat >( target.height() )
     );
     
-    postprocess_program.set_uniform(
-        shader_string_id::framebuffer_target_width,
-        static_cast< GLfloat >( target.width() )
-    );
-    postprocess_program.set_uniform(
-        shader_string_id::framebuffer_target_height,
-        static_cast< GLfloat >( target.height() )
-    );
+    uniforms->update_framebuffer_target( target.width(), target.height() );
     
     postprocess_program.run( vertices, indices );
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include <yavsg/rendering/frame_uniforms.hpp>
+
+
+JadeMatrix::yavsg::frame_uniforms::frame_uniforms() :
+    camera_buffer_{ camera_block_binding },
+    framebuffer_target_buffer_{ framebuffer_target_block_binding }
+{}
+
+std::shared_ptr< JadeMatrix::yavsg::frame_uniforms >
+JadeMatrix::yavsg::frame_uniforms::shared()
+{
+    // Only ever accessed from the GPU thread
+    static std::weak_ptr< frame_uniforms > instance;
+    
+    auto pointer = instance.lock();
+    if( !pointer )
+    {
+        pointer  = std::make_shared< frame_uniforms >();
+        instance = pointer;
+    }
+    return pointer;
+}
+
+void JadeMatrix::yavsg::frame_uniforms::update_camera(
+    camera const& c,
+    GLfloat       aspect_ratio
+)
+{
+    camera_buffer_.update( camera_uniform_block{
+        c.view< GLfloat >(),
+        c.projection< GLfloat >( aspect_ratio ),
+        c.near_point(),
+        c.focal_point(),
+        c.far_point(),
+        0.0f
+    } );
+}
+
+void JadeMatrix::yavsg::frame_uniforms::update_framebuffer_target(
+    std::size_t width,
+    std::size_t height
+)
+{
+    framebuffer_target_buffer_.update( framebuffer_target_uniform_block{
+        static_cast< GLfloat >( width  ),
+        static_cast< GLfloat >( height ),
+        { 0.0f, 0.0f }
+    } );
+}
@@ -0,0 +1,140 @@
+#include <yavsg/rendering/mapped_file.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>    // std::filesystem::path support
+
+#include <fstream>
+#include <stdexcept>    // runtime_error
+#include <string_view>
+#include <utility>      // move, swap
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+    #define YAVSG_MAPPED_FILE_MMAP
+    #include <fcntl.h>      // open
+    #include <sys/mman.h>   // mmap, munmap
+    #include <sys/stat.h>   // fstat
+    #include <unistd.h>     // close
+#endif
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+}
+
+
+JadeMatrix::yavsg::mapped_file::mapped_file(
+    std::filesystem::path const& filename
+)
+{
+#ifdef YAVSG_MAPPED_FILE_MMAP
+    auto const fd = ::open( filename.c_str(), O_RDONLY );
+    if( fd == -1 )
+    {
+        throw std::runtime_error( fmt::format(
+            "could not open {}"sv,
+            filename
+        ) );
+    }
+    
+    struct stat file_stat;
+    if( ::fstat( fd, &file_stat ) == -1 )
+    {
+        ::close( fd );
+        throw std::runtime_error( fmt::format(
+            "could not stat {}"sv,
+            filename
+        ) );
+    }
+    size_ = static_cast< std::size_t >( file_stat.st_size );
+    
+    // Mapping zero bytes fails, but there's nothing to read anyways
+    if( size_ > 0 )
+    {
+        auto const mapping = ::mmap(
+            nullptr,
+            size_,
+            PROT_READ,
+            MAP_PRIVATE,
+            fd,
+            0
+        );
+        if( mapping == MAP_FAILED )
+        {
+            ::close( fd );
+            throw std::runtime_error( fmt::format(
+                "could not map {}"sv,
+                filename
+            ) );
+        }
+        data_ = static_cast< std::byte const* >( mapping );
+    }
+    
+    // The mapping keeps its own reference to the file
+    ::close( fd );
+#else
+    std::ifstream in( filename, std::ios_base::in | std::ios_base::binary );
+    if( !in.is_open() )
+    {
+        throw std::runtime_error( fmt::format(
+            "could not open {}"sv,
+            filename
+        ) );
+    }
+    
+    fallback_.resize( static_cast< std::size_t >(
+        std::filesystem::file_size( filename )
+    ) );
+    in.read(
+        reinterpret_cast< char* >( fallback_.data() ),
+        static_cast< std::streamsize >( fallback_.size() )
+    );
+    if( !in )
+    {
+        throw std::runtime_error( fmt::format(
+            "could not read {}"sv,
+            filename
+        ) );
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#endif
+}
+
+JadeMatrix::yavsg::mapped_file::mapped_file( mapped_file&& o ) :
+    fallback_( std::move( o.fallback_ ) )
+{
+    std::swap( data_, o.data_ );
+    std::swap( size_, o.size_ );
+}
+
+JadeMatrix::yavsg::mapped_file& JadeMatrix::yavsg::mapped_file::operator=(
+    mapped_file&& o
+)
+{
+    // The old mapping is released by `o`'s destructor
+    std::swap( data_    , o.data_     );
+    std::swap( size_    , o.size_     );
+    std::swap( fallback_, o.fallback_ );
+    return *this;
+}
+
+JadeMatrix::yavsg::mapped_file::~mapped_file()
+{
+#ifdef YAVSG_MAPPED_FILE_MMAP
+    if( data_ )
+    {
+        ::munmap( const_cast< std::byte* >( data_ ), size_ );
+    }
+#endif
+}
+
+std::byte const* JadeMatrix::yavsg::mapped_file::data() const
+{
+    return data_;
+}
+
+std::size_t JadeMatrix::yavsg::mapped_file::size() const
+{
+    return size_;
+}
@@ -0,0 +1,537 @@
+#include <yavsg/rendering/mesh_cache.hpp>
+
+#include <yavsg/logging.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>    // std::filesystem::path support
+
+#include <array>
+#include <cstdint>      // uint32_t, uint64_t, int64_t
+#include <cstring>      // memcpy
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <stdexcept>    // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error> // error_code
+#include <tuple>        // get, tuple_size_v, tuple_element_t
+#include <utility>      // move, swap, index_sequence
+#include <vector>
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+    
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    constexpr std::array< char, 8 > mesh_cache_identifier = {
+        'Y', 'A', 'V', 'S', 'G', 'M', 'S', 'H'
+    };
+    
+    // Increment whenever the layout of the file or how its contents are
+    // processed changes, so older caches get rebuilt:
+    //   2: indices & vertices are reordered by `mesh_optimization.hpp`
+    constexpr std::uint32_t mesh_cache_version    = 2;
+    constexpr std::uint32_t mesh_cache_endianness = 0x04030201;
+    
+    // Vertex & index blobs are aligned to this within the file; mappings are
+    // page-aligned, so they're aligned in memory too
+    constexpr std::size_t mesh_cache_blob_alignment = 16;
+    
+    struct mesh_cache_header
+    {
+        std::array< char, 8 > identifier;
+        std::uint32_t         endianness;
+        std::uint32_t         version;
+        std::uint32_t         vertex_layout;
+        std::uint32_t         dependency_count;
+        std::uint32_t         material_count;
+        std::uint32_t         group_count;
+        std::array< GLfloat, 3 > bounds_min;
+        std::array< GLfloat, 3 > bounds_max;
+        std::uint64_t         vertex_count;
+        std::uint64_t         vertex_offset;
+    };
+    
+    // Identifies the size & position of every attribute in a vertex, which
+    // depends on both the vertex type & the standard library's `std::tuple`
+    template< std::size_t... I > std::uint32_t vertex_layout_of(
+        std::index_sequence< I... >
+    )
+    {
+        // FNV-1a
+        std::uint32_t hash = 2166136261u;
+        auto const add = [ & ]( std::size_t value ){
+            hash ^= static_cast< std::uint32_t >( value );
+            hash *= 16777619u;
+        };
+        
+        // Only addresses are taken, so the vertex is never constructed
+        union storage_type
+        {
+            storage_type() {}
+            ~storage_type() {}
+            yavsg::scene::vertex_type vertex;
+        } const storage;
+        auto const& vertex = storage.vertex;
+        auto const  base   = reinterpret_cast< std::byte const* >( &vertex );
+        
+        add( mesh_cache_version );
+        add( sizeof( vertex ) );
+        ( (
+            add( static_cast< std::size_t >(
+                reinterpret_cast< std::byte const* >(
+                    &std::get< I >( vertex )
+                ) - base
+            ) ),
+            add( sizeof( std::tuple_element_t<
+                I,
+                yavsg::scene::vertex_type
+            > ) )
+        ), ... );
+        
+        return hash;
+    }
+    
+    std::uint32_t vertex_layout()
+    {
+        static auto const layout = vertex_layout_of(
+            std::make_index_sequence< std::tuple_size_v<
+                yavsg::scene::vertex_type
+            > >{}
+        );
+        return layout;
+    }
+    
+    bool is_compatible( mesh_cache_header const& header )
+    {
+        return (
+               header.identifier    == mesh_cache_identifier
+            && header.endianness    == mesh_cache_endianness
+            && header.version       == mesh_cache_version
+            && header.vertex_layout == vertex_layout()
+        );
+    }
+    
+    struct dependency_stamp
+    {
+        std::uint64_t size;
+        std::int64_t  modified;
+    };
+    
+    std::optional< dependency_stamp > stamp_of(
+        std::filesystem::path const& filename
+    )
+    {
+        std::error_code error;
+        auto const size = std::filesystem::file_size( filename, error );
+        if( error ) return std::nullopt;
+        auto const modified = std::filesystem::last_write_time(
+            filename,
+            error
+        );
+        if( error ) return std::nullopt;
+        
+        return dependency_stamp{
+            static_cast< std::uint64_t >( size ),
+            static_cast< std::int64_t >(
+                modified.time_since_epoch().count()
+            )
+        };
+    }
+    
+    // Bounds-checked sequential reads from a mapped cache
+    class cache_reader
+    {
+    public:
+        cache_reader( yavsg::mapped_file const& file ) : file_{ file } {}
+        
+        template< typename T > T read()
+        {
+            T value;
+            std::memcpy( &value, take( sizeof( T ) ), sizeof( T ) );
+            return value;
+        }
+        
+        std::string read_string()
+        {
+            auto const size = read< std::uint32_t >();
+            auto const data = take( size );
+            return std::string(
+                reinterpret_cast< char const* >( data ),
+                size
+            );
+        }
+        
+        // Returns the blob at `offset` without moving the read position
+        std::byte const* blob(
+            std::uint64_t offset,
+            std::uint64_t count,
+            std::size_t   element_size
+        ) const
+        {
+            if(
+                offset % mesh_cache_blob_alignment != 0
+                || offset > file_.size()
+                || count > ( file_.size() - offset ) / element_size
+            )
+            {
+                throw std::runtime_error( "blob outside of file" );
+            }
+            return file_.data() + offset;
+        }
+    
+    private:
+        yavsg::mapped_file const& file_;
+        std::size_t               offset_ = 0;
+        
+        std::byte const* take( std::size_t size )
+        {
+            if( size > file_.size() - offset_ )
+            {
+                throw std::runtime_error( "unexpected end of file" );
+            }
+            auto const data = file_.data() + offset_;
+            offset_ += size;
+            return data;
+        }
+    };
+    
+    // Appends to an in-memory image of a cache, which is written in one go
+    class cache_writer
+    {
+    public:
+        std::vector< std::byte > bytes;
+        
+        template< typename T > void write( T const& value )
+        {
+            auto const data = reinterpret_cast< std::byte const* >( &value );
+            bytes.insert( bytes.end(), data, data + sizeof( T ) );
+        }
+        
+        void write_string( std::string const& value )
+        {
+            write( static_cast< std::uint32_t >( value.size() ) );
+            auto const data = reinterpret_cast< std::byte const* >(
+                value.data()
+            );
+            bytes.insert( bytes.end(), data, data + value.size() );
+        }
+        
+        // Pads to the blob alignment & returns the blob's offset
+        std::uint64_t write_blob( void const* data, std::size_t size )
+        {
+            bytes.resize(
+                ( bytes.size() + mesh_cache_blob_alignment - 1 )
+                / mesh_cache_blob_alignment
+                * mesh_cache_blob_alignment,
+                std::byte{ 0 }
+            );
+            auto const offset = bytes.size();
+            auto const begin  = static_cast< std::byte const* >( data );
+            bytes.insert( bytes.end(), begin, begin + size );
+            return offset;
+        }
+        
+        template< typename T > void overwrite(
+            std::size_t offset,
+            T const&    value
+        )
+        {
+            std::memcpy( bytes.data() + offset, &value, sizeof( T ) );
+        }
+    };
+}
+
+
+// Cached mesh implementation //////////////////////////////////////////////////
+
+JadeMatrix::yavsg::cached_mesh::cached_mesh( mapped_file&& file ) :
+    file_( std::move( file ) )
+{
+    cache_reader reader{ file_ };
+    
+    auto const header = reader.read< mesh_cache_header >();
+    if( !is_compatible( header ) )
+    {
+        throw std::runtime_error( "not a compatible mesh cache" );
+    }
+    // Every material has exactly one index range, which the upload relies on
+    if( header.group_count != header.material_count )
+    {
+        throw std::runtime_error( "index range count doesn't match materials" );
+    }
+    
+    // Dependencies were already checked by `read_mesh_cache()`
+    for( std::uint32_t i = 0; i < header.dependency_count; ++i )
+    {
+        reader.read_string();
+        reader.read< dependency_stamp >();
+    }
+    
+    materials_.reserve( header.material_count );
+    for( std::uint32_t i = 0; i < header.material_count; ++i )
+    {
+        mesh_material_maps maps;
+        maps.color    = reader.read_string();
+        maps.normal   = reader.read_string();
+        maps.specular = reader.read_string();
+        materials_.push_back( std::move( maps ) );
+    }
+    
+    bounds_min_ = {
+        header.bounds_min[ 0 ],
+        header.bounds_min[ 1 ],
+        header.bounds_min[ 2 ]
+    };
+    bounds_max_ = {
+        header.bounds_max[ 0 ],
+        header.bounds_max[ 1 ],
+        header.bounds_max[ 2 ]
+    };
+    
+    vertices_ = reinterpret_cast< scene::vertex_type const* >( reader.blob(
+        header.vertex_offset,
+        header.vertex_count,
+        sizeof( scene::vertex_type )
+    ) );
+    vertex_count_ = static_cast< std::size_t >( header.vertex_count );
+    
+    indices_.reserve( header.group_count );
+    for( std::uint32_t i = 0; i < header.group_count; ++i )
+    {
+        auto const offset = reader.read< std::uint64_t >();
+        auto const count  = reader.read< std::uint64_t >();
+        index_range range{
+            reinterpret_cast< GLuint const* >( reader.blob(
+                offset,
+                count,
+                sizeof( GLuint )
+            ) ),
+            static_cast< std::size_t >( count )
+        };
+        
+        // Indices are used to read vertices straight from the mapping, e.g.
+        // for the occluder, so they all have to be in range
+        for( std::size_t j = 0; j < range.count; ++j )
+        {
+            if( range.indices[ j ] >= vertex_count_ )
+            {
+                throw std::runtime_error( "index outside of vertices" );
+            }
+        }
+        
+        indices_.push_back( range );
+    }
+}
+
+JadeMatrix::yavsg::vector< GLfloat, 3 > const&
+JadeMatrix::yavsg::cached_mesh::bounds_min() const
+{
+    return bounds_min_;
+}
+
+JadeMatrix::yavsg::vector< GLfloat, 3 > const&
+JadeMatrix::yavsg::cached_mesh::bounds_max() const
+{
+    return bounds_max_;
+}
+
+std::vector< JadeMatrix::yavsg::mesh_material_maps > const&
+JadeMatrix::yavsg::cached_mesh::materials() const
+{
+    return materials_;
+}
+
+JadeMatrix::yavsg::scene::vertex_type const*
+JadeMatrix::yavsg::cached_mesh::vertices() const
+{
+    return vertices_;
+}
+
+std::size_t JadeMatrix::yavsg::cached_mesh::vertex_count() const
+{
+    return vertex_count_;
+}
+
+std::vector< JadeMatrix::yavsg::cached_mesh::index_range > const&
+JadeMatrix::yavsg::cached_mesh::indices() const
+{
+    return indices_;
+}
+
+
+// Cache file functions ////////////////////////////////////////////////////////
+
+std::filesystem::path JadeMatrix::yavsg::mesh_cache_filename(
+    std::filesystem::path const& source_filename
+)
+{
+    auto filename = source_filename;
+    filename += ".yavsgmesh";
+    return filename;
+}
+
+std::optional< JadeMatrix::yavsg::cached_mesh >
+JadeMatrix::yavsg::read_mesh_cache(
+    std::filesystem::path const& cache_filename
+)
+{
+    std::error_code error;
+    if( !std::filesystem::exists( cache_filename, error ) )
+    {
+        return std::nullopt;
+    }
+    
+    try
+    {
+        mapped_file file{ cache_filename };
+        
+        // Check the dependencies before anything else is read
+        cache_reader reader{ file };
+        auto const header = reader.read< mesh_cache_header >();
+        if( !is_compatible( header ) )
+        {
+            log_.info(
+                "Mesh cache {} is from an incompatible build, rebuilding"sv,
+                cache_filename.string()
+            );
+            return std::nullopt;
+        }
+        for( std::uint32_t i = 0; i < header.dependency_count; ++i )
+        {
+            std::filesystem::path const dependency{ reader.read_string() };
+            auto const recorded = reader.read< dependency_stamp >();
+            auto const current  = stamp_of( dependency );
+            if(
+                !current
+                || current->size     != recorded.size
+                || current->modified != recorded.modified
+            )
+            {
+                log_.info(
+                    "Mesh cache {} is out of date with {}, rebuilding"sv,
+                    cache_filename.string(),
+                    dependency.string()
+                );
+                return std::nullopt;
+            }
+        }
+        
+        return cached_mesh{ std::move( file ) };
+    }
+    catch( std::exception const& e )
+    {
+        log_.warning(
+            "Ignoring unreadable mesh cache {}: {}"sv,
+            cache_filename.string(),
+            e.what()
+        );
+        return std::nullopt;
+    }
+}
+
+void JadeMatrix::yavsg::write_mesh_cache(
+    std::filesystem::path                const& cache_filename,
+    std::vector< std::filesystem::path > const& dependencies,
+    mesh_cache_contents                  const& contents
+)
+{
+    cache_writer writer;
+    
+    mesh_cache_header header{};
+    header.identifier       = mesh_cache_identifier;
+    header.endianness       = mesh_cache_endianness;
+    header.version          = mesh_cache_version;
+    header.vertex_layout    = vertex_layout();
+    header.dependency_count = static_cast< std::uint32_t >(
+        dependencies.size()
+    );
+    header.material_count   = static_cast< std::uint32_t >(
+        contents.materials.size()
+    );
+    header.group_count      = static_cast< std::uint32_t >(
+        contents.indices.size()
+    );
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+        header.bounds_min[ i ] = contents.bounds_min[ i ];
+        header.bounds_max[ i ] = contents.bounds_max[ i ];
+    }
+    header.vertex_count     = contents.vertices.size();
+    writer.write( header );
+    
+    for( auto const& dependency : dependencies )
+    {
+        auto const stamp = stamp_of( dependency );
+        if( !stamp )
+        {
+            throw std::runtime_error( fmt::format(
+                "could not stat mesh cache dependency {}"sv,
+                dependency.string()
+            ) );
+        }
+        writer.write_string( dependency.string() );
+        writer.write( *stamp );
+    }
+    
+    for( auto const& maps : contents.materials )
+    {
+        writer.write_string( maps.color    );
+        writer.write_string( maps.normal   );
+        writer.write_string( maps.specular );
+    }
+    
+    // The group table is filled in once the index blobs' offsets are known
+    auto const group_table_offset = writer.bytes.size();
+    for( auto const& group_indices : contents.indices )
+    {
+        writer.write( std::uint64_t{ 0 } );
+        writer.write( static_cast< std::uint64_t >( group_indices.size() ) );
+    }
+    
+    header.vertex_offset = writer.write_blob(
+        contents.vertices.data(),
+        contents.vertices.size() * sizeof( scene::vertex_type )
+    );
+    writer.overwrite( 0, header );
+    
+    for( std::size_t i = 0; i < contents.indices.size(); ++i )
+    {
+        auto const offset = writer.write_blob(
+            contents.indices[ i ].data(),
+            contents.indices[ i ].size() * sizeof( GLuint )
+        );
+        writer.overwrite(
+            group_table_offset + i * 2 * sizeof( std::uint64_t ),
+            offset
+        );
+    }
+    
+    // Written under a temporary name & moved into place so a reader never
+    // sees a partial cache
+    auto temporary_filename = cache_filename;
+    temporary_filename += ".tmp";
+    {
+        std::ofstream out(
+            temporary_filename,
+            std::ios_base::out | std::ios_base::binary | std::ios_base::trunc
+        );
+        out.write(
+            reinterpret_cast< char const* >( writer.bytes.data() ),
+            static_cast< std::streamsize >( writer.bytes.size() )
+        );
+        if( !out )
+        {
+            throw std::runtime_error( fmt::format(
+                "could not write mesh cache {}"sv,
+                temporary_filename.string()
+            ) );
+        }
+    }
+    std::filesystem::rename( temporary_filename, cache_filename );
+}
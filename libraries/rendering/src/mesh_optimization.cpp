@@ -0,0 +1,500 @@
+#include <yavsg/rendering/mesh_optimization.hpp>
+
+#include <algorithm>    // stable_sort, min
+#include <array>
+#include <cmath>        // pow, sqrt
+#include <limits>
+#include <numeric>      // iota
+#include <tuple>        // get
+#include <utility>      // move
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    constexpr auto unused_vertex = std::numeric_limits< GLuint >::max();
+    
+    // FIFO post-transform cache simulation; a vertex is in the cache if fewer
+    // than `cache_size` other vertices have been transformed since it was
+    class fifo_vertex_cache
+    {
+    public:
+        fifo_vertex_cache( std::size_t vertex_count, std::size_t cache_size ) :
+            cache_size_{ cache_size },
+            timestamps_( vertex_count, 0 ),
+            timestamp_ { cache_size + 1 }
+        {}
+        
+        // Returns whether the vertex had to be transformed
+        bool transform( GLuint vertex )
+        {
+            if( timestamp_ - timestamps_[ vertex ] > cache_size_ )
+            {
+                timestamps_[ vertex ] = timestamp_++;
+                return true;
+            }
+            return false;
+        }
+    
+    private:
+        std::size_t                cache_size_;
+        std::vector< std::size_t > timestamps_;
+        std::size_t                timestamp_;
+    };
+    
+    // Forsyth's scoring ///////////////////////////////////////////////////////
+    // See https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+    
+    constexpr std::size_t forsyth_cache_size  = 32;
+    constexpr std::size_t forsyth_max_valence = 32;
+    
+    struct forsyth_score_tables
+    {
+        std::array< float, forsyth_cache_size      > cache;
+        std::array< float, forsyth_max_valence + 1 > valence;
+        
+        forsyth_score_tables()
+        {
+            constexpr float cache_decay_power   = 1.5f;
+            constexpr float last_triangle_score = 0.75f;
+            constexpr float valence_boost_scale = 2.0f;
+            constexpr float valence_boost_power = 0.5f;
+            
+            for( std::size_t i = 0; i < cache.size(); ++i )
+            {
+                // The most recent triangle's vertices get a fixed score so
+                // the next triangle doesn't just reuse its newest edge
+                cache[ i ] = ( i < 3 ? last_triangle_score : std::pow(
+                    1.0f - static_cast< float >( i - 3 ) / static_cast< float >(
+                        forsyth_cache_size - 3
+                    ),
+                    cache_decay_power
+                ) );
+            }
+            
+            // Vertices with few triangles left are boosted so they're
+            // finished off rather than left to come back to later
+            valence[ 0 ] = 0.0f;
+            for( std::size_t i = 1; i < valence.size(); ++i )
+            {
+                valence[ i ] = valence_boost_scale * std::pow(
+                    static_cast< float >( i ),
+                    -valence_boost_power
+                );
+            }
+        }
+        
+        float score( int cache_position, std::size_t remaining ) const
+        {
+            if( remaining == 0 ) return -1.0f;
+            
+            auto score = valence[ std::min( remaining, forsyth_max_valence ) ];
+            if( cache_position >= 0 )
+            {
+                score += cache[ static_cast< std::size_t >( cache_position ) ];
+            }
+            return score;
+        }
+    };
+    
+    forsyth_score_tables const& forsyth_scores()
+    {
+        static forsyth_score_tables const tables;
+        return tables;
+    }
+    
+    std::array< GLfloat, 3 > position_of(
+        yavsg::scene::vertex_attributes_type const& v
+    )
+    {
+        auto const& position = std::get< 0 >( v );
+        return { position[ 0 ], position[ 1 ], position[ 2 ] };
+    }
+}
+
+
+// Statistics //////////////////////////////////////////////////////////////////
+
+double JadeMatrix::yavsg::vertex_cache_statistics::acmr() const
+{
+    return (
+        triangles == 0
+        ? 0.0
+        : static_cast< double >( transformed ) / static_cast< double >(
+            triangles
+        )
+    );
+}
+
+double JadeMatrix::yavsg::vertex_cache_statistics::atvr() const
+{
+    return (
+        vertices == 0
+        ? 0.0
+        : static_cast< double >( transformed ) / static_cast< double >(
+            vertices
+        )
+    );
+}
+
+JadeMatrix::yavsg::vertex_cache_statistics&
+JadeMatrix::yavsg::vertex_cache_statistics::operator+=(
+    vertex_cache_statistics const& o
+)
+{
+    triangles   += o.triangles;
+    vertices    += o.vertices;
+    transformed += o.transformed;
+    return *this;
+}
+
+JadeMatrix::yavsg::vertex_cache_statistics
+JadeMatrix::yavsg::analyze_vertex_cache(
+    std::vector< GLuint > const& indices,
+    std::size_t                  vertex_count,
+    std::size_t                  cache_size
+)
+{
+    vertex_cache_statistics statistics;
+    statistics.triangles = indices.size() / 3;
+    
+    fifo_vertex_cache    cache{ vertex_count, cache_size };
+    std::vector< bool > referenced( vertex_count, false );
+    for( auto index : indices )
+    {
+        if( cache.transform( index ) ) ++statistics.transformed;
+        if( !referenced[ index ] )
+        {
+            referenced[ index ] = true;
+            ++statistics.vertices;
+        }
+    }
+    
+    return statistics;
+}
+
+
+// Vertex cache optimization ///////////////////////////////////////////////////
+
+void JadeMatrix::yavsg::optimize_vertex_cache(
+    std::vector< GLuint >& indices,
+    std::size_t            vertex_count
+)
+{
+    auto const& scores         = forsyth_scores();
+    auto const  triangle_count = indices.size() / 3;
+    if( triangle_count == 0 ) return;
+    
+    // Triangles using each vertex; only the first `remaining[ v ]` of each
+    // vertex's list are still to be added
+    std::vector< std::size_t > remaining( vertex_count, 0 );
+    for( auto index : indices ) ++remaining[ index ];
+    
+    std::vector< std::size_t > adjacency_offsets( vertex_count + 1, 0 );
+    for( std::size_t v = 0; v < vertex_count; ++v )
+    {
+        adjacency_offsets[ v + 1 ] = adjacency_offsets[ v ] + remaining[ v ];
+    }
+    std::vector< std::size_t > adjacency( indices.size() );
+    {
+        auto fill = adjacency_offsets;
+        for( std::size_t i = 0; i < indices.size(); ++i )
+        {
+            adjacency[ fill[ indices[ i ] ]++ ] = i / 3;
+        }
+    }
+    
+    std::vector< float > vertex_scores( vertex_count );
+    for( std::size_t v = 0; v < vertex_count; ++v )
+    {
+        vertex_scores[ v ] = scores.score( -1, remaining[ v ] );
+    }
+    
+    std::vector< float > triangle_scores( triangle_count, 0.0f );
+    std::vector< bool  > triangle_added ( triangle_count, false );
+    for( std::size_t t = 0; t < triangle_count; ++t )
+    {
+        for( std::size_t c = 0; c < 3; ++c )
+        {
+            triangle_scores[ t ] += vertex_scores[ indices[ t * 3 + c ] ];
+        }
+    }
+    
+    std::vector< GLuint > output;
+    output.reserve( indices.size() );
+    
+    // Most recently used first; the extra room is for a new triangle's
+    // vertices before the oldest are pushed out
+    std::vector< GLuint > cache;
+    std::vector< GLuint > next_cache;
+    cache     .reserve( forsyth_cache_size + 3 );
+    next_cache.reserve( forsyth_cache_size + 3 );
+    
+    std::size_t best_triangle = 0;
+    std::size_t next_unadded  = 0;
+    
+    for( std::size_t added = 0; added < triangle_count; ++added )
+    {
+        triangle_added[ best_triangle ] = true;
+        
+        next_cache.clear();
+        for( std::size_t c = 0; c < 3; ++c )
+        {
+            auto const v = indices[ best_triangle * 3 + c ];
+            output.push_back( v );
+            
+            // Take the triangle out of the vertex's list of remaining ones
+            auto const begin = (
+                adjacency.begin()
+                + static_cast< std::ptrdiff_t >( adjacency_offsets[ v ] )
+            );
+            auto const end = begin + static_cast< std::ptrdiff_t >(
+                remaining[ v ]
+            );
+            std::iter_swap( std::find( begin, end, best_triangle ), end - 1 );
+            --remaining[ v ];
+            
+            if(
+                std::find( next_cache.begin(), next_cache.end(), v )
+                == next_cache.end()
+            )
+            {
+                next_cache.push_back( v );
+            }
+        }
+        for( auto v : cache )
+        {
+            if(
+                std::find( next_cache.begin(), next_cache.end(), v )
+                == next_cache.end()
+            )
+            {
+                next_cache.push_back( v );
+            }
+        }
+        std::swap( cache, next_cache );
+        
+        // Rescore everything whose cache position changed, including
+        // whatever fell out of the cache
+        for( std::size_t i = 0; i < cache.size(); ++i )
+        {
+            auto const v        = cache[ i ];
+            auto const position = (
+                i < forsyth_cache_size ? static_cast< int >( i ) : -1
+            );
+            auto const score = scores.score( position, remaining[ v ] );
+            auto const delta = score - vertex_scores[ v ];
+            vertex_scores[ v ] = score;
+            
+            auto const begin = adjacency_offsets[ v ];
+            for( auto a = begin; a < begin + remaining[ v ]; ++a )
+            {
+                triangle_scores[ adjacency[ a ] ] += delta;
+            }
+        }
+        
+        // Only once every score is up to date, find the best triangle that
+        // uses any of them
+        float best_score = -1.0f;
+        for( auto v : cache )
+        {
+            auto const begin = adjacency_offsets[ v ];
+            for( auto a = begin; a < begin + remaining[ v ]; ++a )
+            {
+                auto const t = adjacency[ a ];
+                if( triangle_scores[ t ] > best_score )
+                {
+                    best_score    = triangle_scores[ t ];
+                    best_triangle = t;
+                }
+            }
+        }
+        if( cache.size() > forsyth_cache_size )
+        {
+            cache.resize( forsyth_cache_size );
+        }
+        
+        // Nothing in the cache has triangles left, so start somewhere new
+        if( best_score < 0.0f )
+        {
+            while(
+                next_unadded < triangle_count
+                && triangle_added[ next_unadded ]
+            )
+            {
+                ++next_unadded;
+            }
+            best_triangle = next_unadded;
+        }
+    }
+    
+    indices = std::move( output );
+}
+
+
+// Overdraw optimization ///////////////////////////////////////////////////////
+
+void JadeMatrix::yavsg::optimize_overdraw(
+    std::vector< GLuint                        >      & indices,
+    std::vector< scene::vertex_attributes_type > const& vertices,
+    std::size_t                                         cache_size
+)
+{
+    auto const triangle_count = indices.size() / 3;
+    if( triangle_count == 0 ) return;
+    
+    // Clusters start wherever the cache was cold anyways, so reordering them
+    // doesn't cost any extra transforms
+    std::vector< std::size_t > cluster_starts;
+    {
+        fifo_vertex_cache cache{ vertices.size(), cache_size };
+        for( std::size_t t = 0; t < triangle_count; ++t )
+        {
+            std::size_t misses = 0;
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                if( cache.transform( indices[ t * 3 + c ] ) ) ++misses;
+            }
+            if( t == 0 || misses == 3 )
+            {
+                cluster_starts.push_back( t );
+            }
+        }
+    }
+    cluster_starts.push_back( triangle_count );
+    auto const cluster_count = cluster_starts.size() - 1;
+    if( cluster_count < 2 ) return;
+    
+    // Area-weighted centroid & normal of each cluster & the whole mesh
+    struct cluster_geometry
+    {
+        std::array< double, 3 > centroid{ 0.0, 0.0, 0.0 };
+        std::array< double, 3 > normal  { 0.0, 0.0, 0.0 };
+        double                  area = 0.0;
+    };
+    std::vector< cluster_geometry > clusters( cluster_count );
+    cluster_geometry                mesh;
+    
+    for( std::size_t c = 0; c < cluster_count; ++c )
+    {
+        auto& cluster = clusters[ c ];
+        for( auto t = cluster_starts[ c ]; t < cluster_starts[ c + 1 ]; ++t )
+        {
+            auto const p0 = position_of( vertices[ indices[ t * 3 + 0 ] ] );
+            auto const p1 = position_of( vertices[ indices[ t * 3 + 1 ] ] );
+            auto const p2 = position_of( vertices[ indices[ t * 3 + 2 ] ] );
+            
+            std::array< double, 3 > e1, e2;
+            for( std::size_t i = 0; i < 3; ++i )
+            {
+                e1[ i ] = static_cast< double >( p1[ i ] - p0[ i ] );
+                e2[ i ] = static_cast< double >( p2[ i ] - p0[ i ] );
+            }
+            std::array< double, 3 > const normal = {
+                e1[ 1 ] * e2[ 2 ] - e1[ 2 ] * e2[ 1 ],
+                e1[ 2 ] * e2[ 0 ] - e1[ 0 ] * e2[ 2 ],
+                e1[ 0 ] * e2[ 1 ] - e1[ 1 ] * e2[ 0 ]
+            };
+            auto const area = 0.5 * std::sqrt(
+                  normal[ 0 ] * normal[ 0 ]
+                + normal[ 1 ] * normal[ 1 ]
+                + normal[ 2 ] * normal[ 2 ]
+            );
+            
+            for( std::size_t i = 0; i < 3; ++i )
+            {
+                auto const centroid = static_cast< double >(
+                    p0[ i ] + p1[ i ] + p2[ i ]
+                ) / 3.0;
+                cluster.centroid[ i ] += centroid * area;
+                cluster.normal  [ i ] += normal[ i ];
+            }
+            cluster.area += area;
+        }
+        
+        for( std::size_t i = 0; i < 3; ++i )
+        {
+            mesh.centroid[ i ] += cluster.centroid[ i ];
+        }
+        mesh.area += cluster.area;
+    }
+    if( mesh.area <= 0.0 ) return;
+    
+    // Clusters facing outwards from the center of the mesh are drawn first,
+    // as they're the most likely to occlude the others
+    std::vector< double > sort_keys( cluster_count, 0.0 );
+    for( std::size_t c = 0; c < cluster_count; ++c )
+    {
+        auto const& cluster = clusters[ c ];
+        auto const  normal_length = std::sqrt(
+              cluster.normal[ 0 ] * cluster.normal[ 0 ]
+            + cluster.normal[ 1 ] * cluster.normal[ 1 ]
+            + cluster.normal[ 2 ] * cluster.normal[ 2 ]
+        );
+        if( cluster.area <= 0.0 || normal_length <= 0.0 ) continue;
+        
+        for( std::size_t i = 0; i < 3; ++i )
+        {
+            auto const offset = (
+                cluster.centroid[ i ] / cluster.area
+                - mesh.centroid[ i ] / mesh.area
+            );
+            sort_keys[ c ] += offset * cluster.normal[ i ] / normal_length;
+        }
+    }
+    
+    std::vector< std::size_t > order( cluster_count );
+    std::iota( order.begin(), order.end(), std::size_t{ 0 } );
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [ & ]( std::size_t lhs, std::size_t rhs ){
+            return sort_keys[ lhs ] > sort_keys[ rhs ];
+        }
+    );
+    
+    std::vector< GLuint > output;
+    output.reserve( indices.size() );
+    for( auto c : order )
+    {
+        output.insert(
+            output.end(),
+            indices.begin() + static_cast< std::ptrdiff_t >(
+                cluster_starts[ c ] * 3
+            ),
+            indices.begin() + static_cast< std::ptrdiff_t >(
+                cluster_starts[ c + 1 ] * 3
+            )
+        );
+    }
+    indices = std::move( output );
+}
+
+
+// Vertex fetch optimization ///////////////////////////////////////////////////
+
+void JadeMatrix::yavsg::optimize_vertex_fetch(
+    std::vector< scene::vertex_attributes_type >& vertices,
+    std::vector< std::vector< GLuint >          >& index_lists
+)
+{
+    std::vector< GLuint > remap( vertices.size(), unused_vertex );
+    std::vector< scene::vertex_attributes_type > reordered;
+    reordered.reserve( vertices.size() );
+    
+    for( auto& indices : index_lists )
+    {
+        for( auto& index : indices )
+        {
+            if( remap[ index ] == unused_vertex )
+            {
+                remap[ index ] = static_cast< GLuint >( reordered.size() );
+                reordered.push_back( vertices[ index ] );
+            }
+            index = remap[ index ];
+        }
+    }
+    
+    vertices = std::move( reordered );
+}
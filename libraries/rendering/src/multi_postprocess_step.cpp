@@ -28,7 +28,7 @@ in VERTEX_OUT
 
 uniform sampler2D framebuffer_source_color;
 uniform sampler2D framebuffer_source_depth;
-uniform struct
+layout( std140 ) uniform FRAMEBUFFER_TARGET
 {
     float width;
     float height;
@@ -70,7 +70,8 @@ JadeMatrix::yavsg::multi_postprocess_step::multi_postprocess_step(
             shaders_dir() / "postprocess.vert"sv
         ).id,
         generate_fragment_shader( function_names ).id
-    } }
+    } },
+    uniforms{ frame_uniforms::shared() }
 {
     multi_program.link_attribute< 0 >(
         shader_string_id::vertex_in_position,
@@ -83,6 +84,7 @@ JadeMatrix::yavsg::multi_postprocess_step::multi_postprocess_step(
     multi_program.bind_target< 0 >(
         shader_string_id::fragment_out_color
     );
+    frame_uniforms::bind_blocks( multi_program );
 }
 
 void JadeMatrix::yavsg::multi_postprocess_step::run(
@@ -110,14 +112,7 @@ void JadeMatrix::yavsg::multi_postprocess_step::run(
         1
     );
     
-    multi_program.set_uniform(
-        shader_string_id::framebuffer_target_width,
-        static_cast< GLfloat >( target.width() )
-    );
-    multi_program.set_uniform(
-        shader_string_id::framebuffer_target_height,
-        static_cast< GLfloat >( target.height() )
-    );
+    uniforms->update_framebuffer_target( target.width(), target.height() );
     
     multi_program.run( vertices, indices );
 }
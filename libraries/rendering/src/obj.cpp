@@ -3,16 +3,23 @@
 #include <yavsg/logging.hpp>
 #include <yavsg/math/quaternion.hpp>
 #include <yavsg/math/vector.hpp>
+#include <yavsg/rendering/mesh_optimization.hpp>
+#include <yavsg/rendering/obj_parser.hpp>
+#include <yavsg/tasking/parallel_for.hpp>
 
 #include <doctest/doctest.h>    // REQUIRE
 #include <fmt/format.h>
-#include <tiny_obj_loader.h>
 
 #include <algorithm>    // max
+#include <cstddef>      // size_t
 #include <exception>
+#include <functional>   // hash
 #include <limits>
 #include <string_view>
-#include <tuple>        // tie
+#include <string>
+#include <tuple>        // get, tie
+#include <unordered_map>
+#include <utility>      // move
 #include <vector>
 
 
@@ -21,6 +28,157 @@ namespace
     using namespace std::string_view_literals;
     
     auto const log_ = JadeMatrix::yavsg::log_handle();
+    
+    // Face corners referring to the same attributes are the same vertex;
+    // colors are per-position, so they don't need their own index
+    struct corner_key
+    {
+        int vertex_index;
+        int normal_index;
+        int texcoord_index;
+        
+        bool operator==( corner_key const& o ) const
+        {
+            return (
+                std::tie(   vertex_index,   normal_index,   texcoord_index )
+                == std::tie( o.vertex_index, o.normal_index, o.texcoord_index )
+            );
+        }
+    };
+    
+    struct corner_key_hash
+    {
+        std::size_t operator()( corner_key const& key ) const
+        {
+            std::hash< int > hash;
+            auto seed = hash( key.vertex_index );
+            for( auto index : { key.normal_index, key.texcoord_index } )
+            {
+                seed ^= (
+                    hash( index ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 )
+                );
+            }
+            return seed;
+        }
+    };
+}
+
+
+JadeMatrix::yavsg::obj_mesh JadeMatrix::yavsg::build_obj_mesh(
+    obj_data const& obj,
+    bool            deduplicate
+)
+{
+    obj_mesh mesh;
+    mesh.indices.resize( obj.materials.size(), {} );
+    // Start inverted so the first vertex sets both bounds, rather than them
+    // always including the origin
+    constexpr auto infinity = std::numeric_limits< GLfloat >::infinity();
+    GLfloat obj_max_x = -infinity;
+    GLfloat obj_min_x =  infinity;
+    GLfloat obj_max_y = -infinity;
+    GLfloat obj_min_y =  infinity;
+    GLfloat obj_max_z = -infinity;
+    GLfloat obj_min_z =  infinity;
+    std::unordered_map< corner_key, GLuint, corner_key_hash > corners;
+    // Missing normals & texture coordinates are left as zero
+    auto const attribute = [](
+        std::vector< GLfloat > const& values,
+        int                           index,
+        std::size_t                   stride,
+        std::size_t                   component
+    ){
+        if( index < 0 ) return 0.0f;
+        return values[
+            static_cast< std::size_t >( index ) * stride + component
+        ];
+    };
+    
+    for( std::size_t face = 0; face < obj.material_ids.size(); ++face )
+    {
+        REQUIRE( obj.material_ids[ face ] >= 0 );
+        REQUIRE( static_cast< std::size_t >(
+            obj.material_ids[ face ]
+        ) < mesh.indices.size() );
+        auto& group_indices = mesh.indices[
+            static_cast< std::size_t >( obj.material_ids[ face ] )
+        ];
+        
+        for( std::size_t i = 0; i < 3; ++i )
+        {
+            auto index = obj.indices[ 3 * face + i ];
+            ++mesh.corner_count;
+            
+            REQUIRE(
+                mesh.vertices.size()
+                <= std::numeric_limits< GLuint >::max()
+            );
+            auto const vertex_index = static_cast< GLuint >(
+                mesh.vertices.size()
+            );
+            if( deduplicate )
+            {
+                auto [ existing, inserted ] = corners.try_emplace(
+                    corner_key{
+                        index.vertex_index,
+                        index.normal_index,
+                        index.texcoord_index
+                    },
+                    vertex_index
+                );
+                if( !inserted )
+                {
+                    group_indices.push_back( existing->second );
+                    continue;
+                }
+            }
+            
+            auto vx = attribute( obj.vertices, index.vertex_index, 3, 0 );
+            auto vy = attribute( obj.vertices, index.vertex_index, 3, 1 );
+            auto vz = attribute( obj.vertices, index.vertex_index, 3, 2 );
+            
+            auto nx = attribute( obj.normals, index.normal_index, 3, 0 );
+            auto ny = attribute( obj.normals, index.normal_index, 3, 1 );
+            auto nz = attribute( obj.normals, index.normal_index, 3, 2 );
+            
+            // Colors use index.vertex_index
+            auto cr = attribute( obj.colors, index.vertex_index, 3, 0 );
+            auto cb = attribute( obj.colors, index.vertex_index, 3, 1 );
+            auto cg = attribute( obj.colors, index.vertex_index, 3, 2 );
+            
+            auto tu = attribute( obj.texcoords, index.texcoord_index, 2, 0 );
+            auto tv = attribute( obj.texcoords, index.texcoord_index, 2, 1 );
+            
+            mesh.vertices.push_back( {
+                { vx, vz, vy }, // { vx, vy, vz },
+                { nx, nz, ny },
+                { cr, cb, cg },
+                { tu, tv }
+            } );
+            group_indices.push_back( vertex_index );
+            
+            if( vx > obj_max_x ) obj_max_x = vx;
+            if( vx < obj_min_x ) obj_min_x = vx;
+            
+            if( vy > obj_max_y ) obj_max_y = vy;
+            if( vy < obj_min_y ) obj_min_y = vy;
+            
+            if( vz > obj_max_z ) obj_max_z = vz;
+            if( vz < obj_min_z ) obj_min_z = vz;
+        }
+    }
+    
+    // Empty meshes keep the default bounds at the origin
+    if( mesh.vertices.empty() )
+    {
+        return mesh;
+    }
+    
+    // Swizzled the same way as the vertices
+    mesh.bounds_min = { obj_min_x, obj_min_z, obj_min_y };
+    mesh.bounds_max = { obj_max_x, obj_max_z, obj_max_y };
+    
+    return mesh;
 }
 
 
@@ -34,158 +192,118 @@ bool JadeMatrix::yavsg::load_obj_task::operator()()
 {
     if( !upload_mode )
     {
-        tinyobj::attrib_t obj_attributes;
-        std::vector< tinyobj::shape_t    > obj_shapes;
-        std::vector< tinyobj::material_t > obj_materials;
-        
-        std::string tinyobj_error;
-        if( !tinyobj::LoadObj(
-            &obj_attributes,
-            &obj_shapes,
-            &obj_materials,
-            &tinyobj_error,
-            obj_filename.c_str(),
-            obj_mtl_directory.c_str()
-        ) )
+        auto const cache_filename = mesh_cache_filename( obj_filename );
+        cached = read_mesh_cache( cache_filename );
+        if( cached )
         {
-            throw std::runtime_error( fmt::format(
-                "unable to load OBJ file: {}"sv,
-                tinyobj_error
-            ) );
+            load_materials( cached->materials() );
+            log_.verbose(
+                "Loaded {} from cache: {} vertices"sv,
+                obj_filename.string(),
+                cached->vertex_count()
+            );
+            upload_mode = true;
+            return true;
         }
-        else if( !tinyobj_error.empty() )
+        
+        auto const obj = parse_obj_file( obj_filename, obj_mtl_directory );
+        
+        std::vector< mesh_material_maps > material_maps;
+        for( auto const& material : obj.materials )
         {
-            log_.split_on_newlines_as(
-                ext::log::level::warning,
-                tinyobj_error,
-                "tinyobj: {}"sv
-            );
+            material_maps.push_back( {
+                material.diffuse_texname,
+                material.bump_texname,
+                material.specular_texname
+            } );
         }
+        load_materials( material_maps );
+        
+        // Vertices are only packed once they've been reordered, as that needs
+        // their full-precision positions
+        auto mesh = build_obj_mesh( obj );
+        auto& vertices = mesh.vertices;
+        parsed.indices = std::move( mesh.indices );
         
-        // Load textures
-        for( auto& material : obj_materials )
+        std::size_t index_count = 0;
+        for( auto const& group_indices : parsed.indices )
         {
-            scene::material_description description;
-            
-            scene::material_texture_type color;
-            scene::material_texture_type normal;
-            scene::material_texture_type specular;
-            
-            for( auto& [ texture, filename, flags ] : {
-                std::tie( color   , material. diffuse_texname, gl::texture_flag::none         ),
-                std::tie( normal  , material.    bump_texname, gl::texture_flag::linear_input ),
-                std::tie( specular, material.specular_texname, gl::texture_flag::linear_input ),
-            } )
+            index_count += group_indices.size();
+        }
+        log_.verbose(
+            "Loaded {}: {} vertices for {} face corners, {} bytes of vertices "
+            "& {} bytes of indices"sv,
+            obj_filename.string(),
+            vertices.size(),
+            mesh.corner_count,
+            vertices.size() * sizeof( scene::vertex_type ),
+            index_count * sizeof( GLuint )
+        );
+        
+        // Each group is drawn separately, so each is optimized on its own;
+        // the vertices are shared, so they're reordered once for all of them
+        auto const analyze = [ & ](){
+            vertex_cache_statistics statistics;
+            for( auto const& group_indices : parsed.indices )
             {
-                if( filename.empty() ) continue;
-                
-                auto const texture_filename = obj_mtl_directory / filename;
-                
-                using settings = gl::texture_filter_settings;
-                
-                texture = scene::material_texture_type::from_file(
-                    texture_filename,
-                    {
-                        settings::magnify_mode::linear,
-                        settings::minify_mode::linear,
-                        settings::mipmap_type::linear,
-                    },
-                    flags
+                statistics += analyze_vertex_cache(
+                    group_indices,
+                    vertices.size()
                 );
             }
-            
-            materials.push_back( scene::material_description{
-                std::move( color    ),
-                std::move( normal   ),
-                std::move( specular )
-            } );
+            return statistics;
+        };
+        auto const unoptimized = analyze();
+        parallel_for(
+            parsed.indices.size(),
+            [ & ]( std::size_t i ){
+                optimize_vertex_cache(
+                    parsed.indices[ i ],
+                    vertices.size()
+                );
+                optimize_overdraw( parsed.indices[ i ], vertices );
+            }
+        );
+        optimize_vertex_fetch( vertices, parsed.indices );
+        auto const optimized = analyze();
+        log_.verbose(
+            "Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}"sv,
+            obj_filename.string(),
+            unoptimized.acmr(),
+            optimized  .acmr(),
+            unoptimized.atvr(),
+            optimized  .atvr()
+        );
+        
+        parsed.bounds_min = mesh.bounds_min;
+        parsed.bounds_max = mesh.bounds_max;
+        parsed.materials  = std::move( material_maps );
+        
+        parsed.vertices.reserve( vertices.size() );
+        for( auto const& vertex : vertices )
+        {
+            parsed.vertices.push_back( scene::pack_vertex(
+                vertex,
+                parsed.bounds_min,
+                parsed.bounds_max
+            ) );
         }
         
-        // Create vertices
-        indices.resize( materials.size(), {} );
-        obj_max_x = 0.0f;
-        obj_min_x = 0.0f;
-        obj_max_y = 0.0f;
-        obj_min_y = 0.0f;
-        obj_max_z = 0.0f;
-        obj_min_z = 0.0f;
-        for( auto& obj_shape : obj_shapes )
+        // Not being able to write the cache, e.g. if the mesh is somewhere
+        // read-only, only means it has to be parsed again next time
+        try
         {
-            std::size_t index_offset = 0;
-            
-            for(
-                std::size_t face = 0;
-                face < obj_shape.mesh.num_face_vertices.size();
-                ++face
-            )
-            {
-                auto vertex_count = obj_shape.mesh.num_face_vertices[ face ];
-                
-                // TODO: Suport other vertex counts
-                if( vertex_count != 3 )
-                {
-                    throw std::runtime_error( fmt::format(
-                        "vertex count = {}"sv,
-                        vertex_count
-                    ) );
-                }
-                
-                REQUIRE( obj_shape.mesh.material_ids[ face ] >= 0 );
-                REQUIRE( static_cast< decltype( indices )::size_type >(
-                    obj_shape.mesh.material_ids[ face ]
-                ) <= indices.size() );
-                auto& group_indices = indices[
-                    static_cast< decltype( indices )::size_type >(
-                        obj_shape.mesh.material_ids[ face ]
-                    )
-                ];
-                
-                for( size_t i = 0; i < vertex_count; ++i )
-                {
-                    auto index = obj_shape.mesh.indices[ index_offset + i ];
-                    
-                    auto vx = obj_attributes.vertices[ static_cast< std::size_t >( 3 * index.vertex_index + 0 ) ];
-                    auto vy = obj_attributes.vertices[ static_cast< std::size_t >( 3 * index.vertex_index + 1 ) ];
-                    auto vz = obj_attributes.vertices[ static_cast< std::size_t >( 3 * index.vertex_index + 2 ) ];
-                    
-                    auto nx = obj_attributes.normals[ static_cast< std::size_t >( 3 * index.normal_index + 0 ) ];
-                    auto ny = obj_attributes.normals[ static_cast< std::size_t >( 3 * index.normal_index + 1 ) ];
-                    auto nz = obj_attributes.normals[ static_cast< std::size_t >( 3 * index.normal_index + 2 ) ];
-                    
-                    // Colors use index.vertex_index
-                    auto cr = obj_attributes.colors[ static_cast< std::size_t >( 3 * index.vertex_index + 0 ) ];
-                    auto cb = obj_attributes.colors[ static_cast< std::size_t >( 3 * index.vertex_index + 1 ) ];
-                    auto cg = obj_attributes.colors[ static_cast< std::size_t >( 3 * index.vertex_index + 2 ) ];
-                    
-                    auto tu = obj_attributes.texcoords[ static_cast< std::size_t >( 2 * index.texcoord_index + 0 ) ];
-                    auto tv = obj_attributes.texcoords[ static_cast< std::size_t >( 2 * index.texcoord_index + 1 ) ];
-                    
-                    vertices.push_back( {
-                        { vx, vz, vy }, // { vx, vy, vz },
-                        { nx, nz, ny },
-                        { cr, cb, cg },
-                        { tu, tv }
-                    } );
-                    REQUIRE(
-                        vertices.size() - 1
-                        <= std::numeric_limits< GLuint >::max()
-                    );
-                    group_indices.push_back(
-                        static_cast< GLuint >( vertices.size() - 1 )
-                    );
-                    
-                    if( vx > obj_max_x ) obj_max_x = vx;
-                    if( vx < obj_min_x ) obj_min_x = vx;
-                    
-                    if( vy > obj_max_y ) obj_max_y = vy;
-                    if( vy < obj_min_y ) obj_min_y = vy;
-                    
-                    if( vz > obj_max_z ) obj_max_z = vz;
-                    if( vz < obj_min_z ) obj_min_z = vz;
-                }
-                
-                index_offset += vertex_count;
-            }
+            auto dependencies = obj.material_libraries;
+            dependencies.insert( dependencies.begin(), obj_filename );
+            write_mesh_cache( cache_filename, dependencies, parsed );
+        }
+        catch( std::exception const& e )
+        {
+            log_.warning(
+                "Could not write mesh cache for {}: {}"sv,
+                obj_filename.string(),
+                e.what()
+            );
         }
         
         upload_mode = true;
@@ -196,34 +314,147 @@ bool JadeMatrix::yavsg::load_obj_task::operator()()
     {
         using group_type = scene::render_object_manager_type::render_group;
         
+        // Cached meshes are uploaded straight from the mapped file
+        auto const& bounds_min = (
+            cached ? cached->bounds_min() : parsed.bounds_min
+        );
+        auto const& bounds_max = (
+            cached ? cached->bounds_max() : parsed.bounds_max
+        );
+        auto const vertex_data  = (
+            cached ? cached->vertices() : parsed.vertices.data()
+        );
+        auto const vertex_count = (
+            cached ? cached->vertex_count() : parsed.vertices.size()
+        );
+        std::vector< cached_mesh::index_range > group_ranges;
+        if( cached )
+        {
+            group_ranges = cached->indices();
+        }
+        else
+        {
+            for( auto const& group_indices : parsed.indices )
+            {
+                group_ranges.push_back( {
+                    group_indices.data(),
+                    group_indices.size()
+                } );
+            }
+        }
+        REQUIRE( group_ranges.size() == materials.size() );
+        
         auto objects_ref = object_manager.write();
         
-        GLfloat width  = obj_max_x - obj_min_x;
-        GLfloat length = obj_max_y - obj_min_y;
-        GLfloat height = obj_max_z - obj_min_z;
-        GLfloat scale  = 13.0f / std::max( { width, length, height } );
+        // Display scale as before the mesh bounds were tight: measured from
+        // bounds that include the origin, so models off to one side don't
+        // change size on screen
+        auto const extent = [ & ]( std::size_t i ){
+            return (
+                  std::max( bounds_max[ i ], 0.0f )
+                - std::min( bounds_min[ i ], 0.0f )
+            );
+        };
+        GLfloat scale = 13.0f / std::max( {
+            extent( 0 ),
+            extent( 1 ),
+            extent( 2 )
+        } );
         
         objects_ref->emplace_back(
             std::vector< group_type >{},
-            vertices,
+            scene::attribute_buffer_type{ vertex_data, vertex_count },
             vector< GLfloat, 3 >{ 0.0f, 0.0f, 0.0f },
             vector< GLfloat, 3 >{ scale, scale, scale },
             versor< GLfloat >::from_euler(
                 radians< GLfloat >( 0.0f ),
                 vector< GLfloat, 3 >{ 0.0f, 0.0f, 1.0f }
-            )
+            ),
+            bounds_min,
+            bounds_max
         );
         
+        if( occluder )
+        {
+            auto& occluder_vertices = objects_ref->back().occluder_vertices;
+            for( auto const& range : group_ranges )
+            {
+                for( std::size_t i = 0; i < range.count; ++i )
+                {
+                    occluder_vertices.push_back( scene::unpack_position(
+                        vertex_data[ range.indices[ i ] ],
+                        bounds_min,
+                        bounds_max
+                    ) );
+                }
+            }
+        }
+        
         auto& groups = objects_ref->back().render_groups;
         
         for( std::size_t i = 0; i < materials.size(); ++i )
         {
             groups.emplace_back(
                 std::move( materials[ i ] ),
-                indices[ i ]
+                gl::index_buffer{
+                    group_ranges[ i ].indices,
+                    group_ranges[ i ].count
+                }
             );
         }
         
         return false;
     }
 }
+
+
+void JadeMatrix::yavsg::load_obj_task::load_materials(
+    std::vector< mesh_material_maps > const& material_maps
+)
+{
+    // Load textures; each map type is packed into its own set of arrays,
+    // which are only loaded once every material has queued its maps
+    using settings = gl::texture_filter_settings;
+    settings const map_settings{
+        settings::magnify_mode::linear,
+        settings::minify_mode::linear,
+        settings::mipmap_type::linear,
+    };
+    scene::color_map_type   ::packer_type    color_packer{ map_settings };
+    scene::normal_map_type  ::packer_type   normal_packer{ map_settings };
+    scene::specular_map_type::packer_type specular_packer{ map_settings };
+    
+    for( auto const& maps : material_maps )
+    {
+        scene::material_description description;
+        
+        scene::color_map_type    color;
+        scene::normal_map_type   normal;
+        scene::specular_map_type specular;
+        
+        // Each map has its own texture type, so this can't just loop over
+        // them
+        auto const load_map = [ & ](
+            auto                 & texture,
+            auto                 & packer,
+            std::string     const& filename,
+            gl::texture_flags_type flags
+        ){
+            if( filename.empty() ) return;
+            texture = packer.add( obj_mtl_directory / filename, flags );
+        };
+        load_map( color   , color_packer   , maps.color   , gl::texture_flag::none         );
+        load_map( normal  , normal_packer  , maps.normal  , gl::texture_flag::linear_input );
+        load_map( specular, specular_packer, maps.specular, gl::texture_flag::linear_input );
+        
+        materials.push_back( scene::material_description{
+            std::move( color    ),
+            std::move( normal   ),
+            std::move( specular )
+        } );
+    }
+    
+    color_packer   .submit();
+    normal_packer  .submit();
+    specular_packer.submit();
+}
@@ -0,0 +1,742 @@
+#include <yavsg/rendering/obj_parser.hpp>
+
+#include <yavsg/logging.hpp>
+#include <yavsg/rendering/mapped_file.hpp>
+#include <yavsg/tasking/parallel_for.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>    // std::filesystem::path support
+
+#include <algorithm>    // min, copy, find
+#include <array>
+#include <cmath>        // pow
+#include <cstddef>      // size_t, ptrdiff_t
+#include <cstdint>      // uint8_t, uint64_t
+#include <exception>
+#include <limits>
+#include <map>
+#include <stdexcept>    // runtime_error
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+    
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    // Chunks are cut at the first line break after this many bytes
+    constexpr std::size_t obj_chunk_size = 4 * 1024 * 1024;
+    
+    // Powers of ten that are exact in a `double`
+    constexpr std::array< double, 23 > exact_powers_of_ten = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    
+    // Parsing of a single line, which the cursor never moves past ////////////
+    
+    class line_cursor
+    {
+    public:
+        line_cursor( char const* begin, char const* end ) :
+            position_{ begin },
+            end_     { end   }
+        {}
+        
+        bool at_end() const { return position_ == end_; }
+        
+        void skip_spaces()
+        {
+            while( position_ != end_ && is_space( *position_ ) )
+            {
+                ++position_;
+            }
+        }
+        
+        // Skips spaces & returns whether there's anything after them
+        bool more()
+        {
+            skip_spaces();
+            return !at_end();
+        }
+        
+        bool consume( char c )
+        {
+            if( position_ != end_ && *position_ == c )
+            {
+                ++position_;
+                return true;
+            }
+            return false;
+        }
+        
+        // The next run of non-space characters
+        std::string_view word()
+        {
+            skip_spaces();
+            auto const begin = position_;
+            while( position_ != end_ && !is_space( *position_ ) )
+            {
+                ++position_;
+            }
+            return { begin, static_cast< std::size_t >( position_ - begin ) };
+        }
+        
+        // Everything left on the line, without surrounding spaces
+        std::string_view rest()
+        {
+            skip_spaces();
+            auto last = end_;
+            while( last != position_ && is_space( last[ -1 ] ) )
+            {
+                --last;
+            }
+            std::string_view const value{
+                position_,
+                static_cast< std::size_t >( last - position_ )
+            };
+            position_ = end_;
+            return value;
+        }
+        
+        // Decimal floats with optional sign, fraction, & exponent; the
+        // mantissa is accumulated exactly & scaled once, which is as accurate
+        // as `strtof()` for anything a mesh exporter writes
+        GLfloat parse_float()
+        {
+            skip_spaces();
+            
+            auto const negative = consume( '-' );
+            if( !negative ) consume( '+' );
+            
+            constexpr auto max_mantissa = (
+                ( std::numeric_limits< std::uint64_t >::max() - 9 ) / 10
+            );
+            
+            std::uint64_t mantissa   = 0;
+            int           exponent   = 0;
+            bool          any_digits = false;
+            
+            auto const add_digit = [ & ]( char digit ){
+                any_digits = true;
+                if( mantissa < max_mantissa )
+                {
+                    mantissa = mantissa * 10 + static_cast< std::uint64_t >(
+                        digit - '0'
+                    );
+                    return true;
+                }
+                return false;
+            };
+            
+            while( position_ != end_ && is_digit( *position_ ) )
+            {
+                // Digits that don't fit only scale the value
+                if( !add_digit( *position_ ) ) ++exponent;
+                ++position_;
+            }
+            if( consume( '.' ) )
+            {
+                while( position_ != end_ && is_digit( *position_ ) )
+                {
+                    if( add_digit( *position_ ) ) --exponent;
+                    ++position_;
+                }
+            }
+            if( !any_digits )
+            {
+                throw std::runtime_error( "expected a number" );
+            }
+            
+            if( consume( 'e' ) || consume( 'E' ) )
+            {
+                auto const exponent_negative = consume( '-' );
+                if( !exponent_negative ) consume( '+' );
+                int written_exponent = 0;
+                while( position_ != end_ && is_digit( *position_ ) )
+                {
+                    if( written_exponent < 10000 )
+                    {
+                        written_exponent = written_exponent * 10 + (
+                            *position_ - '0'
+                        );
+                    }
+                    ++position_;
+                }
+                exponent += (
+                    exponent_negative ? -written_exponent : written_exponent
+                );
+            }
+            
+            auto value = static_cast< double >( mantissa );
+            if( exponent < 0 && -exponent < 23 )
+            {
+                value /= exact_powers_of_ten[
+                    static_cast< std::size_t >( -exponent )
+                ];
+            }
+            else if( exponent >= 0 && exponent < 23 )
+            {
+                value *= exact_powers_of_ten[
+                    static_cast< std::size_t >( exponent )
+                ];
+            }
+            else
+            {
+                value *= std::pow( 10.0, exponent );
+            }
+            
+            return static_cast< GLfloat >( negative ? -value : value );
+        }
+        
+        int parse_int()
+        {
+            auto const negative = consume( '-' );
+            if( !negative ) consume( '+' );
+            
+            if( position_ == end_ || !is_digit( *position_ ) )
+            {
+                throw std::runtime_error( "expected an index" );
+            }
+            long value = 0;
+            while( position_ != end_ && is_digit( *position_ ) )
+            {
+                value = value * 10 + ( *position_ - '0' );
+                if( value > std::numeric_limits< int >::max() )
+                {
+                    throw std::runtime_error( "index out of range" );
+                }
+                ++position_;
+            }
+            return static_cast< int >( negative ? -value : value );
+        }
+    
+    private:
+        char const* position_;
+        char const* end_;
+        
+        static bool is_space( char c )
+        {
+            return c == ' ' || c == '\t';
+        }
+        
+        static bool is_digit( char c )
+        {
+            return c >= '0' && c <= '9';
+        }
+    };
+    
+    // Per-chunk results //////////////////////////////////////////////////////
+    
+    // Which of a corner's indices are relative (negative in the file) & so
+    // still need the counts from earlier chunks added
+    constexpr std::uint8_t relative_vertex   = 0x01 << 0;
+    constexpr std::uint8_t relative_normal   = 0x01 << 1;
+    constexpr std::uint8_t relative_texcoord = 0x01 << 2;
+    
+    // Material IDs before a chunk's first `usemtl` carry on from the chunk
+    // before it
+    constexpr int inherited_material = -2;
+    
+    struct obj_chunk
+    {
+        char const* begin;
+        char const* end;
+        
+        std::vector< GLfloat          > vertices;
+        std::vector< GLfloat          > colors;
+        std::vector< GLfloat          > normals;
+        std::vector< GLfloat          > texcoords;
+        std::vector< yavsg::obj_index > indices;
+        std::vector< std::uint8_t     > relative;
+        
+        // Chunk-local IDs into `material_names`, or `inherited_material`
+        std::vector< int              > material_ids;
+        std::vector< std::string      > material_names;
+        std::vector< std::string      > material_libraries;
+    };
+    
+    // Converts a one-based or relative OBJ index to a zero-based one, which
+    // for relative indices is still relative to the start of the chunk
+    int chunk_index(
+        int           index,
+        std::size_t   count,
+        std::uint8_t  relative_flag,
+        std::uint8_t& relative
+    )
+    {
+        if( index > 0 )
+        {
+            return index - 1;
+        }
+        else if( index < 0 )
+        {
+            relative |= relative_flag;
+            return static_cast< int >( count ) + index;
+        }
+        throw std::runtime_error( "index of 0" );
+    }
+    
+    void parse_face(
+        line_cursor                    & line,
+        obj_chunk                      & chunk,
+        std::vector< yavsg::obj_index >& polygon,
+        std::vector< std::uint8_t     >& polygon_relative
+    )
+    {
+        polygon.clear();
+        polygon_relative.clear();
+        
+        while( line.more() )
+        {
+            yavsg::obj_index index{ -1, -1, -1 };
+            std::uint8_t     relative = 0;
+            
+            index.vertex_index = chunk_index(
+                line.parse_int(),
+                chunk.vertices.size() / 3,
+                relative_vertex,
+                relative
+            );
+            if( line.consume( '/' ) )
+            {
+                if( !line.consume( '/' ) )
+                {
+                    index.texcoord_index = chunk_index(
+                        line.parse_int(),
+                        chunk.texcoords.size() / 2,
+                        relative_texcoord,
+                        relative
+                    );
+                    if( !line.consume( '/' ) )
+                    {
+                        polygon.push_back( index );
+                        polygon_relative.push_back( relative );
+                        continue;
+                    }
+                }
+                index.normal_index = chunk_index(
+                    line.parse_int(),
+                    chunk.normals.size() / 3,
+                    relative_normal,
+                    relative
+                );
+            }
+            
+            polygon.push_back( index );
+            polygon_relative.push_back( relative );
+        }
+        
+        if( polygon.size() < 3 )
+        {
+            throw std::runtime_error( "face with fewer than 3 corners" );
+        }
+        
+        auto const material = (
+            chunk.material_names.empty()
+            ? inherited_material
+            : static_cast< int >( chunk.material_names.size() - 1 )
+        );
+        for( std::size_t i = 1; i + 1 < polygon.size(); ++i )
+        {
+            for( auto corner : { std::size_t{ 0 }, i, i + 1 } )
+            {
+                chunk.indices .push_back( polygon         [ corner ] );
+                chunk.relative.push_back( polygon_relative[ corner ] );
+            }
+            chunk.material_ids.push_back( material );
+        }
+    }
+    
+    void parse_chunk( obj_chunk& chunk )
+    {
+        // Reused between faces
+        std::vector< yavsg::obj_index > polygon;
+        std::vector< std::uint8_t     > polygon_relative;
+        
+        for( auto line_begin = chunk.begin; line_begin != chunk.end; )
+        {
+            auto line_end = std::find( line_begin, chunk.end, '\n' );
+            auto next     = ( line_end == chunk.end ? line_end : line_end + 1 );
+            if( line_end != line_begin && line_end[ -1 ] == '\r' ) --line_end;
+            
+            line_cursor line{ line_begin, line_end };
+            auto const keyword = line.word();
+            
+            try
+            {
+                if( keyword == "v"sv )
+                {
+                    for( int i = 0; i < 3; ++i )
+                    {
+                        chunk.vertices.push_back( line.parse_float() );
+                    }
+                    // Vertex colors are an unofficial extension & need all
+                    // three values; a lone fourth value is the standard (w)
+                    // weight, which is ignored
+                    float       rgb[ 3 ];
+                    std::size_t rgb_count = 0;
+                    while( rgb_count < 3 && line.more() )
+                    {
+                        rgb[ rgb_count++ ] = line.parse_float();
+                    }
+                    if( rgb_count == 3 )
+                    {
+                        chunk.colors.insert( chunk.colors.end(), rgb, rgb + 3 );
+                    }
+                    else
+                    {
+                        chunk.colors.insert( chunk.colors.end(), 3, 1.0f );
+                    }
+                }
+                else if( keyword == "vn"sv )
+                {
+                    for( int i = 0; i < 3; ++i )
+                    {
+                        chunk.normals.push_back( line.parse_float() );
+                    }
+                }
+                else if( keyword == "vt"sv )
+                {
+                    // A missing v coordinate defaults to 0, & any third (w)
+                    // coordinate is ignored
+                    chunk.texcoords.push_back( line.parse_float() );
+                    chunk.texcoords.push_back(
+                        line.more() ? line.parse_float() : 0.0f
+                    );
+                }
+                else if( keyword == "f"sv )
+                {
+                    parse_face( line, chunk, polygon, polygon_relative );
+                }
+                else if( keyword == "usemtl"sv )
+                {
+                    chunk.material_names.emplace_back( line.rest() );
+                }
+                else if( keyword == "mtllib"sv )
+                {
+                    while( line.more() )
+                    {
+                        chunk.material_libraries.emplace_back( line.word() );
+                    }
+                }
+            }
+            catch( std::runtime_error const& e )
+            {
+                throw std::runtime_error( fmt::format(
+                    "{} in \"{}\""sv,
+                    e.what(),
+                    std::string_view{
+                        line_begin,
+                        static_cast< std::size_t >( line_end - line_begin )
+                    }
+                ) );
+            }
+            
+            line_begin = next;
+        }
+    }
+    
+    // Material libraries //////////////////////////////////////////////////////
+    
+    // Texture options (e.g. `-bm 1.0`) come before the filename, so only the
+    // last word is used
+    std::string texture_filename( line_cursor& line )
+    {
+        std::string_view filename;
+        while( line.more() )
+        {
+            filename = line.word();
+        }
+        return std::string{ filename };
+    }
+    
+    void parse_mtl_file(
+        std::filesystem::path        const& filename,
+        std::vector< yavsg::obj_material >& materials
+    )
+    {
+        yavsg::mapped_file const file{ filename };
+        auto const begin = reinterpret_cast< char const* >( file.data() );
+        auto const end   = begin + file.size();
+        
+        yavsg::obj_material* material = nullptr;
+        
+        for( auto line_begin = begin; line_begin != end; )
+        {
+            auto line_end = std::find( line_begin, end, '\n' );
+            auto next     = ( line_end == end ? line_end : line_end + 1 );
+            if( line_end != line_begin && line_end[ -1 ] == '\r' ) --line_end;
+            
+            line_cursor line{ line_begin, line_end };
+            auto const keyword = line.word();
+            
+            if( keyword == "newmtl"sv )
+            {
+                material = &materials.emplace_back();
+                material->name = line.rest();
+            }
+            else if( material && keyword == "map_Kd"sv )
+            {
+                material->diffuse_texname = texture_filename( line );
+            }
+            else if(
+                material && (
+                       keyword == "map_bump"sv
+                    || keyword == "map_Bump"sv
+                    || keyword == "bump"sv
+                )
+            )
+            {
+                material->bump_texname = texture_filename( line );
+            }
+            else if( material && keyword == "map_Ks"sv )
+            {
+                material->specular_texname = texture_filename( line );
+            }
+            
+            line_begin = next;
+        }
+    }
+}
+
+
+JadeMatrix::yavsg::obj_data JadeMatrix::yavsg::parse_obj_file(
+    std::filesystem::path const& obj_filename,
+    std::filesystem::path const& mtl_directory
+)
+{
+    mapped_file const file{ obj_filename };
+    auto const begin = reinterpret_cast< char const* >( file.data() );
+    auto const end   = begin + file.size();
+    
+    // Split into chunks at line boundaries
+    std::vector< obj_chunk > chunks;
+    for( auto chunk_begin = begin; chunk_begin != end; )
+    {
+        auto chunk_end = chunk_begin + std::min(
+            obj_chunk_size,
+            static_cast< std::size_t >( end - chunk_begin )
+        );
+        chunk_end = std::find( chunk_end, end, '\n' );
+        if( chunk_end != end ) ++chunk_end;
+        
+        auto& chunk = chunks.emplace_back();
+        chunk.begin = chunk_begin;
+        chunk.end   = chunk_end;
+        
+        chunk_begin = chunk_end;
+    }
+    
+    try
+    {
+        parallel_for( chunks.size(), [ & ]( std::size_t i ){
+            parse_chunk( chunks[ i ] );
+        } );
+    }
+    catch( std::runtime_error const& e )
+    {
+        throw std::runtime_error( fmt::format(
+            "unable to load OBJ file {}: {}"sv,
+            obj_filename.string(),
+            e.what()
+        ) );
+    }
+    
+    obj_data data;
+    
+    // Material libraries are small, so they're just read in order
+    for( auto const& chunk : chunks )
+    {
+        for( auto const& library : chunk.material_libraries )
+        {
+            auto const& filename = data.material_libraries.emplace_back(
+                mtl_directory / library
+            );
+            try
+            {
+                parse_mtl_file( filename, data.materials );
+            }
+            catch( std::exception const& e )
+            {
+                log_.warning(
+                    "Skipping material library {}: {}"sv,
+                    filename.string(),
+                    e.what()
+                );
+            }
+        }
+    }
+    
+    std::map< std::string_view, int > material_ids;
+    for( std::size_t i = 0; i < data.materials.size(); ++i )
+    {
+        // Like tinyobjloader, later definitions take precedence
+        material_ids[ data.materials[ i ].name ] = static_cast< int >( i );
+    }
+    
+    // Work out where each chunk's data goes & what its chunk-local material
+    // IDs map to
+    struct chunk_offsets
+    {
+        std::size_t vertices;
+        std::size_t normals;
+        std::size_t texcoords;
+        std::size_t indices;
+        std::size_t faces;
+        int         inherited_material;
+        std::vector< int > material_ids;
+    };
+    std::vector< chunk_offsets > offsets;
+    offsets.reserve( chunks.size() );
+    {
+        chunk_offsets next{ 0, 0, 0, 0, 0, -1, {} };
+        for( auto const& chunk : chunks )
+        {
+            auto& chunk_offset = offsets.emplace_back( next );
+            for( auto const& name : chunk.material_names )
+            {
+                auto found = material_ids.find( name );
+                if( found == material_ids.end() )
+                {
+                    log_.warning(
+                        "Material {} used by {} not found"sv,
+                        name,
+                        obj_filename.string()
+                    );
+                }
+                chunk_offset.material_ids.push_back(
+                    found == material_ids.end() ? -1 : found->second
+                );
+            }
+            
+            next.vertices  += chunk.vertices .size();
+            next.normals   += chunk.normals  .size();
+            next.texcoords += chunk.texcoords.size();
+            next.indices   += chunk.indices  .size();
+            next.faces     += chunk.material_ids.size();
+            if( !chunk_offset.material_ids.empty() )
+            {
+                next.inherited_material = chunk_offset.material_ids.back();
+            }
+        }
+        
+        if(
+               next.vertices  / 3 > std::numeric_limits< int >::max()
+            || next.normals   / 3 > std::numeric_limits< int >::max()
+            || next.texcoords / 2 > std::numeric_limits< int >::max()
+        )
+        {
+            throw std::runtime_error( fmt::format(
+                "OBJ file {} has too many attributes"sv,
+                obj_filename.string()
+            ) );
+        }
+        
+        data.vertices    .resize( next.vertices  );
+        data.colors      .resize( next.vertices  );
+        data.normals     .resize( next.normals   );
+        data.texcoords   .resize( next.texcoords );
+        data.indices     .resize( next.indices   );
+        data.material_ids.resize( next.faces     );
+    }
+    
+    // Merge, resolving relative indices & inherited materials
+    parallel_for( chunks.size(), [ & ]( std::size_t c ){
+        auto const& chunk  = chunks [ c ];
+        auto const& offset = offsets[ c ];
+        
+        std::copy(
+            chunk.vertices.begin(),
+            chunk.vertices.end(),
+            data.vertices.begin() + static_cast< std::ptrdiff_t >(
+                offset.vertices
+            )
+        );
+        std::copy(
+            chunk.colors.begin(),
+            chunk.colors.end(),
+            data.colors.begin() + static_cast< std::ptrdiff_t >(
+                offset.vertices
+            )
+        );
+        std::copy(
+            chunk.normals.begin(),
+            chunk.normals.end(),
+            data.normals.begin() + static_cast< std::ptrdiff_t >(
+                offset.normals
+            )
+        );
+        std::copy(
+            chunk.texcoords.begin(),
+            chunk.texcoords.end(),
+            data.texcoords.begin() + static_cast< std::ptrdiff_t >(
+                offset.texcoords
+            )
+        );
+        
+        auto const vertex_base   = static_cast< int >( offset.vertices  / 3 );
+        auto const normal_base   = static_cast< int >( offset.normals   / 3 );
+        auto const texcoord_base = static_cast< int >( offset.texcoords / 2 );
+        for( std::size_t i = 0; i < chunk.indices.size(); ++i )
+        {
+            auto       index    = chunk.indices [ i ];
+            auto const relative = chunk.relative[ i ];
+            if( relative & relative_vertex )
+            {
+                index.vertex_index += vertex_base;
+            }
+            if( relative & relative_normal )
+            {
+                index.normal_index += normal_base;
+            }
+            if( relative & relative_texcoord )
+            {
+                index.texcoord_index += texcoord_base;
+            }
+            data.indices[ offset.indices + i ] = index;
+        }
+        
+        for( std::size_t i = 0; i < chunk.material_ids.size(); ++i )
+        {
+            auto const id = chunk.material_ids[ i ];
+            data.material_ids[ offset.faces + i ] = (
+                id == inherited_material
+                ? offset.inherited_material
+                : offset.material_ids[ static_cast< std::size_t >( id ) ]
+            );
+        }
+    } );
+    
+    // Out-of-range indices would otherwise only show up when building
+    // vertices
+    auto const vertex_count   = static_cast< int >( data.vertices.size() / 3 );
+    auto const normal_count   = static_cast< int >( data.normals.size() / 3 );
+    auto const texcoord_count = static_cast< int >(
+        data.texcoords.size() / 2
+    );
+    for( auto const& index : data.indices )
+    {
+        if(
+               index.vertex_index   <  0
+            || index.vertex_index   >= vertex_count
+            || index.normal_index   <  -1
+            || index.normal_index   >= normal_count
+            || index.texcoord_index <  -1
+            || index.texcoord_index >= texcoord_count
+        )
+        {
+            throw std::runtime_error( fmt::format(
+                "OBJ file {} has a face index out of range"sv,
+                obj_filename.string()
+            ) );
+        }
+    }
+    
+    return data;
+}
@@ -3,20 +3,37 @@
 #include <yavsg/gl/error.hpp>
 #include <yavsg/gl/shader.hpp>
 #include <yavsg/gl/texture.hpp>
+#include <yavsg/math/basic_transforms.hpp> // scaling
 #include <yavsg/math/common_transforms.hpp>
 #include <yavsg/rendering/shader_utils.hpp> // shaders_dir
 #include <yavsg/rendering/shader_variable_names.hpp>
+#include <yavsg/tasking/parallel_for.hpp>
 #include <yavsg/tasking/tasking.hpp>
 
+#include <doctest/doctest.h>    // REQUIRE
 #include <fmt/format.h>
 
+#include <algorithm>    // min
 #include <array>
+#include <limits>
 #include <string_view>
 
 
 namespace
 {
     using namespace std::string_view_literals;
+    
+    // Objects culled & recorded per task
+    constexpr std::size_t objects_per_command_buffer = 64;
+    
+    auto const material_names = std::array<
+        JadeMatrix::yavsg::shader_string_id,
+        JadeMatrix::yavsg::scene::material_texture_count
+    >{
+        JadeMatrix::yavsg::shader_string_id::map_color,
+        JadeMatrix::yavsg::shader_string_id::map_normal,
+        JadeMatrix::yavsg::shader_string_id::map_specular
+    };
 }
 
 
@@ -31,9 +48,15 @@ JadeMatrix::yavsg::obj_render_step::obj_render_step() :
             shaders_dir() / "obj_scene.frag"sv
         ).id
     } ),
+    uniforms{ frame_uniforms::shared() },
     first_run{ true }
 {
     scene_program.bind_target< 0 >( shader_string_id::fragment_out_color );
+    frame_uniforms::bind_blocks( scene_program );
+    scene::material_description::bind_samplers(
+        scene_program,
+        material_names
+    );
 }
 
 void JadeMatrix::yavsg::obj_render_step::run(
@@ -49,30 +72,16 @@ void JadeMatrix::yavsg::obj_render_step::run(
     );
     gl::Enable( GL_DEPTH_TEST );
     
-    scene_program.set_uniform(
-        shader_string_id::transform_view,
-        obj_scene.main_camera.view< GLfloat >()
+    auto view       = obj_scene.main_camera.view< GLfloat >();
+    auto projection = obj_scene.main_camera.projection< GLfloat >(
+          static_cast< GLfloat >( target.width () )
+        / static_cast< GLfloat >( target.height() )
     );
     
-    scene_program.set_uniform(
-        shader_string_id::transform_projection,
-        obj_scene.main_camera.projection< GLfloat >(
-              static_cast< GLfloat >( target.width () )
-            / static_cast< GLfloat >( target.height() )
-        )
-    );
-    
-    scene_program.set_uniform(
-        shader_string_id::camera_point_near,
-        obj_scene.main_camera.near_point()
-    );
-    scene_program.set_uniform(
-        shader_string_id::camera_point_focal,
-        obj_scene.main_camera.focal_point()
-    );
-    scene_program.set_uniform(
-        shader_string_id::camera_point_far,
-        obj_scene.main_camera.far_point()
+    uniforms->update_camera(
+        obj_scene.main_camera,
+          static_cast< GLfloat >( target.width () )
+        / static_cast< GLfloat >( target.height() )
     );
     
     auto objects_ref = obj_scene.object_manager.read();
@@ -105,28 +114,134 @@ void JadeMatrix::yavsg::obj_render_step::run(
         first_run = false;
     }
     
+    // The scene vertex shader flips Y before applying the model transform
+    auto view_projection = (
+          projection
+        * view
+    );
+    auto const flip_y = scaling< GLfloat >(
+        vector< GLfloat, 3 >{ 1.0f, -1.0f, 1.0f }
+    );
+    auto const object_transform = [ & ]( auto const& object ){
+        return (
+              view_projection
+            * object.transform_model()
+            * flip_y
+        );
+    };
+    
+    // Packed vertex positions are decoded by the model transform uniform,
+    // which has to undo the shader's flip to decode them unflipped
+    auto const model_transform = [ & ]( auto const& object ){
+        return (
+              object.transform_model()
+            * flip_y
+            * scene::vertex_position_transform(
+                object.bounds_min,
+                object.bounds_max
+            )
+            * flip_y
+        );
+    };
+    
+    // Rasterizing is skipped entirely if no objects are marked as occluders
+    occlusion.clear();
     for( auto& object : *objects_ref )
     {
-        scene_program.set_uniform(
-            shader_string_id::transform_model,
-            object.transform_model()
-        );
+        if( !object.occluder_vertices.empty() )
+        {
+            occlusion.add_occluder(
+                object.occluder_vertices,
+                object_transform( object )
+            );
+        }
+    }
+    occlusion.rasterize();
+    
+    // Uniform locations have to be looked up on the GPU thread, so resolve
+    // them before recording
+    auto const model_location = scene_program.uniform_location(
+        shader_string_id::transform_model
+    );
+    
+    // Material blocks are only re-uploaded if they've changed, but that also
+    // has to happen here rather than while recording
+    if constexpr( scene::material_description::has_block )
+    {
+        for( auto const& object : *objects_ref )
+        {
+            for( auto const& group : object.render_groups )
+            {
+                group.material.upload_block();
+            }
+        }
+    }
+    
+    // Cull & record draws for chunks of objects on task workers, then replay
+    // them here in order
+    auto const& objects     = *objects_ref;
+    auto const  chunk_count = (
+        ( objects.size() + objects_per_command_buffer - 1 )
+        / objects_per_command_buffer
+    );
+    if( command_buffers.size() < chunk_count )
+    {
+        command_buffers.resize( chunk_count );
+    }
+    
+    parallel_for( chunk_count, [ & ]( std::size_t chunk ){
+        auto& commands = command_buffers[ chunk ];
+        commands.clear();
         
-        for( auto& group : object.render_groups )
+        auto const first = chunk * objects_per_command_buffer;
+        auto const end   = std::min(
+            first + objects_per_command_buffer,
+            objects.size()
+        );
+        for( auto i = first; i < end; ++i )
         {
-            group.material.bind(
-                scene_program,
-                std::array<
-                    shader_string_id,
-                    scene::material_texture_count
-                >{
-                    shader_string_id::map_color,
-                    shader_string_id::map_normal,
-                    shader_string_id::map_specular
-                }
+            auto const& object = objects[ i ];
+            
+            if( !occlusion.test_bounds(
+                object.bounds_min,
+                object.bounds_max,
+                object_transform( object )
+            ) )
+            {
+                continue;
+            }
+            
+            commands.use_program( scene_program.gl_program_id() );
+            commands.bind_vertex_array( scene_program.gl_vao_id() );
+            commands.set_uniform( model_location, model_transform( object ) );
+            commands.bind_buffer(
+                GL_ARRAY_BUFFER,
+                object.vertices.gl_buffer_id()
             );
             
-            scene_program.run( object.vertices, group.indices );
+            for( auto const& group : object.render_groups )
+            {
+                group.material.record_bind( scene_program, commands );
+                
+                REQUIRE(
+                    group.indices.size()
+                    <= std::numeric_limits< GLsizei >::max()
+                );
+                commands.bind_buffer(
+                    GL_ELEMENT_ARRAY_BUFFER,
+                    group.indices.gl_buffer_id()
+                );
+                commands.draw_elements(
+                    GL_TRIANGLES,
+                    static_cast< GLsizei >( group.indices.size() ),
+                    0
+                );
+            }
         }
+    } );
+    
+    for( std::size_t chunk = 0; chunk < chunk_count; ++chunk )
+    {
+        command_buffers[ chunk ].replay();
     }
 }
@@ -0,0 +1,432 @@
+#include <yavsg/rendering/occlusion_buffer.hpp>
+
+#include <yavsg/tasking/parallel_for.hpp>
+
+#include <algorithm>    // min, max, fill
+#include <cmath>        // floor, ceil
+#include <limits>
+#include <utility>      // swap
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+    #define YAVSG_OCCLUSION_BUFFER_SSE
+    #include <emmintrin.h>
+#endif
+
+
+namespace
+{
+    // Vertices closer to the eye than this in clip space are treated as
+    // crossing the near plane
+    constexpr float min_clip_w = 1.0e-5f;
+    
+    struct clip_point
+    {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
+    
+    clip_point transform_point(
+        JadeMatrix::yavsg::occlusion_buffer::matrix_type const& m,
+        JadeMatrix::yavsg::occlusion_buffer::point_type  const& p
+    )
+    {
+        // Matrices are column-major, `m[ column ][ row ]`
+        return {
+            m[ 0 ][ 0 ] * p[ 0 ] + m[ 1 ][ 0 ] * p[ 1 ] + m[ 2 ][ 0 ] * p[ 2 ] + m[ 3 ][ 0 ],
+            m[ 0 ][ 1 ] * p[ 0 ] + m[ 1 ][ 1 ] * p[ 1 ] + m[ 2 ][ 1 ] * p[ 2 ] + m[ 3 ][ 1 ],
+            m[ 0 ][ 2 ] * p[ 0 ] + m[ 1 ][ 2 ] * p[ 1 ] + m[ 2 ][ 2 ] * p[ 2 ] + m[ 3 ][ 2 ],
+            m[ 0 ][ 3 ] * p[ 0 ] + m[ 1 ][ 3 ] * p[ 1 ] + m[ 2 ][ 3 ] * p[ 2 ] + m[ 3 ][ 3 ]
+        };
+    }
+    
+    std::size_t round_up( std::size_t value, std::size_t multiple )
+    {
+        return ( ( value + multiple - 1 ) / multiple ) * multiple;
+    }
+}
+
+
+JadeMatrix::yavsg::occlusion_buffer::occlusion_buffer(
+    std::size_t width,
+    std::size_t height
+) :
+    width_ ( std::max( round_up( width , 4           ), std::size_t{ 4 } ) ),
+    height_( std::max( round_up( height, band_height ), band_height      ) ),
+    depth_ ( width_ * height_, 1.0f )
+{}
+
+std::size_t JadeMatrix::yavsg::occlusion_buffer::width() const
+{
+    return width_;
+}
+
+std::size_t JadeMatrix::yavsg::occlusion_buffer::height() const
+{
+    return height_;
+}
+
+void JadeMatrix::yavsg::occlusion_buffer::clear()
+{
+    // Depth is only ever written by rasterizing queued triangles
+    if( !triangles_.empty() )
+    {
+        std::fill( depth_.begin(), depth_.end(), 1.0f );
+        triangles_.clear();
+    }
+}
+
+void JadeMatrix::yavsg::occlusion_buffer::add_occluder(
+    std::vector< point_type > const& triangles,
+    matrix_type               const& model_view_projection
+)
+{
+    auto const half_width  = static_cast< float >( width_  ) / 2.0f;
+    auto const half_height = static_cast< float >( height_ ) / 2.0f;
+    
+    for( std::size_t i = 0; i + 2 < triangles.size(); i += 3 )
+    {
+        screen_triangle screen;
+        bool            crosses_near = false;
+        
+        for( std::size_t v = 0; v < 3; ++v )
+        {
+            auto const clip = transform_point(
+                model_view_projection,
+                triangles[ i + v ]
+            );
+            if( clip.w <= min_clip_w )
+            {
+                crosses_near = true;
+                break;
+            }
+            screen.x[ v ] = ( clip.x / clip.w + 1.0f ) * half_width;
+            screen.y[ v ] = ( clip.y / clip.w + 1.0f ) * half_height;
+            screen.z[ v ] = ( clip.z / clip.w + 1.0f ) / 2.0f;
+        }
+        
+        if( crosses_near )
+        {
+            continue;
+        }
+        
+        auto const area = (
+              ( screen.x[ 1 ] - screen.x[ 0 ] ) * ( screen.y[ 2 ] - screen.y[ 0 ] )
+            - ( screen.x[ 2 ] - screen.x[ 0 ] ) * ( screen.y[ 1 ] - screen.y[ 0 ] )
+        );
+        if( area == 0.0f )
+        {
+            continue;
+        }
+        else if( area < 0.0f )
+        {
+            // Occluders are double-sided, so just rewind clockwise triangles
+            std::swap( screen.x[ 1 ], screen.x[ 2 ] );
+            std::swap( screen.y[ 1 ], screen.y[ 2 ] );
+            std::swap( screen.z[ 1 ], screen.z[ 2 ] );
+        }
+        
+        triangles_.push_back( screen );
+    }
+}
+
+void JadeMatrix::yavsg::occlusion_buffer::rasterize()
+{
+    if( triangles_.empty() )
+    {
+        return;
+    }
+    
+    parallel_for(
+        height_ / band_height,
+        [ this ]( std::size_t band ){ rasterize_band( band ); }
+    );
+}
+
+void JadeMatrix::yavsg::occlusion_buffer::rasterize_band( std::size_t band )
+{
+    auto const first_row = band * band_height;
+    auto const   end_row = first_row + band_height;
+    
+    for( auto const& triangle : triangles_ )
+    {
+        rasterize_triangle( triangle, first_row, end_row );
+    }
+}
+
+void JadeMatrix::yavsg::occlusion_buffer::rasterize_triangle(
+    screen_triangle const& t,
+    std::size_t            first_row,
+    std::size_t            end_row
+)
+{
+    auto const min_x = std::min( { t.x[ 0 ], t.x[ 1 ], t.x[ 2 ] } );
+    auto const max_x = std::max( { t.x[ 0 ], t.x[ 1 ], t.x[ 2 ] } );
+    auto const min_y = std::min( { t.y[ 0 ], t.y[ 1 ], t.y[ 2 ] } );
+    auto const max_y = std::max( { t.y[ 0 ], t.y[ 1 ], t.y[ 2 ] } );
+    
+    if(
+           max_x < 0.0f
+        || max_y < static_cast< float >( first_row )
+        || min_x >= static_cast< float >( width_   )
+        || min_y >= static_cast< float >( end_row  )
+    )
+    {
+        return;
+    }
+    
+    // Pixel ranges are [begin, end), sampled at pixel centers
+    auto const begin_x = static_cast< std::size_t >( std::max(
+        std::floor( min_x ),
+        0.0f
+    ) ) & ~std::size_t{ 3 };
+    auto const end_x = std::min(
+        static_cast< std::size_t >( std::ceil( max_x ) ),
+        width_
+    );
+    auto const begin_y = std::max(
+        static_cast< std::size_t >( std::max( std::floor( min_y ), 0.0f ) ),
+        first_row
+    );
+    auto const end_y = std::min(
+        static_cast< std::size_t >( std::ceil( max_y ) ),
+        end_row
+    );
+    
+    // Edge functions `w_n = a_n * x + b_n * y + c_n` for the edge opposite
+    // vertex n; all are >= 0 inside the triangle
+    float a[ 3 ];
+    float b[ 3 ];
+    float c[ 3 ];
+    for( std::size_t n = 0; n < 3; ++n )
+    {
+        auto const from = ( n + 1 ) % 3;
+        auto const   to = ( n + 2 ) % 3;
+        a[ n ] = t.y[ from ] - t.y[ to ];
+        b[ n ] = t.x[ to   ] - t.x[ from ];
+        c[ n ] = -( a[ n ] * t.x[ from ] + b[ n ] * t.y[ from ] );
+    }
+    
+    // Depth as a plane equation over the barycentric weights
+    auto const area = a[ 0 ] * t.x[ 0 ] + b[ 0 ] * t.y[ 0 ] + c[ 0 ];
+    auto const a_z  = ( a[ 0 ] * t.z[ 0 ] + a[ 1 ] * t.z[ 1 ] + a[ 2 ] * t.z[ 2 ] ) / area;
+    auto const b_z  = ( b[ 0 ] * t.z[ 0 ] + b[ 1 ] * t.z[ 1 ] + b[ 2 ] * t.z[ 2 ] ) / area;
+    auto const c_z  = ( c[ 0 ] * t.z[ 0 ] + c[ 1 ] * t.z[ 1 ] + c[ 2 ] * t.z[ 2 ] ) / area;
+    
+#ifdef YAVSG_OCCLUSION_BUFFER_SSE
+    auto const lane_offsets = _mm_set_ps( 3.5f, 2.5f, 1.5f, 0.5f );
+    auto const zero         = _mm_setzero_ps();
+    
+    __m128 a_v[ 3 ];
+    for( std::size_t n = 0; n < 3; ++n )
+    {
+        a_v[ n ] = _mm_set1_ps( a[ n ] );
+    }
+    auto const a_z_v = _mm_set1_ps( a_z );
+#endif
+    
+    for( auto y = begin_y; y < end_y; ++y )
+    {
+        auto const pixel_y = static_cast< float >( y ) + 0.5f;
+        auto const row     = depth_.data() + y * width_;
+        
+        // Per-row constant parts of the edge & depth functions
+        float row_c[ 3 ];
+        for( std::size_t n = 0; n < 3; ++n )
+        {
+            row_c[ n ] = b[ n ] * pixel_y + c[ n ];
+        }
+        auto const row_c_z = b_z * pixel_y + c_z;
+        
+#ifdef YAVSG_OCCLUSION_BUFFER_SSE
+        __m128 row_c_v[ 3 ];
+        for( std::size_t n = 0; n < 3; ++n )
+        {
+            row_c_v[ n ] = _mm_set1_ps( row_c[ n ] );
+        }
+        auto const row_c_z_v = _mm_set1_ps( row_c_z );
+        
+        for( auto x = begin_x; x < end_x; x += 4 )
+        {
+            auto const pixel_x = _mm_add_ps(
+                _mm_set1_ps( static_cast< float >( x ) ),
+                lane_offsets
+            );
+            
+            auto inside = _mm_cmpge_ps(
+                _mm_add_ps( _mm_mul_ps( a_v[ 0 ], pixel_x ), row_c_v[ 0 ] ),
+                zero
+            );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps(
+                _mm_add_ps( _mm_mul_ps( a_v[ 1 ], pixel_x ), row_c_v[ 1 ] ),
+                zero
+            ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps(
+                _mm_add_ps( _mm_mul_ps( a_v[ 2 ], pixel_x ), row_c_v[ 2 ] ),
+                zero
+            ) );
+            
+            if( _mm_movemask_ps( inside ) == 0 )
+            {
+                continue;
+            }
+            
+            auto const depth = _mm_add_ps(
+                _mm_mul_ps( a_z_v, pixel_x ),
+                row_c_z_v
+            );
+            auto const current = _mm_loadu_ps( row + x );
+            auto const nearest = _mm_min_ps( current, depth );
+            _mm_storeu_ps( row + x, _mm_or_ps(
+                _mm_and_ps   ( inside, nearest ),
+                _mm_andnot_ps( inside, current )
+            ) );
+        }
+#else
+        for( auto x = begin_x; x < end_x; ++x )
+        {
+            auto const pixel_x = static_cast< float >( x ) + 0.5f;
+            if(
+                   a[ 0 ] * pixel_x + row_c[ 0 ] < 0.0f
+                || a[ 1 ] * pixel_x + row_c[ 1 ] < 0.0f
+                || a[ 2 ] * pixel_x + row_c[ 2 ] < 0.0f
+            )
+            {
+                continue;
+            }
+            row[ x ] = std::min( row[ x ], a_z * pixel_x + row_c_z );
+        }
+#endif
+    }
+}
+
+bool JadeMatrix::yavsg::occlusion_buffer::test_bounds(
+    point_type  const& bounds_min,
+    point_type  const& bounds_max,
+    matrix_type const& model_view_projection
+) const
+{
+    auto min_x     = static_cast< float >( width_  );
+    auto min_y     = static_cast< float >( height_ );
+    auto max_x     = 0.0f;
+    auto max_y     = 0.0f;
+    auto min_depth = std::numeric_limits< float >::infinity();
+    
+    auto const half_width  = static_cast< float >( width_  ) / 2.0f;
+    auto const half_height = static_cast< float >( height_ ) / 2.0f;
+    
+    for( std::size_t corner = 0; corner < 8; ++corner )
+    {
+        auto const clip = transform_point( model_view_projection, {
+            ( corner & 0x01 ) ? bounds_max[ 0 ] : bounds_min[ 0 ],
+            ( corner & 0x02 ) ? bounds_max[ 1 ] : bounds_min[ 1 ],
+            ( corner & 0x04 ) ? bounds_max[ 2 ] : bounds_min[ 2 ]
+        } );
+        
+        // Can't say anything useful about boxes crossing the near plane
+        if( clip.w <= min_clip_w )
+        {
+            return true;
+        }
+        
+        auto const x = ( clip.x / clip.w + 1.0f ) * half_width;
+        auto const y = ( clip.y / clip.w + 1.0f ) * half_height;
+        min_x     = std::min( min_x, x );
+        min_y     = std::min( min_y, y );
+        max_x     = std::max( max_x, x );
+        max_y     = std::max( max_y, y );
+        min_depth = std::min( min_depth, ( clip.z / clip.w + 1.0f ) / 2.0f );
+    }
+    
+    // Entirely off-screen or beyond the far plane
+    if(
+           max_x < 0.0f
+        || max_y < 0.0f
+        || min_x >= static_cast< float >( width_  )
+        || min_y >= static_cast< float >( height_ )
+        || min_depth > 1.0f
+    )
+    {
+        return false;
+    }
+    
+    // Nothing can be hidden by an empty buffer
+    if( triangles_.empty() )
+    {
+        return true;
+    }
+    
+    // Every pixel the box touches must be strictly nearer than the box's
+    // nearest point for it to be hidden
+    auto const begin_x = static_cast< std::size_t >( std::max(
+        std::floor( min_x ),
+        0.0f
+    ) );
+    auto const end_x = std::min(
+        static_cast< std::size_t >( std::ceil( max_x ) ) + 1,
+        width_
+    );
+    auto const begin_y = static_cast< std::size_t >( std::max(
+        std::floor( min_y ),
+        0.0f
+    ) );
+    auto const end_y = std::min(
+        static_cast< std::size_t >( std::ceil( max_y ) ) + 1,
+        height_
+    );
+
+#ifdef YAVSG_OCCLUSION_BUFFER_SSE
+    auto const box_depth  = _mm_set1_ps( min_depth );
+    auto const lane_x     = _mm_set_epi32( 3, 2, 1, 0 );
+    auto const lane_begin = _mm_set1_epi32( static_cast< int >( begin_x ) - 1 );
+    auto const lane_end   = _mm_set1_epi32( static_cast< int >( end_x   )     );
+#endif
+    
+    for( auto y = begin_y; y < end_y; ++y )
+    {
+        auto const row = depth_.data() + y * width_;
+        
+#ifdef YAVSG_OCCLUSION_BUFFER_SSE
+        for( auto x = begin_x & ~std::size_t{ 3 }; x < end_x; x += 4 )
+        {
+            // Mask off lanes outside of [begin_x, end_x)
+            auto const lanes = _mm_add_epi32(
+                _mm_set1_epi32( static_cast< int >( x ) ),
+                lane_x
+            );
+            auto const in_range = _mm_castsi128_ps( _mm_and_si128(
+                _mm_cmpgt_epi32( lanes, lane_begin ),
+                _mm_cmplt_epi32( lanes, lane_end   )
+            ) );
+            
+            auto const visible = _mm_and_ps(
+                in_range,
+                _mm_cmpge_ps( _mm_loadu_ps( row + x ), box_depth )
+            );
+            if( _mm_movemask_ps( visible ) != 0 )
+            {
+                return true;
+            }
+        }
+#else
+        for( auto x = begin_x; x < end_x; ++x )
+        {
+            if( row[ x ] >= min_depth )
+            {
+                return true;
+            }
+        }
+#endif
+    }
+    
+    return false;
+}
+
+float JadeMatrix::yavsg::occlusion_buffer::depth_at(
+    std::size_t x,
+    std::size_t y
+) const
+{
+    return depth_[ y * width_ + x ];
+}
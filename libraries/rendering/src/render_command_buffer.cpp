@@ -0,0 +1,226 @@
+#include <yavsg/rendering/render_command_buffer.hpp>
+
+#include <yavsg/rendering/texture_residency.hpp>
+
+#include <cstring>  // memcpy
+
+
+namespace
+{
+    // Every recorded value is trivially copyable but unaligned in the buffer
+    template< typename T > T read( std::byte const*& position )
+    {
+        T value;
+        std::memcpy( &value, position, sizeof( T ) );
+        position += sizeof( T );
+        return value;
+    }
+}
+
+
+JadeMatrix::yavsg::render_command_buffer::render_command_buffer()
+{
+    clear();
+}
+
+void JadeMatrix::yavsg::render_command_buffer::clear()
+{
+    commands_.clear();
+    
+    // 0 is a valid "unbind" ID, so use a value OpenGL won't hand out instead
+    current_program_        = ~GLuint{ 0 };
+    current_vao_            = ~GLuint{ 0 };
+    current_array_buffer_   = ~GLuint{ 0 };
+    current_element_buffer_ = ~GLuint{ 0 };
+}
+
+bool JadeMatrix::yavsg::render_command_buffer::empty() const
+{
+    return commands_.empty();
+}
+
+void JadeMatrix::yavsg::render_command_buffer::use_program( GLuint program_id )
+{
+    if( program_id == current_program_ )
+    {
+        return;
+    }
+    current_program_ = program_id;
+    
+    write( opcode::use_program );
+    write( program_id );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::bind_vertex_array(
+    GLuint vao_id
+)
+{
+    if( vao_id == current_vao_ )
+    {
+        return;
+    }
+    current_vao_ = vao_id;
+    
+    // The element array binding is part of VAO state
+    current_element_buffer_ = ~GLuint{ 0 };
+    
+    write( opcode::bind_vertex_array );
+    write( vao_id );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::bind_buffer(
+    GLenum target,
+    GLuint buffer_id
+)
+{
+    auto current = static_cast< GLuint* >( nullptr );
+    switch( target )
+    {
+    case GL_ARRAY_BUFFER:
+        current = &current_array_buffer_;
+        break;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        current = &current_element_buffer_;
+        break;
+    default:
+        break;
+    }
+    if( current )
+    {
+        if( *current == buffer_id )
+        {
+            return;
+        }
+        *current = buffer_id;
+    }
+    
+    write( opcode::bind_buffer );
+    write( target );
+    write( buffer_id );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::bind_buffer_range(
+    GLenum     target,
+    GLuint     index,
+    GLuint     buffer_id,
+    GLintptr   offset,
+    GLsizeiptr size
+)
+{
+    write( opcode::bind_buffer_range );
+    write( target );
+    write( index );
+    write( buffer_id );
+    write( offset );
+    write( size );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::bind_texture(
+    GLuint texture_unit,
+    GLenum target,
+    GLuint texture_id
+)
+{
+    write( opcode::bind_texture );
+    write( texture_unit );
+    write( target );
+    write( texture_id );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::draw_arrays(
+    GLenum  mode,
+    GLint   first,
+    GLsizei count
+)
+{
+    write( opcode::draw_arrays );
+    write( mode );
+    write( first );
+    write( count );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::draw_elements(
+    GLenum      mode,
+    GLsizei     count,
+    std::size_t first_index
+)
+{
+    write( opcode::draw_elements );
+    write( mode );
+    write( count );
+    write( first_index );
+}
+
+void JadeMatrix::yavsg::render_command_buffer::replay() const
+{
+    auto       position = commands_.data();
+    auto const end      = commands_.data() + commands_.size();
+    
+    while( position < end )
+    {
+        switch( read< opcode >( position ) )
+        {
+        case opcode::use_program:
+            gl::UseProgram( read< GLuint >( position ) );
+            break;
+        case opcode::bind_vertex_array:
+            gl::BindVertexArray( read< GLuint >( position ) );
+            break;
+        case opcode::bind_buffer:
+            {
+                auto const target    = read< GLenum >( position );
+                auto const buffer_id = read< GLuint >( position );
+                gl::BindBuffer( target, buffer_id );
+            }
+            break;
+        case opcode::bind_buffer_range:
+            {
+                auto const target    = read< GLenum     >( position );
+                auto const index     = read< GLuint     >( position );
+                auto const buffer_id = read< GLuint     >( position );
+                auto const offset    = read< GLintptr   >( position );
+                auto const size      = read< GLsizeiptr >( position );
+                gl::BindBufferRange( target, index, buffer_id, offset, size );
+            }
+            break;
+        case opcode::bind_texture:
+            {
+                auto const texture_unit = read< GLuint >( position );
+                auto const target       = read< GLenum >( position );
+                auto const texture_id   = read< GLuint >( position );
+                gl::ActiveTexture( GL_TEXTURE0 + texture_unit );
+                gl::BindTexture( target, texture_id );
+                texture_residency::instance().touch( texture_id );
+            }
+            break;
+        case opcode::set_uniform:
+            {
+                auto const setter   = read< uniform_setter >( position );
+                auto const location = read< GLint          >( position );
+                position = setter( location, position );
+            }
+            break;
+        case opcode::draw_arrays:
+            {
+                auto const mode  = read< GLenum  >( position );
+                auto const first = read< GLint   >( position );
+                auto const count = read< GLsizei >( position );
+                gl::DrawArrays( mode, first, count );
+            }
+            break;
+        case opcode::draw_elements:
+            {
+                auto const mode        = read< GLenum      >( position );
+                auto const count       = read< GLsizei     >( position );
+                auto const first_index = read< std::size_t >( position );
+                gl::DrawElements(
+                    mode,
+                    count,
+                    GL_UNSIGNED_INT,
+                    reinterpret_cast< void* >( first_index * sizeof( GLuint ) )
+                );
+            }
+            break;
+        }
+    }
+}
@@ -1,5 +1,77 @@
 #include <yavsg/rendering/scene.hpp>
 
+#include <yavsg/math/basic_transforms.hpp>  // scaling, translation
+
+#include <algorithm>    // clamp
+#include <array>
+#include <cmath>        // abs, lround
+#include <limits>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+#ifdef YAVSG_PACKED_VERTICES
+    // Rounds a value in [0,1] or [-1,1] to the nearest representable value of
+    // a normalized integer type
+    template< typename T > yavsg::gl::normalized< T > normalize( GLfloat value )
+    {
+        constexpr auto max = static_cast< GLfloat >(
+            std::numeric_limits< T >::max()
+        );
+        constexpr auto min = ( std::numeric_limits< T >::is_signed
+            ? -1.0f
+            :  0.0f
+        );
+        return { static_cast< T >(
+            std::lround( std::clamp( value, min, 1.0f ) * max )
+        ) };
+    }
+    
+    GLfloat position_extent( GLfloat min, GLfloat max )
+    {
+        // Flat meshes would otherwise divide by zero; every vertex is at `min`
+        // along that axis anyways
+        return ( max > min ? max - min : 1.0f );
+    }
+#endif
+    
+    // Projects the unit sphere onto an octahedron, then unfolds the lower half
+    // over the upper so it covers [-1,1] on both axes; see "A Survey of
+    // Efficient Representations for Independent Unit Vectors" (Cigolle et al.,
+    // 2014)
+    yavsg::vector< GLfloat, 2 > octahedral_encode(
+        yavsg::vector< GLfloat, 3 > const& normal
+    )
+    {
+        auto const sum = (
+              std::abs( normal[ 0 ] )
+            + std::abs( normal[ 1 ] )
+            + std::abs( normal[ 2 ] )
+        );
+        // Missing normals are left as zero, which this encodes as +Z
+        if( sum == 0.0f )
+        {
+            return { 0.0f, 0.0f };
+        }
+        
+        auto x = normal[ 0 ] / sum;
+        auto y = normal[ 1 ] / sum;
+        if( normal[ 2 ] < 0.0f )
+        {
+            auto const sign = []( GLfloat v ){
+                return ( v < 0.0f ? -1.0f : 1.0f );
+            };
+            auto const folded_x = ( 1.0f - std::abs( y ) ) * sign( x );
+            auto const folded_y = ( 1.0f - std::abs( x ) ) * sign( y );
+            x = folded_x;
+            y = folded_y;
+        }
+        return { x, y };
+    }
+}
+
 
 JadeMatrix::yavsg::scene::scene() :
     main_camera(
@@ -9,3 +81,93 @@ JadeMatrix::yavsg::scene::scene() :
         10.0f
     )
 {}
+
+JadeMatrix::yavsg::scene::vertex_type JadeMatrix::yavsg::scene::pack_vertex(
+    vertex_attributes_type const& attributes,
+    [[maybe_unused]] vector< GLfloat, 3 > const& bounds_min,
+    [[maybe_unused]] vector< GLfloat, 3 > const& bounds_max
+)
+{
+#ifdef YAVSG_PACKED_VERTICES
+    auto const& [ position, normal, color, texture ] = attributes;
+    
+    std::array< gl::normalized< GLushort >, 4 > packed_position;
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+        packed_position[ i ] = normalize< GLushort >(
+            ( position[ i ] - bounds_min[ i ] )
+            / position_extent( bounds_min[ i ], bounds_max[ i ] )
+        );
+    }
+    packed_position[ 3 ] = { 0 };
+    
+    auto const encoded_normal = octahedral_encode( normal );
+    
+    return {
+        packed_position,
+        std::array< gl::normalized< GLshort >, 2 >{
+            normalize< GLshort >( encoded_normal[ 0 ] ),
+            normalize< GLshort >( encoded_normal[ 1 ] )
+        },
+        std::array< gl::normalized< GLubyte >, 4 >{
+            normalize< GLubyte >( color[ 0 ] ),
+            normalize< GLubyte >( color[ 1 ] ),
+            normalize< GLubyte >( color[ 2 ] ),
+            normalize< GLubyte >( 1.0f )
+        },
+        std::array< gl::half, 2 >{
+            gl::half{ gl::float_to_half( texture[ 0 ] ) },
+            gl::half{ gl::float_to_half( texture[ 1 ] ) }
+        }
+    };
+#else
+    auto const& [ position, normal, color, texture ] = attributes;
+    return { position, octahedral_encode( normal ), color, texture };
+#endif
+}
+
+JadeMatrix::yavsg::vector< GLfloat, 3 >
+JadeMatrix::yavsg::scene::unpack_position(
+    vertex_type const& vertex,
+    [[maybe_unused]] vector< GLfloat, 3 > const& bounds_min,
+    [[maybe_unused]] vector< GLfloat, 3 > const& bounds_max
+)
+{
+#ifdef YAVSG_PACKED_VERTICES
+    auto const& packed_position = std::get< 0 >( vertex );
+    std::array< GLfloat, 3 > position;
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+        position[ i ] = (
+            bounds_min[ i ]
+            + static_cast< GLfloat >( packed_position[ i ].value )
+            / static_cast< GLfloat >( std::numeric_limits< GLushort >::max() )
+            * position_extent( bounds_min[ i ], bounds_max[ i ] )
+        );
+    }
+    return position;
+#else
+    return std::get< 0 >( vertex );
+#endif
+}
+
+JadeMatrix::yavsg::square_matrix< GLfloat, 4 >
+JadeMatrix::yavsg::scene::vertex_position_transform(
+    [[maybe_unused]] vector< GLfloat, 3 > const& bounds_min,
+    [[maybe_unused]] vector< GLfloat, 3 > const& bounds_max
+)
+{
+#ifdef YAVSG_PACKED_VERTICES
+    // Normalized positions are read by the shader as [0,1]
+    return (
+          translation< GLfloat >( bounds_min )
+        * scaling< GLfloat >( vector< GLfloat, 3 >{
+            position_extent( bounds_min[ 0 ], bounds_max[ 0 ] ),
+            position_extent( bounds_min[ 1 ], bounds_max[ 1 ] ),
+            position_extent( bounds_min[ 2 ], bounds_max[ 2 ] )
+        } )
+    );
+#else
+    return identity_matrix< GLfloat, 4 >();
+#endif
+}
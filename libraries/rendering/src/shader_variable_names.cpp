@@ -12,8 +12,6 @@ namespace
     auto const vertex_in_texture         = "vertex_in_texture"s;
     
     auto const transform_model           = "transform.model"s;
-    auto const transform_view            = "transform.view"s;
-    auto const transform_projection      = "transform.projection"s;
     
     auto const position                  = "position"s;
     auto const color                     = "color"s;
@@ -31,15 +29,13 @@ namespace
     auto const map_color                 = "map_color"s;
     auto const map_normal                = "map_normal"s;
     auto const map_specular              = "map_specular"s;
+    auto const material_block            = "MATERIAL"s;
     
-    auto const camera_point_near         = "camera_point.near"s;
-    auto const camera_point_focal        = "camera_point.focal"s;
-    auto const camera_point_far          = "camera_point.far"s;
+    auto const camera_block              = "CAMERA"s;
     
     auto const framebuffer_source_color  = "framebuffer_source_color"s;
     auto const framebuffer_source_depth  = "framebuffer_source_depth"s;
-    auto const framebuffer_target_width  = "framebuffer_target.width"s;
-    auto const framebuffer_target_height = "framebuffer_target.height"s;
+    auto const framebuffer_target_block  = "FRAMEBUFFER_TARGET"s;
     
     auto const fragment_out_color        = "fragment_out_color"s;
 }
@@ -57,8 +53,6 @@ const std::string& JadeMatrix::yavsg::shader_string( shader_string_id id )
     case ssid::vertex_in_texture        : return vertex_in_texture;
     
     case ssid::transform_model          : return transform_model;
-    case ssid::transform_view           : return transform_view;
-    case ssid::transform_projection     : return transform_projection;
     
     case ssid::vertex_out_position      : return vertex_out_position;
     case ssid::vertex_out_color         : return vertex_out_color;
@@ -72,15 +66,13 @@ const std::string& JadeMatrix::yavsg::shader_string( shader_string_id id )
     case ssid::map_color                : return map_color;
     case ssid::map_normal               : return map_normal;
     case ssid::map_specular             : return map_specular;
+    case ssid::material_block           : return material_block;
     
-    case ssid::camera_point_near        : return camera_point_near;
-    case ssid::camera_point_focal       : return camera_point_focal;
-    case ssid::camera_point_far         : return camera_point_far;
+    case ssid::camera_block             : return camera_block;
     
     case ssid::framebuffer_source_color : return framebuffer_source_color;
     case ssid::framebuffer_source_depth : return framebuffer_source_depth;
-    case ssid::framebuffer_target_width : return framebuffer_target_width;
-    case ssid::framebuffer_target_height: return framebuffer_target_height;
+    case ssid::framebuffer_target_block : return framebuffer_target_block;
     
     case ssid::fragment_out_color       : return fragment_out_color;
     }
@@ -0,0 +1,64 @@
+#include <yavsg/rendering/texture_cache.hpp>
+
+#include <atomic>
+#include <system_error> // error_code
+#include <utility>      // move
+
+
+namespace
+{
+    std::atomic< std::uint64_t > hit_count      = 0;
+    std::atomic< std::uint64_t > miss_count     = 0;
+    std::atomic< std::uint64_t > eviction_count = 0;
+}
+
+
+JadeMatrix::yavsg::texture_cache_counters
+JadeMatrix::yavsg::texture_cache_counts()
+{
+    return {
+        hit_count     .load( std::memory_order_relaxed ),
+        miss_count    .load( std::memory_order_relaxed ),
+        eviction_count.load( std::memory_order_relaxed )
+    };
+}
+
+void JadeMatrix::yavsg::reset_texture_cache_counts()
+{
+    hit_count      = 0;
+    miss_count     = 0;
+    eviction_count = 0;
+}
+
+void JadeMatrix::yavsg::count_texture_cache_lookup( bool hit )
+{
+    ( hit ? hit_count : miss_count ).fetch_add( 1, std::memory_order_relaxed );
+}
+
+void JadeMatrix::yavsg::count_texture_cache_evictions( std::size_t count )
+{
+    eviction_count.fetch_add( count, std::memory_order_relaxed );
+}
+
+JadeMatrix::yavsg::texture_cache_key JadeMatrix::yavsg::make_texture_cache_key(
+    std::filesystem::path       const& filename,
+    gl::texture_filter_settings const& settings,
+    gl::texture_flags_type             flags
+)
+{
+    // Missing files still get a key; they'll just fail to load
+    std::error_code error;
+    auto path = std::filesystem::weakly_canonical( filename, error );
+    if( error )
+    {
+        path = filename.lexically_normal();
+    }
+    
+    return {
+        std::move( path ),
+        settings.magnify,
+        settings.minify,
+        settings.mipmaps,
+        flags
+    };
+}
@@ -0,0 +1,143 @@
+#include <yavsg/rendering/texture_reference.hpp>
+
+#include <yavsg/gl/ktx.hpp>
+#include <yavsg/gl/texture_compression.hpp>
+#include <yavsg/logging.hpp>
+
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>    // max
+#include <cstddef>      // size_t
+#include <cstring>      // memset
+#include <exception>
+#include <stdexcept>    // runtime_error
+#include <string>
+#include <string_view>
+#include <utility>      // move
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+    
+    auto const log_ = JadeMatrix::yavsg::log_handle();
+}
+
+
+JadeMatrix::yavsg::gl::texture_upload_data
+JadeMatrix::yavsg::load_texture_file(
+    std::filesystem::path       const& filename,
+    gl::texture_flags_type             flags,
+    gl::texture_filter_settings const& settings,
+    GLint                              gl_internal_format
+)
+{
+    using namespace std::string_literals;
+    
+    if( filename.extension() == ".ktx" || filename.extension() == ".KTX" )
+    {
+        auto upload_data = gl::read_ktx_file( filename );
+        
+        // Drivers without the compression extension get the data decoded
+        // here, on a task worker, so it can still be uploaded
+        if(
+            gl::is_block_compressed_format( upload_data.gl_internal_format )
+            && !gl::block_compressed_format_supported(
+                upload_data.gl_internal_format
+            )
+        )
+        {
+            upload_data = gl::decompress_texture_data(
+                std::move( upload_data )
+            );
+        }
+        return upload_data;
+    }
+    
+    SDL_Surface* sdl_surface = IMG_Load( filename.c_str() );
+    if( !sdl_surface )
+    {
+        // TODO: graceful failure (just don't load)
+        throw std::runtime_error(
+            "failed to load texture \""s
+            + filename.native()
+            + "\": "s
+            + IMG_GetError()
+        );
+    }
+    
+    return gl::process_texture_data(
+        sdl_surface,
+        flags,
+        settings,
+        gl_internal_format
+    );
+}
+
+std::optional< JadeMatrix::yavsg::gl::texture_upload_data >
+JadeMatrix::yavsg::try_load_texture_file(
+    std::filesystem::path       const& filename,
+    gl::texture_flags_type             flags,
+    gl::texture_filter_settings const& settings,
+    GLint                              gl_internal_format
+)
+{
+    try
+    {
+        return load_texture_file(
+            filename,
+            flags,
+            settings,
+            gl_internal_format
+        );
+    }
+    catch( std::exception const& e )
+    {
+        log_.warning(
+            "Could not load texture {}: {}"sv,
+            filename.string(),
+            e.what()
+        );
+        return std::nullopt;
+    }
+}
+
+JadeMatrix::yavsg::gl::texture_upload_data
+JadeMatrix::yavsg::blank_texture_data( gl::texture_upload_data const& like )
+{
+    auto const compressed = gl::is_block_compressed_format(
+        like.gl_internal_format
+    );
+    auto const blank_level = [ & ]( std::size_t level ){
+        auto const width  = std::max< std::size_t >( 1, like.width  >> level );
+        auto const height = std::max< std::size_t >( 1, like.height >> level );
+        auto const size   = ( compressed
+            ? gl::block_compressed_size(
+                like.gl_internal_format,
+                width,
+                height
+            )
+            : gl::incoming_row_size( like, width ) * height
+        );
+        // Staging buffers are reused, so they need clearing
+        auto data = gl::make_texture_data( size );
+        std::memset( data.get(), 0, size );
+        return data;
+    };
+    
+    gl::texture_upload_data blank{
+        like.gl_internal_format,
+        like.width,
+        like.height,
+        like.gl_incoming_format,
+        like.gl_incoming_type,
+        blank_level( 0 ),
+        {}
+    };
+    blank.mipmaps.reserve( like.mipmaps.size() );
+    for( std::size_t level = 1; level <= like.mipmaps.size(); ++level )
+    {
+        blank.mipmaps.push_back( blank_level( level ) );
+    }
+    return blank;
+}
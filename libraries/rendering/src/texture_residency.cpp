@@ -0,0 +1,332 @@
+#include <yavsg/rendering/texture_residency.hpp>
+
+#include <yavsg/logging.hpp>
+#include <yavsg/tasking/task.hpp>
+#include <yavsg/tasking/tasking.hpp>
+
+#include <algorithm>    // max, sort
+#include <atomic>
+#include <exception>
+#include <memory>       // make_shared, make_unique
+#include <stdexcept>    // invalid_argument
+#include <string_view>
+#include <utility>      // move
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    std::atomic< std::size_t > memory_budget = std::size_t{ 1 } << 30;
+    
+    template< typename Reloaded > class reload_texture_data_task
+        : public yavsg::task
+    {
+    public:
+        reload_texture_data_task(
+            yavsg::texture_data_source  source,
+            std::shared_ptr< Reloaded > reloaded
+        ) :
+            source_  { std::move( source   ) },
+            reloaded_{ std::move( reloaded ) }
+        {}
+        
+        bool operator()() override
+        {
+            // A failed reload leaves the layers empty, which the residency
+            // manager takes to mean the texture can't be reloaded
+            try
+            {
+                reloaded_->layers = source_();
+            }
+            catch( std::exception const& e )
+            {
+                log_.warning( "Could not reload texture data: {}"sv, e.what() );
+            }
+            reloaded_->ready.store( true, std::memory_order_release );
+            return false;
+        }
+    
+    protected:
+        yavsg::texture_data_source  source_;
+        std::shared_ptr< Reloaded > reloaded_;
+    };
+}
+
+
+void JadeMatrix::yavsg::set_texture_memory_budget( std::size_t bytes )
+{
+    memory_budget.store( bytes );
+}
+
+std::size_t JadeMatrix::yavsg::texture_memory_budget()
+{
+    return memory_budget.load();
+}
+
+std::size_t JadeMatrix::yavsg::initial_texture_level(
+    gl::texture_upload_stream const& stream
+)
+{
+    auto level = stream.level_count() - 1;
+    while(
+        level > 0
+        && std::max(
+            stream.level_width ( level - 1 ),
+            stream.level_height( level - 1 )
+        ) <= initial_texture_resolution
+    )
+    {
+        --level;
+    }
+    return level;
+}
+
+JadeMatrix::yavsg::texture_residency&
+JadeMatrix::yavsg::texture_residency::instance()
+{
+    static texture_residency residency;
+    return residency;
+}
+
+void JadeMatrix::yavsg::texture_residency::add(
+    gl::texture_upload_stream&& stream,
+    texture_data_source         source
+)
+{
+    auto const gl_id = stream.gl_texture_id();
+    entries_.erase( gl_id );
+    
+    if( source )
+    {
+        stream.discard_uploaded_data();
+    }
+    
+    // Not drawn yet, so it's not streamed any further until it is
+    entries_.emplace(
+        gl_id,
+        entry{ std::move( stream ), 0, std::move( source ), nullptr }
+    );
+}
+
+void JadeMatrix::yavsg::texture_residency::remove( GLuint gl_id )
+{
+    entries_.erase( gl_id );
+}
+
+void JadeMatrix::yavsg::texture_residency::touch( GLuint gl_id )
+{
+    if( auto found = entries_.find( gl_id ); found != entries_.end() )
+    {
+        found->second.last_used = frame_;
+    }
+}
+
+void JadeMatrix::yavsg::texture_residency::update()
+{
+    ++frame_;
+    
+    auto const budget = memory_budget.load();
+    auto const recent = [ this ]( entry const& e ){
+        return frame_ - e.last_used <= recent_frames;
+    };
+    
+    std::size_t resident = 0;
+    std::vector< entry* > by_age;
+    by_age.reserve( entries_.size() );
+    for( auto& [ gl_id, e ] : entries_ )
+    {
+        resident += e.stream.allocated_bytes();
+        by_age.push_back( &e );
+    }
+    std::sort(
+        by_age.begin(),
+        by_age.end(),
+        []( entry const* a, entry const* b ){
+            return a->last_used < b->last_used;
+        }
+    );
+    
+    // If over budget (e.g. it was just lowered, or new textures came in),
+    // take away detail starting with the least-recently-used textures, even
+    // ones that are still on screen
+    if( budget > 0 )
+    {
+        for( auto e : by_age )
+        {
+            while( resident > budget )
+            {
+                auto const freed = evict_one_level( *e );
+                if( freed == 0 )
+                {
+                    break;
+                }
+                resident -= freed;
+            }
+            if( resident <= budget )
+            {
+                break;
+            }
+        }
+    }
+    
+    // Stream in detail for on-screen textures, most recently used first.  Room
+    // is only ever made by evicting textures that aren't on screen, so two
+    // textures that are can't keep trading the same memory back & forth.
+    auto oldest = by_age.begin();
+    for(
+        auto iter = by_age.rbegin();
+        iter != by_age.rend() && gl::texture_upload_budget_left();
+        ++iter
+    )
+    {
+        auto& e = **iter;
+        if( !recent( e ) )
+        {
+            break;
+        }
+        
+        auto& stream = e.stream;
+        if( stream.resident_level() == 0 )
+        {
+            continue;
+        }
+        
+        // Levels are requested one at a time so each can be checked against
+        // the memory budget
+        if( stream.finished() )
+        {
+            auto const next   = stream.resident_level() - 1;
+            auto const needed = stream.level_bytes( next );
+            
+            // Nothing is evicted to make room until there's something to fill
+            // it with
+            if( !reload_data( e, next ) )
+            {
+                continue;
+            }
+            
+            if( budget > 0 )
+            {
+                while(
+                    resident + needed > budget
+                    && oldest != by_age.end()
+                    && !recent( **oldest )
+                )
+                {
+                    if( auto const freed = evict_one_level( **oldest ); freed )
+                    {
+                        resident -= freed;
+                    }
+                    else
+                    {
+                        ++oldest;
+                    }
+                }
+                if( resident + needed > budget )
+                {
+                    continue;
+                }
+            }
+            
+            stream.target_level( next );
+            resident += needed;
+        }
+        
+        if( stream.upload_some() )
+        {
+            ++streamed_levels_;
+        }
+    }
+}
+
+JadeMatrix::yavsg::texture_residency_counters
+JadeMatrix::yavsg::texture_residency::counts() const
+{
+    texture_residency_counters counters;
+    for( auto const& [ gl_id, e ] : entries_ )
+    {
+        counters.resident_bytes += e.stream.allocated_bytes();
+    }
+    counters.textures        = entries_.size();
+    counters.streamed_levels = streamed_levels_;
+    counters.evicted_levels  = evicted_levels_;
+    return counters;
+}
+
+std::size_t JadeMatrix::yavsg::texture_residency::evict_one_level( entry& e )
+{
+    auto& stream = e.stream;
+    auto const before = stream.allocated_bytes();
+    
+    // A level that's still being streamed in goes first, as it isn't being
+    // sampled yet
+    if( !stream.finished() )
+    {
+        stream.target_level( stream.resident_level() );
+    }
+    
+    if( stream.allocated_bytes() == before )
+    {
+        if( stream.resident_level() + 1 >= stream.level_count() )
+        {
+            return 0;
+        }
+        stream.target_level( stream.resident_level() + 1 );
+        ++evicted_levels_;
+    }
+    
+    return before - stream.allocated_bytes();
+}
+
+bool JadeMatrix::yavsg::texture_residency::reload_data(
+    entry&      e,
+    std::size_t level
+)
+{
+    if( e.stream.level_data_available( level ) )
+    {
+        return true;
+    }
+    if( !e.source )
+    {
+        return false;
+    }
+    
+    if( !e.reload )
+    {
+        e.reload = std::make_shared< reloaded_data >();
+        submit_task( std::make_unique<
+            reload_texture_data_task< reloaded_data >
+        >( e.source, e.reload ) );
+        return false;
+    }
+    if( !e.reload->ready.load( std::memory_order_acquire ) )
+    {
+        return false;
+    }
+    
+    auto const reload = std::move( e.reload );
+    try
+    {
+        e.stream.restore_data( std::move( reload->layers ) );
+    }
+    catch( std::invalid_argument const& error )
+    {
+        // Either the reload failed or the source changed since it was first
+        // loaded; either way the texture stays at the detail it has
+        log_.warning(
+            "Texture {} can't be streamed in any further: {}"sv,
+            e.stream.gl_texture_id(),
+            error.what()
+        );
+        e.source = {};
+        return false;
+    }
+    return e.stream.level_data_available( level );
+}
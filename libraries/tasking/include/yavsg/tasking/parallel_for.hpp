@@ -0,0 +1,19 @@
+#pragma once
+
+
+#include <cstddef>      // size_t
+#include <functional>   // function
+
+
+namespace JadeMatrix::yavsg
+{
+    // Calls `body( i )` for every `i` in [0, count), spreading the calls over
+    // idle task workers.  The calling thread also takes part, so this can be
+    // called from any task (including ones pinned to the GPU thread) without
+    // deadlocking even if no other worker is free.  Returns once every call
+    // has completed; if any calls threw, the first exception is rethrown.
+    void parallel_for(
+        std::size_t                                 count,
+        std::function< void( std::size_t ) > const& body
+    );
+}
@@ -25,6 +25,10 @@ namespace JadeMatrix::yavsg
     
     void become_task_worker( task_worker_flags_type = task_worker_flag::none );
     
+    // Number of workers started by `initialize_task_system()`, not counting
+    // any threads that called `become_task_worker()` themselves
+    std::size_t task_worker_count();
+    
     void initialize_task_system( bool main_will_task = true );
     void initialize_task_system( std::size_t worker_count );
     // Synchronous, must be called before main thread exits, and after
@@ -0,0 +1,120 @@
+#include <yavsg/tasking/parallel_for.hpp>
+
+#include <yavsg/tasking/task.hpp>
+#include <yavsg/tasking/tasking.hpp>
+
+#include <algorithm>            // min
+#include <atomic>
+#include <condition_variable>
+#include <exception>            // exception_ptr, current_exception
+#include <memory>               // shared_ptr, make_shared, make_unique
+#include <mutex>
+#include <utility>              // move
+
+
+namespace
+{
+    struct parallel_for_state
+    {
+        // Only dereferenced after claiming an index < `count`, which means the
+        // caller of `parallel_for()` is still waiting and `body` is alive
+        std::function< void( std::size_t ) > const* body;
+        std::size_t                                 count;
+        
+        std::atomic< std::size_t > next_index{ 0 };
+        
+        std::mutex              completion_mutex;
+        std::condition_variable completion_condition;
+        std::size_t             completed = 0;
+        std::exception_ptr      first_error;
+    };
+    
+    void run_parallel_for_iterations( parallel_for_state& state )
+    {
+        std::size_t ran = 0;
+        
+        for(
+            auto index = state.next_index.fetch_add( 1 );
+            index < state.count;
+            index = state.next_index.fetch_add( 1 )
+        )
+        {
+            try
+            {
+                ( *state.body )( index );
+            }
+            catch( ... )
+            {
+                std::unique_lock lock( state.completion_mutex );
+                if( !state.first_error )
+                {
+                    state.first_error = std::current_exception();
+                }
+            }
+            ++ran;
+        }
+        
+        if( ran > 0 )
+        {
+            std::unique_lock lock( state.completion_mutex );
+            state.completed += ran;
+            if( state.completed == state.count )
+            {
+                state.completion_condition.notify_all();
+            }
+        }
+    }
+    
+    class parallel_for_task : public JadeMatrix::yavsg::task
+    {
+    public:
+        parallel_for_task( std::shared_ptr< parallel_for_state > s ) :
+            state_{ std::move( s ) }
+        {}
+        
+        bool operator()() override
+        {
+            run_parallel_for_iterations( *state_ );
+            return false;
+        }
+    
+    protected:
+        std::shared_ptr< parallel_for_state > state_;
+    };
+}
+
+
+void JadeMatrix::yavsg::parallel_for(
+    std::size_t                                 count,
+    std::function< void( std::size_t ) > const& body
+)
+{
+    if( count == 0 )
+    {
+        return;
+    }
+    
+    auto state = std::make_shared< parallel_for_state >();
+    state->body  = &body;
+    state->count = count;
+    
+    // Helpers that start after all the work has been claimed simply exit
+    auto const helper_count = std::min( count - 1, task_worker_count() );
+    for( std::size_t i = 0; i < helper_count; ++i )
+    {
+        submit_task( std::make_unique< parallel_for_task >( state ) );
+    }
+    
+    run_parallel_for_iterations( *state );
+    
+    std::unique_lock lock( state->completion_mutex );
+    state->completion_condition.wait(
+        lock,
+        [ &state ](){ return state->completed == state->count; }
+    );
+    
+    if( state->first_error )
+    {
+        std::rethrow_exception( state->first_error );
+    }
+}
@@ -200,6 +200,11 @@ void JadeMatrix::yavsg::become_task_worker(
     }
 }
 
+std::size_t JadeMatrix::yavsg::task_worker_count()
+{
+    return slaved_workers.size();
+}
+
 void JadeMatrix::yavsg::initialize_task_system( bool main_will_task )
 {
     std::size_t num_workers = std::thread::hardware_concurrency();
@@ -1,12 +1,15 @@
 #include <yavsg/windowsys/frame.hpp>
 
+#include <yavsg/gl/deferred_deletion.hpp>
 #include <yavsg/gl/framebuffer.hpp>
+#include <yavsg/gl/texture_streaming.hpp>
 #include <yavsg/logging.hpp>
 #include <yavsg/rendering/4up_postprocess_step.hpp>
 #include <yavsg/rendering/basic_postprocess_step.hpp>
 #include <yavsg/rendering/dof_postprocess_step.hpp>
 #include <yavsg/rendering/multi_postprocess_step.hpp>
 #include <yavsg/rendering/obj_render_step.hpp>
+#include <yavsg/rendering/texture_residency.hpp>
 #include <yavsg/tasking/tasking.hpp>
 #include <yavsg/tasking/utility_tasks.hpp>
 
@@ -82,6 +85,24 @@ bool JadeMatrix::yavsg::frame_task::operator()()
 {
     auto current_time = std::chrono::high_resolution_clock::now();
     
+    // Objects released since the last frame are freed here, while nothing is
+    // in the middle of using them
+    auto const& deleted = gl::flush_deferred_deletions();
+    for( auto const gl_id : deleted.textures )
+    {
+        texture_residency::instance().remove( gl_id );
+    }
+    for( auto const gl_id : deleted.pooled_textures )
+    {
+        texture_residency::instance().remove( gl_id );
+    }
+    
+    // Mips of on-screen textures are streamed in with whatever the uploads
+    // queued behind the last frame left of its budget, then those queued
+    // behind this one get a fresh budget
+    texture_residency::instance().update();
+    gl::begin_texture_upload_frame();
+    
     std::unique_lock window_reference_lock( window_ref->reference_mutex );
     
     if( !window_ref->window )
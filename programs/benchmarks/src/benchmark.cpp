@@ -0,0 +1,72 @@
+#include "benchmark.hpp"
+
+#include <yavsg/logging.hpp>
+
+#include <algorithm>    // min
+#include <chrono>
+#include <limits>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+    #include <sys/resource.h>   // getrusage
+#endif
+
+
+namespace
+{
+    using namespace std::string_view_literals;
+    
+    auto const log_ = JadeMatrix::yavsg::log_handle();
+}
+
+
+double JadeMatrix::yavsg::benchmarks::time_runs(
+    std::string_view                name,
+    std::size_t                     iterations,
+    std::function< void() > const& body
+)
+{
+    using clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration< double, std::milli >;
+    
+    body();
+    
+    auto fastest = std::numeric_limits< double >::infinity();
+    auto total   = 0.0;
+    for( std::size_t i = 0; i < iterations; ++i )
+    {
+        auto const start = clock::now();
+        body();
+        auto const time = milliseconds( clock::now() - start ).count();
+        
+        fastest = std::min( fastest, time );
+        total  += time;
+    }
+    
+    log_.info(
+        "{}: fastest {:.2f} ms, mean {:.2f} ms over {} runs"sv,
+        name,
+        fastest,
+        total / static_cast< double >( iterations ),
+        iterations
+    );
+    return fastest;
+}
+
+std::size_t JadeMatrix::yavsg::benchmarks::peak_resident_bytes()
+{
+#if defined( __unix__ ) || defined( __APPLE__ )
+    rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    {
+        return 0;
+    }
+    #ifdef __APPLE__
+        return static_cast< std::size_t >( usage.ru_maxrss );
+    #else
+        // Linux & the BSDs report kibibytes
+        return static_cast< std::size_t >( usage.ru_maxrss ) * 1024;
+    #endif
+#else
+    return 0;
+#endif
+}
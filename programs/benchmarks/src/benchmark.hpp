@@ -0,0 +1,28 @@
+#pragma once
+
+
+#include <cstddef>      // size_t
+#include <functional>
+#include <string_view>
+
+
+namespace JadeMatrix::yavsg::benchmarks
+{
+    // Runs `body` once to warm up (filling lookup tables, faulting in pages,
+    // &c.), then `iterations` more times, & logs the fastest & mean wall-clock
+    // times; returns the fastest in milliseconds
+    double time_runs(
+        std::string_view                name,
+        std::size_t                     iterations,
+        std::function< void() > const& body
+    );
+    
+    // Largest resident set size the process has had so far in bytes, or 0
+    // where that isn't available
+    std::size_t peak_resident_bytes();
+    
+    // Each of these logs its own results
+    void texture_preprocessing();
+    void texture_loading();
+    void obj_parsing();
+}
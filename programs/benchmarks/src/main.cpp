@@ -0,0 +1,98 @@
+// Timings for the engine's CPU-side asset processing, which otherwise only
+// show up as slow loading; run with benchmark names to pick which to run, or
+// with none to run them all.
+
+#include "benchmark.hpp"
+
+#include <yavsg/asserts.hpp>
+#include <yavsg/logging.hpp>
+#include <yavsg/tasking/tasking.hpp>
+
+#include <algorithm>    // find_if
+#include <array>
+#include <exception>
+#include <string_view>
+#include <utility>      // pair
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    std::array< std::pair< std::string_view, void(*)() >, 3 > const all = {{
+        {
+            "texture_preprocessing"sv,
+            yavsg::benchmarks::texture_preprocessing
+        },
+        {
+            "texture_loading"sv,
+            yavsg::benchmarks::texture_loading
+        },
+        {
+            "obj_parsing"sv,
+            yavsg::benchmarks::obj_parsing
+        },
+    }};
+}
+
+
+int main( int argc, char* argv[] )
+{
+    doctest::Context global_doctest_context;
+    global_doctest_context.setAsDefaultForAssertsOutOfTestCases();
+    global_doctest_context.setAssertHandler( yavsg::doctest_assert_handler );
+    
+    for( int i = 1; i < argc; ++i )
+    {
+        auto const name = std::string_view{ argv[ i ] };
+        auto const found = std::find_if(
+            all.begin(),
+            all.end(),
+            [ & ]( auto const& benchmark ){ return benchmark.first == name; }
+        );
+        if( found == all.end() )
+        {
+            log_.error( "Unknown benchmark \"{}\""sv, name );
+            return -1;
+        }
+    }
+    
+    try
+    {
+        // As in the texture cooker, the main thread only waits on
+        // `parallel_for()`s, so give every hardware thread to the workers
+        yavsg::initialize_task_system( false );
+        
+        for( auto const& [ name, run ] : all )
+        {
+            auto selected = ( argc < 2 );
+            for( int i = 1; i < argc; ++i )
+            {
+                selected = selected || std::string_view{ argv[ i ] } == name;
+            }
+            if( selected )
+            {
+                log_.info( "Running {}"sv, name );
+                run();
+            }
+        }
+        
+        yavsg::stop_task_system( true );
+        return 0;
+    }
+    catch( std::exception const& e )
+    {
+        log_.error( "Program exiting: {}"sv, e.what() );
+    }
+    catch( ... )
+    {
+        log_.error( "Program exiting due to uncaught non-std::exception"sv );
+    }
+    
+    yavsg::stop_task_system( true );
+    return -1;
+}
@@ -0,0 +1,156 @@
+#include "benchmark.hpp"
+
+#include <yavsg/logging.hpp>
+#include <yavsg/rendering/obj.hpp>          // build_obj_mesh
+#include <yavsg/rendering/obj_parser.hpp>
+
+#include <fmt/format.h>
+#include <tiny_obj_loader.h>
+
+#include <cstddef>      // size_t
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>    // runtime_error
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    // A grid of quads with positions, normals, & texture coordinates, like a
+    // scanned mesh; about 40 MiB of text
+    constexpr std::size_t grid_size  = 512;
+    constexpr std::size_t iterations = 3;
+    
+    // Every face needs a material to be built into a mesh
+    void write_test_mesh( std::filesystem::path const& directory )
+    {
+        std::ofstream( directory / "grid.mtl" ) << "newmtl grid\n";
+        
+        std::ofstream out(
+            directory / "grid.obj",
+            std::ios::binary | std::ios::trunc
+        );
+        out << "mtllib grid.mtl\n";
+        auto const points = grid_size + 1;
+        auto const size   = static_cast< double >( grid_size );
+        
+        std::string line;
+        for( std::size_t y = 0; y < points; ++y )
+        {
+            for( std::size_t x = 0; x < points; ++x )
+            {
+                auto const u = static_cast< double >( x ) / size;
+                auto const v = static_cast< double >( y ) / size;
+                line = fmt::format(
+                    "v {:.6f} {:.6f} {:.6f}\nvn {:.6f} {:.6f} {:.6f}\n"
+                        "vt {:.6f} {:.6f}\n"sv,
+                    u * 10.0 - 5.0,
+                    u * v,
+                    v * 10.0 - 5.0,
+                    -v,
+                    1.0,
+                    -u,
+                    u,
+                    v
+                );
+                out << line;
+            }
+        }
+        out << "usemtl grid\n";
+        for( std::size_t y = 0; y < grid_size; ++y )
+        {
+            for( std::size_t x = 0; x < grid_size; ++x )
+            {
+                auto const corner = [ & ]( std::size_t dx, std::size_t dy ){
+                    auto const index = ( y + dy ) * points + x + dx + 1;
+                    return fmt::format( "{0}/{0}/{0}"sv, index );
+                };
+                out << "f " << corner( 0, 0 ) << ' ' << corner( 1, 0 ) << ' '
+                    << corner( 1, 1 ) << ' ' << corner( 0, 1 ) << '\n';
+            }
+        }
+    }
+}
+
+
+void JadeMatrix::yavsg::benchmarks::obj_parsing()
+{
+    auto const directory = (
+        std::filesystem::temp_directory_path() / "yavsg-benchmarks-obj"
+    );
+    std::filesystem::create_directories( directory );
+    write_test_mesh( directory );
+    auto const filename = directory / "grid.obj";
+    
+    auto const megabytes = static_cast< double >(
+        std::filesystem::file_size( filename )
+    ) / ( 1024.0 * 1024.0 );
+    
+    obj_data obj;
+    auto const parse_time = time_runs(
+        fmt::format( "Parse {:.1f} MiB OBJ file"sv, megabytes ),
+        iterations,
+        [ & ](){ obj = parse_obj_file( filename, directory ); }
+    );
+    log_.info(
+        "Parsed {:.1f} MiB/s; {} positions, {} triangles"sv,
+        megabytes / ( parse_time / 1000.0 ),
+        obj.vertices.size() / 3,
+        obj.indices.size() / 3
+    );
+    
+    // What the engine used before its own parser, which reads the whole file
+    // on one thread
+    tinyobj::attrib_t                  attributes;
+    std::vector< tinyobj::shape_t    > shapes;
+    std::vector< tinyobj::material_t > materials;
+    auto const mtl_directory = ( directory / "" ).string();
+    auto const tinyobj_time  = time_runs(
+        fmt::format(
+            "Parse {:.1f} MiB OBJ file with tinyobjloader"sv,
+            megabytes
+        ),
+        iterations,
+        [ & ](){
+            attributes = {};
+            shapes   .clear();
+            materials.clear();
+            std::string error;
+            if( !tinyobj::LoadObj(
+                &attributes,
+                &shapes,
+                &materials,
+                &error,
+                filename.string().c_str(),
+                mtl_directory.c_str()
+            ) )
+            {
+                throw std::runtime_error( fmt::format(
+                    "tinyobjloader couldn't load test mesh: {}"sv,
+                    error
+                ) );
+            }
+        }
+    );
+    log_.info(
+        "tinyobjloader parsed {:.1f} MiB/s; the engine's parser is {:.1f}x as "
+            "fast"sv,
+        megabytes / ( tinyobj_time / 1000.0 ),
+        tinyobj_time / parse_time
+    );
+    
+    time_runs(
+        "Build deduplicated mesh"sv,
+        iterations,
+        [ & ](){ build_obj_mesh( obj ); }
+    );
+    
+    std::filesystem::remove_all( directory );
+}
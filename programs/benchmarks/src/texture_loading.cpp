@@ -0,0 +1,138 @@
+#include "benchmark.hpp"
+
+#include <yavsg/gl/texture_utilities.hpp>
+#include <yavsg/logging.hpp>
+#include <yavsg/rendering/texture_reference.hpp>   // load_texture_file
+#include <yavsg/sdl/sdl.hpp>
+#include <yavsg/tasking/parallel_for.hpp>
+
+#include <fmt/format.h>
+
+#include <cstddef>      // size_t
+#include <cstdint>      // uint8_t
+#include <filesystem>
+#include <stdexcept>    // runtime_error
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    constexpr std::size_t width      = 2048;
+    constexpr std::size_t height     = 2048;
+    constexpr std::size_t file_count = 16;
+    constexpr std::size_t iterations = 3;
+    
+    // BMPs decode quickly, so most of the time is the engine's own conversion,
+    // preprocessing, & mip generation
+    std::vector< std::filesystem::path > write_test_images(
+        std::filesystem::path const& directory
+    )
+    {
+        std::vector< std::filesystem::path > files;
+        for( std::size_t i = 0; i < file_count; ++i )
+        {
+            auto surface = SDL_CreateRGBSurfaceWithFormat(
+                0,
+                static_cast< int >( width ),
+                static_cast< int >( height ),
+                32,
+                SDL_PIXELFORMAT_RGBA32
+            );
+            if( !surface )
+            {
+                throw std::runtime_error( fmt::format(
+                    "failed to create test image: {}"sv,
+                    SDL_GetError()
+                ) );
+            }
+            
+            for( std::size_t y = 0; y < height; ++y )
+            {
+                auto const row = static_cast< std::uint8_t* >(
+                    surface->pixels
+                ) + y * static_cast< std::size_t >( surface->pitch );
+                for( std::size_t x = 0; x < width * 4; ++x )
+                {
+                    row[ x ] = static_cast< std::uint8_t >( x * 7 + y * 13 + i );
+                }
+            }
+            
+            files.push_back( directory / fmt::format( "{}.bmp"sv, i ) );
+            auto const saved = SDL_SaveBMP(
+                surface,
+                files.back().string().c_str()
+            );
+            SDL_FreeSurface( surface );
+            if( saved != 0 )
+            {
+                throw std::runtime_error( fmt::format(
+                    "failed to write test image: {}"sv,
+                    SDL_GetError()
+                ) );
+            }
+        }
+        return files;
+    }
+}
+
+
+void JadeMatrix::yavsg::benchmarks::texture_loading()
+{
+    auto const directory = (
+        std::filesystem::temp_directory_path() / "yavsg-benchmarks-textures"
+    );
+    std::filesystem::create_directories( directory );
+    auto const files = write_test_images( directory );
+    
+    using settings = gl::texture_filter_settings;
+    settings const mipmapped{
+        settings::magnify_mode::linear,
+        settings::minify_mode::linear,
+        settings::mipmap_type::linear
+    };
+    
+    auto const peak_before = peak_resident_bytes();
+    auto const name = fmt::format(
+        "Load {} {}x{} RGBA8 textures with mipmaps"sv,
+        file_count,
+        width,
+        height
+    );
+    time_runs( name, iterations, [ & ](){
+        parallel_for( files.size(), [ & ]( std::size_t i ){
+            // Dropped right away, as streamed textures' data is once it's
+            // resident
+            load_texture_file(
+                files[ i ],
+                gl::texture_flag::none,
+                mipmapped,
+                GL_RGBA8
+            );
+        } );
+    } );
+    auto const peak_after = peak_resident_bytes();
+    
+    std::filesystem::remove_all( directory );
+    
+    if( peak_after == 0 )
+    {
+        log_.info( "Peak resident memory isn't available on this platform"sv );
+        return;
+    }
+    constexpr auto mebibyte = 1024.0 * 1024.0;
+    // The peak covers the whole process, so this is only meaningful when the
+    // benchmark is run on its own
+    log_.info(
+        "Peak resident memory: {:.1f} MiB, {:.1f} MiB more than before "
+            "loading"sv,
+        static_cast< double >( peak_after ) / mebibyte,
+        static_cast< double >( peak_after - peak_before ) / mebibyte
+    );
+}
@@ -0,0 +1,177 @@
+#include "benchmark.hpp"
+
+#include <yavsg/gl/texture_utilities.hpp>
+#include <yavsg/logging.hpp>
+#include <yavsg/tasking/parallel_for.hpp>
+
+#include <algorithm>    // max
+#include <cmath>        // pow, abs
+#include <cstddef>      // size_t, byte
+#include <cstdint>      // uint8_t, uint16_t
+#include <cstring>      // memcpy
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    // A 4K RGBA texture, large enough that loading one is noticeable
+    constexpr std::size_t width      = 4096;
+    constexpr std::size_t height     = 4096;
+    constexpr std::size_t iterations = 5;
+    
+    // Varying color & alpha, so neither the opaque shortcut nor a lucky table
+    // row skews the timing
+    template< typename T > std::vector< T > test_pattern()
+    {
+        constexpr auto shift = ( sizeof( T ) - 1 ) * 8;
+        std::vector< T > pixels( width * height * 4 );
+        for( std::size_t y = 0; y < height; ++y )
+        {
+            for( std::size_t x = 0; x < width; ++x )
+            {
+                auto const pixel = &pixels[ ( y * width + x ) * 4 ];
+                for( std::size_t c = 0; c < 3; ++c )
+                {
+                    pixel[ c ] = static_cast< T >(
+                        ( ( x * 7 + y * 13 + c * 61 ) & 0xFF ) << shift
+                    );
+                }
+                pixel[ 3 ] = static_cast< T >( ( ( x ^ y ) & 0xFF ) << shift );
+            }
+        }
+        return pixels;
+    }
+    
+    // The per-sample `double` & `pow()` path the lookup tables replaced, kept
+    // here to compare against; split into rows over the workers, as
+    // `process_texture_data()` is
+    void reference_preprocess( std::uint8_t* pixels, std::size_t pixel_count )
+    {
+        auto const linearize = []( double sample ){
+            return ( sample <= 0.04045
+                ? sample / 12.92
+                : std::pow( ( sample + 0.055 ) / 1.055, 2.4 )
+            );
+        };
+        for( std::size_t i = 0; i < pixel_count; ++i )
+        {
+            auto const pixel = pixels + i * 4;
+            auto const alpha = static_cast< double >( pixel[ 3 ] ) / 255.0;
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                auto const sample = static_cast< double >( pixel[ c ] ) / 255.0;
+                pixel[ c ] = static_cast< std::uint8_t >(
+                    linearize( sample * alpha ) * 255.0
+                );
+            }
+        }
+    }
+    
+    template< typename T > yavsg::gl::texture_upload_data copy_for_upload(
+        std::vector< T > const& pixels,
+        GLint                   gl_internal_format,
+        GLenum                  gl_incoming_type
+    )
+    {
+        auto const size = pixels.size() * sizeof( T );
+        yavsg::gl::texture_upload_data upload_data{
+            gl_internal_format,
+            width,
+            height,
+            GL_RGBA,
+            gl_incoming_type,
+            yavsg::gl::make_texture_data( size ),
+            {}
+        };
+        std::memcpy( upload_data.data.get(), pixels.data(), size );
+        return upload_data;
+    }
+    
+    using settings = yavsg::gl::texture_filter_settings;
+    settings const no_mipmaps{
+        settings::magnify_mode::linear,
+        settings::minify_mode::linear,
+        settings::mipmap_type::none
+    };
+}
+
+
+void JadeMatrix::yavsg::benchmarks::texture_preprocessing()
+{
+    // Each run starts from a fresh copy, as preprocessing happens in place;
+    // the copy is timed on its own so it can be subtracted
+    auto const pixels_8 = test_pattern< std::uint8_t >();
+    auto const copy_time = time_runs(
+        "Copy RGBA8"sv,
+        iterations,
+        [ & ](){
+            copy_for_upload( pixels_8, GL_RGBA8, GL_UNSIGNED_BYTE );
+        }
+    );
+    
+    std::vector< std::uint8_t > reference;
+    auto const reference_time = time_runs(
+        "Premultiply & linearize RGBA8, per-sample pow()"sv,
+        iterations,
+        [ & ](){
+            reference = pixels_8;
+            yavsg::parallel_for( height, [ & ]( std::size_t y ){
+                reference_preprocess(
+                    reference.data() + y * width * 4,
+                    width
+                );
+            } );
+        }
+    );
+    
+    yavsg::gl::texture_upload_data processed;
+    auto const lut_time = time_runs(
+        "Premultiply & linearize RGBA8, lookup tables"sv,
+        iterations,
+        [ & ](){
+            processed = yavsg::gl::process_texture_data(
+                copy_for_upload( pixels_8, GL_RGBA8, GL_UNSIGNED_BYTE ),
+                yavsg::gl::texture_flag::none,
+                no_mipmaps
+            );
+        }
+    );
+    
+    // The tables are meant to be bit-identical to the old path for 8-bit data
+    auto const processed_pixels = reinterpret_cast< std::uint8_t const* >(
+        processed.data.get()
+    );
+    int max_difference = 0;
+    for( std::size_t i = 0; i < reference.size(); ++i )
+    {
+        max_difference = std::max( max_difference, std::abs(
+            static_cast< int >( processed_pixels[ i ] )
+            - static_cast< int >( reference[ i ] )
+        ) );
+    }
+    log_.info(
+        "Lookup tables are {:.1f}x as fast excluding the copy; largest "
+            "difference from pow() is {}"sv,
+        ( reference_time - copy_time ) / std::max( lut_time - copy_time, 0.01 ),
+        max_difference
+    );
+    
+    auto const pixels_16 = test_pattern< std::uint16_t >();
+    time_runs(
+        "Premultiply & linearize RGBA16, lookup table"sv,
+        iterations,
+        [ & ](){
+            processed = yavsg::gl::process_texture_data(
+                copy_for_upload( pixels_16, GL_RGBA16, GL_UNSIGNED_SHORT ),
+                yavsg::gl::texture_flag::none,
+                no_mipmaps
+            );
+        }
+    );
+}
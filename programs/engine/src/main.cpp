@@ -46,7 +46,7 @@ int main( int argc, char* argv[] )
     {
         log_.error(
             "Usage: env YAVSG_SHADERS_DIR=<shaders-dir> {} <obj-file> "
-                "<materials-dir>"sv,
+                "<materials-dir> [<occluder-obj-file>]"sv,
             argv[ 0 ]
         );
         return -1;
@@ -103,6 +103,18 @@ int main( int argc, char* argv[] )
             argv[ 2 ]
         ) );
         
+        // Occlusion culling only hides objects behind meshes marked as
+        // occluders, which should be large & simple; they're drawn as well
+        if( argc >= 4 )
+        {
+            submit_task( std::make_unique< yavsg::load_obj_task >(
+                test_window->main_scene.object_manager,
+                argv[ 3 ],
+                argv[ 2 ],
+                true
+            ) );
+        }
+        
         SDL_SetRelativeMouseMode( SDL_TRUE );
         
         yavsg::event_listener< SDL_MouseMotionEvent > camera_look_listener{
@@ -0,0 +1,180 @@
+// Offline texture cooker: preprocesses an image the same way the engine would
+// when loading it, generates its mip chain, block-compresses every level, &
+// writes the result to a KTX file that the engine can upload directly.
+
+#include <yavsg/asserts.hpp>
+#include <yavsg/gl/ktx.hpp>
+#include <yavsg/gl/texture_compression.hpp>
+#include <yavsg/gl/texture_utilities.hpp>
+#include <yavsg/logging.hpp>
+#include <yavsg/tasking/tasking.hpp>
+
+#include <SDL2/SDL_image.h>
+
+#include <exception>
+#include <optional>
+#include <string_view>
+#include <utility>      // move
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    auto const log_ = yavsg::log_handle();
+    
+    std::optional< yavsg::gl::block_compression > parse_compression(
+        std::string_view name
+    )
+    {
+        using yavsg::gl::block_compression;
+        if( name == "bc1"sv ) return block_compression::bc1;
+        if( name == "bc3"sv ) return block_compression::bc3;
+        if( name == "bc4"sv ) return block_compression::bc4;
+        if( name == "bc5"sv ) return block_compression::bc5;
+        if( name == "bc7"sv ) return block_compression::bc7;
+        return std::nullopt;
+    }
+    
+    // The uncompressed format the image is preprocessed for, which decides
+    // whether alpha is premultiplied & whether the data is kept sRGB-encoded
+    GLint preprocess_format(
+        yavsg::gl::block_compression compression,
+        bool                         srgb
+    )
+    {
+        using yavsg::gl::block_compression;
+        switch( compression )
+        {
+        case block_compression::bc1: return srgb ? GL_SRGB8        : GL_RGB8 ;
+        case block_compression::bc3:
+        case block_compression::bc7: return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        case block_compression::bc4: return GL_R8 ;
+        case block_compression::bc5: return GL_RG8;
+        }
+        return GL_RGBA8;
+    }
+}
+
+
+int main( int argc, char* argv[] )
+{
+    doctest::Context global_doctest_context;
+    global_doctest_context.setAsDefaultForAssertsOutOfTestCases();
+    global_doctest_context.setAssertHandler( yavsg::doctest_assert_handler );
+    
+    std::optional< yavsg::gl::block_compression > compression;
+    if( argc >= 4 )
+    {
+        compression = parse_compression( argv[ 3 ] );
+    }
+    if( !compression )
+    {
+        log_.error(
+            "Usage: {} <image-file> <ktx-file> bc1|bc3|bc4|bc5|bc7 [linear] "
+                "[no-mipmaps]"sv,
+            argv[ 0 ]
+        );
+        return -1;
+    }
+    
+    // Color data is kept sRGB-encoded unless it's marked as linear or the
+    // format has no sRGB variant
+    auto srgb    = (
+           *compression != yavsg::gl::block_compression::bc4
+        && *compression != yavsg::gl::block_compression::bc5
+    );
+    auto mipmaps = true;
+    for( int i = 4; i < argc; ++i )
+    {
+        auto const option = std::string_view{ argv[ i ] };
+        if( option == "linear"sv )
+        {
+            srgb = false;
+        }
+        else if( option == "no-mipmaps"sv )
+        {
+            mipmaps = false;
+        }
+        else
+        {
+            log_.error( "Unknown option \"{}\""sv, option );
+            return -1;
+        }
+    }
+    
+    try
+    {
+        // The main thread only waits on `parallel_for()`s, which it also takes
+        // part in, so give every hardware thread to the workers
+        yavsg::initialize_task_system( false );
+        
+        SDL_Surface* sdl_surface = IMG_Load( argv[ 1 ] );
+        if( !sdl_surface )
+        {
+            log_.error(
+                "Failed to load image \"{}\": {}"sv,
+                argv[ 1 ],
+                IMG_GetError()
+            );
+            yavsg::stop_task_system( true );
+            return -1;
+        }
+        
+        using settings = yavsg::gl::texture_filter_settings;
+        
+        // Keep the file's encoding as-is, as linearizing into 8 bits would just
+        // lose precision; sRGB data is decoded by OpenGL when sampled instead
+        auto upload_data = yavsg::gl::process_texture_data(
+            sdl_surface,
+            yavsg::gl::texture_flag::linear_input,
+            {
+                settings::magnify_mode::linear,
+                settings::minify_mode::linear,
+                (
+                    mipmaps
+                    ? settings::mipmap_type::linear
+                    : settings::mipmap_type::none
+                )
+            },
+            preprocess_format( *compression, srgb )
+        );
+        
+        auto const width  = upload_data.width;
+        auto const height = upload_data.height;
+        auto const levels = upload_data.mipmaps.size() + 1;
+        
+        yavsg::gl::write_ktx_file(
+            argv[ 2 ],
+            yavsg::gl::compress_texture_data(
+                std::move( upload_data ),
+                *compression,
+                srgb
+            )
+        );
+        
+        log_.info(
+            "Wrote {}x{} texture with {} mip level(s) to \"{}\""sv,
+            width,
+            height,
+            levels,
+            argv[ 2 ]
+        );
+        
+        yavsg::stop_task_system( true );
+        return 0;
+    }
+    catch( std::exception const& e )
+    {
+        log_.error( "Program exiting: {}"sv, e.what() );
+    }
+    catch( ... )
+    {
+        log_.error( "Program exiting due to uncaught non-std::exception"sv );
+    }
+    
+    yavsg::stop_task_system( true );
+    return -1;
+}
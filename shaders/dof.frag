@@ -16,12 +16,14 @@ out vec4 fragment_out_color;
 uniform sampler2D framebuffer_source_color;
 uniform sampler2D framebuffer_source_depth;
 
-uniform struct
+layout( std140 ) uniform CAMERA
 {
+    mat4  view;
+    mat4  projection;
     float near;
     float focal;
     float far;
-} camera_point;
+} camera;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -29,10 +31,10 @@ float linear_depth( float depth )
 {
     depth = 2 * depth - 1;
     return (
-        2 * camera_point.near * camera_point.far / (
-              camera_point.far
-            + camera_point.near
-            - depth * ( camera_point.far - camera_point.near )
+        2 * camera.near * camera.far / (
+              camera.far
+            + camera.near
+            - depth * ( camera.far - camera.near )
         )
     );
 }
@@ -42,7 +44,7 @@ void main()
     float depth = texture( framebuffer_source_depth, fragment_in.texture ).r;
     
     float linearized_depth = linear_depth( depth );
-    depth -= camera_point.focal / linearized_depth;
+    depth -= camera.focal / linearized_depth;
     if( depth < 0 )
         depth = 0;
     
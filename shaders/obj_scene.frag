@@ -10,9 +10,18 @@ in VERTEX_OUT
     // mat4 TBN_matrix;
 } fragment_in;
 
-uniform sampler2D map_color;
-// uniform sampler2D map_normal;
-// uniform sampler2D map_specular;
+// Material maps are packed into texture arrays, so each material only carries
+// the layer its maps are in
+uniform sampler2DArray map_color;
+// uniform sampler2DArray map_normal;
+// uniform sampler2DArray map_specular;
+
+layout( std140 ) uniform MATERIAL
+{
+    int color_layer;
+    int normal_layer;
+    int specular_layer;
+} material;
 
 // Output //////////////////////////////////////////////////////////////////////
 
@@ -35,17 +44,19 @@ void main()
 {
     fragment_out_color = texture(
         map_color,
-        vec2(
+        vec3(
                   fragment_in.texture.x,
-            1.0 - fragment_in.texture.y
+            1.0 - fragment_in.texture.y,
+            material.color_layer
         )
     );
     
     // vec3 normal = texture(
     //     map_normal,
-    //     vec2(
+    //     vec3(
     //               fragment_in.texture.x,
-    //         1.0 - fragment_in.texture.y
+    //         1.0 - fragment_in.texture.y,
+    //         material.normal_layer
     //     )
     // ).xyz;
     // if( !valid_normal( normal ) )
@@ -56,9 +67,10 @@ void main()
     // // if( has_map_specular )
     // //     fragment_out_color += texture(
     // //         map_specular,
-    // //         vec2(
+    // //         vec3(
     // //                   fragment_in.texture.x,
-    // //             1.0 - fragment_in.texture.y
+    // //             1.0 - fragment_in.texture.y,
+    // //             material.specular_layer
     // //         )
     // //     );
 }
@@ -3,7 +3,7 @@
 // Input ///////////////////////////////////////////////////////////////////////
 
 in vec3 vertex_in_position; // position XYZ
-// in vec3 vertex_in_normal;   // normal   XYZ
+// in vec2 vertex_in_normal;   // normal   octahedral-encoded XY
 // in vec3 vertex_in_tangent;  // tangent  XYZ
 in vec3 vertex_in_color;    // color    RGB
 in vec2 vertex_in_texture;  // texture  UV
@@ -11,10 +11,17 @@ in vec2 vertex_in_texture;  // texture  UV
 uniform struct
 {
     mat4 model;
-    mat4 view;
-    mat4 projection;
 } transform;
 
+layout( std140 ) uniform CAMERA
+{
+    mat4  view;
+    mat4  projection;
+    float near;
+    float focal;
+    float far;
+} camera;
+
 // Output //////////////////////////////////////////////////////////////////////
 
 out VERTEX_OUT
@@ -27,11 +34,24 @@ out VERTEX_OUT
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Inverse of `octahedral_encode()` in `scene.cpp`, for `vertex_in_normal` once
+// it's enabled: lifts the point back onto the octahedron, folding the lower
+// half back out if it's outside the center diamond
+vec3 oct_decode( vec2 encoded )
+{
+    vec3 normal = vec3( encoded, 1.0 - abs( encoded.x ) - abs( encoded.y ) );
+    if( normal.z < 0.0 )
+    {
+        normal.xy = ( 1.0 - abs( normal.yx ) ) * sign( normal.xy );
+    }
+    return normalize( normal );
+}
+
 void main()
 {
     gl_Position = (
-          transform.projection
-        * transform.view
+          camera.projection
+        * camera.view
         * transform.model
         * vec4(
             vertex_in_position.x,
@@ -3,7 +3,7 @@
 // Input ///////////////////////////////////////////////////////////////////////
 
 in vec3 vertex_in_position; // position XYZ
-in vec3 vertex_in_normal;   // normal   XYZ
+in vec2 vertex_in_normal;   // normal   octahedral-encoded XY
 in vec3 vertex_in_tangent;  // tangent  XYZ
 in vec3 vertex_in_color;    // color    RGB
 in vec2 vertex_in_texture;  // texture  UV
@@ -28,6 +28,19 @@ out VERTEX_OUT
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Inverse of `octahedral_encode()` in `scene.cpp`: lifts the point back onto
+// the octahedron, folding the lower half back out if it's outside the center
+// diamond
+vec3 oct_decode( vec2 encoded )
+{
+    vec3 normal = vec3( encoded, 1.0 - abs( encoded.x ) - abs( encoded.y ) );
+    if( normal.z < 0.0 )
+    {
+        normal.xy = ( 1.0 - abs( normal.yx ) ) * sign( normal.xy );
+    }
+    return normalize( normal );
+}
+
 void main()
 {
     mat4 transform = (
@@ -50,7 +63,9 @@ void main()
     
     vertex_out.position = adjusted_position.xyz;
     
-    vec3 N = normalize( vec3( transform.model * vec4(  vertex_in_normal, 0.0 ) ) );
+    vec3 normal = oct_decode( vertex_in_normal );
+    
+    vec3 N = normalize( vec3( transform.model * vec4(            normal, 0.0 ) ) );
     vec3 T = normalize( vec3( transform.model * vec4( vertex_in_tangent, 0.0 ) ) );
     vec3 B = cross( N, T );
     vertex_out.TBN_matrix = transpose( mat3( T, B, N ) );
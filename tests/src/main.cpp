@@ -0,0 +1,12 @@
+// Unit tests for the parts of the engine that run without a GPU; doctest's
+// implementation is compiled into the logging library.
+
+#include <doctest/doctest.h>
+
+
+int main( int argc, char* argv[] )
+{
+    doctest::Context context;
+    context.applyCommandLine( argc, argv );
+    return context.run();
+}
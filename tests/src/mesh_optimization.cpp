@@ -0,0 +1,193 @@
+#include <yavsg/rendering/mesh_optimization.hpp>
+#include <yavsg/rendering/scene.hpp>
+
+#include <doctest/doctest.h>
+
+#include <algorithm>    // rotate, min_element, sort, shuffle
+#include <array>
+#include <cmath>        // sin, cos
+#include <cstddef>      // size_t
+#include <random>
+#include <tuple>        // get
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using vertex_type = yavsg::scene::vertex_attributes_type;
+    using corner_type = std::array< GLfloat, 3 >;
+    
+    constexpr std::size_t grid_size = 32;
+    
+    // A bumpy grid of quads, so triangles face in different directions for
+    // the overdraw sort
+    std::vector< vertex_type > grid_vertices()
+    {
+        std::vector< vertex_type > vertices;
+        for( std::size_t y = 0; y <= grid_size; ++y )
+        {
+            for( std::size_t x = 0; x <= grid_size; ++x )
+            {
+                auto const u = static_cast< GLfloat >( x );
+                auto const v = static_cast< GLfloat >( y );
+                vertices.emplace_back(
+                    yavsg::vector< GLfloat, 3 >{
+                        u,
+                        v,
+                        std::sin( u * 0.5f ) * std::cos( v * 0.5f ) * 4.0f
+                    },
+                    yavsg::vector< GLfloat, 3 >{ 0.0f, 0.0f, 1.0f },
+                    yavsg::vector< GLfloat, 3 >{ 1.0f, 1.0f, 1.0f },
+                    yavsg::vector< GLfloat, 2 >{ 0.0f, 0.0f }
+                );
+            }
+        }
+        return vertices;
+    }
+    
+    // Triangles in a shuffled order, as a mesh straight out of a loader might
+    // be, so reordering them has something to improve
+    std::vector< GLuint > shuffled_grid_indices()
+    {
+        auto const corner = []( std::size_t x, std::size_t y ){
+            return static_cast< GLuint >( y * ( grid_size + 1 ) + x );
+        };
+        
+        std::vector< std::array< GLuint, 3 > > triangles;
+        for( std::size_t y = 0; y < grid_size; ++y )
+        {
+            for( std::size_t x = 0; x < grid_size; ++x )
+            {
+                triangles.push_back( {
+                    corner( x,     y     ),
+                    corner( x + 1, y     ),
+                    corner( x + 1, y + 1 )
+                } );
+                triangles.push_back( {
+                    corner( x,     y     ),
+                    corner( x + 1, y + 1 ),
+                    corner( x,     y + 1 )
+                } );
+            }
+        }
+        std::shuffle( triangles.begin(), triangles.end(), std::mt19937{ 49 } );
+        
+        std::vector< GLuint > indices;
+        for( auto const& triangle : triangles )
+        {
+            indices.insert( indices.end(), triangle.begin(), triangle.end() );
+        }
+        return indices;
+    }
+    
+    // Every triangle by its corners' positions, starting from the smallest so
+    // that the same triangle compares equal however its corners were rotated
+    // but not if its winding was flipped; sorted, so the result can be
+    // compared as a multiset
+    std::vector< std::array< corner_type, 3 > > triangle_multiset(
+        std::vector< GLuint      > const& indices,
+        std::vector< vertex_type > const& vertices
+    )
+    {
+        std::vector< std::array< corner_type, 3 > > triangles;
+        for( std::size_t i = 0; i + 2 < indices.size(); i += 3 )
+        {
+            std::array< corner_type, 3 > triangle;
+            for( std::size_t c = 0; c < 3; ++c )
+            {
+                auto const& position = std::get< 0 >(
+                    vertices[ indices[ i + c ] ]
+                );
+                triangle[ c ] = { position[ 0 ], position[ 1 ], position[ 2 ] };
+            }
+            std::rotate(
+                triangle.begin(),
+                std::min_element( triangle.begin(), triangle.end() ),
+                triangle.end()
+            );
+            triangles.push_back( triangle );
+        }
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+    }
+}
+
+
+TEST_CASE( "optimize_vertex_cache keeps the triangles & lowers ACMR" )
+{
+    auto const vertices = grid_vertices();
+    auto       indices  = shuffled_grid_indices();
+    auto const expected = triangle_multiset( indices, vertices );
+    
+    auto const before = yavsg::analyze_vertex_cache( indices, vertices.size() );
+    yavsg::optimize_vertex_cache( indices, vertices.size() );
+    auto const after  = yavsg::analyze_vertex_cache( indices, vertices.size() );
+    
+    CHECK( triangle_multiset( indices, vertices ) == expected );
+    
+    // A shuffled grid transforms nearly every corner; a good order for a
+    // regular grid gets well under one vertex per triangle
+    CHECK( before.acmr() > 2.0 );
+    CHECK( after .acmr() < 1.0 );
+    CHECK( after .acmr() < before.acmr() );
+}
+
+TEST_CASE( "optimize_overdraw keeps the triangles" )
+{
+    auto const vertices = grid_vertices();
+    auto       indices  = shuffled_grid_indices();
+    auto const expected = triangle_multiset( indices, vertices );
+    
+    yavsg::optimize_vertex_cache( indices, vertices.size() );
+    yavsg::optimize_overdraw( indices, vertices );
+    
+    CHECK( triangle_multiset( indices, vertices ) == expected );
+}
+
+TEST_CASE( "optimize_vertex_fetch keeps the triangles & drops unused vertices" )
+{
+    auto vertices = grid_vertices();
+    
+    // Two index lists, as from two materials, each using half the grid
+    auto const indices = shuffled_grid_indices();
+    auto const half    = indices.size() / 6 * 3;
+    std::vector< std::vector< GLuint > > index_lists{
+        { indices.begin(),        indices.begin() + half },
+        { indices.begin() + half, indices.end()          }
+    };
+    auto const expected_first  = triangle_multiset(
+        index_lists[ 0 ],
+        vertices
+    );
+    auto const expected_second = triangle_multiset(
+        index_lists[ 1 ],
+        vertices
+    );
+    
+    // Nothing refers to this one
+    vertices.push_back( vertices.front() );
+    auto const vertex_count = vertices.size();
+    
+    yavsg::optimize_vertex_fetch( vertices, index_lists );
+    
+    CHECK( triangle_multiset( index_lists[ 0 ], vertices ) == expected_first  );
+    CHECK( triangle_multiset( index_lists[ 1 ], vertices ) == expected_second );
+    CHECK( vertices.size() == vertex_count - 1 );
+    
+    // Vertices are stored in the order they're first used
+    GLuint next = 0;
+    for( auto const& list : index_lists )
+    {
+        for( auto index : list )
+        {
+            CHECK_LE( index, next );
+            if( index == next )
+            {
+                ++next;
+            }
+        }
+    }
+    CHECK( next == vertices.size() );
+}
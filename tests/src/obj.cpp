@@ -0,0 +1,160 @@
+#include <yavsg/rendering/obj.hpp>
+#include <yavsg/rendering/obj_parser.hpp>
+#include <yavsg/rendering/scene.hpp>
+
+#include <doctest/doctest.h>
+
+#include <cstddef>      // size_t
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <tuple>        // get
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using namespace std::string_view_literals;
+    
+    // A 2x2 grid of quads in one material, so the 24 face corners only use 9
+    // distinct positions
+    constexpr auto grid_obj = (
+        "mtllib grid.mtl\n"
+        "v 0 0 0\nv 1 0 0\nv 2 0 0\n"
+        "v 0 1 0\nv 1 1 0\nv 2 1 0\n"
+        "v 0 2 0\nv 1 2 0\nv 2 2 0\n"
+        "usemtl grid\n"
+        "f 1 2 5 4\nf 2 3 6 5\n"
+        "f 4 5 8 7\nf 5 6 9 8\n"sv
+    );
+    constexpr auto grid_mtl = "newmtl grid\n"sv;
+    
+    yavsg::obj_data parse( std::string_view obj_data )
+    {
+        auto const directory = (
+            std::filesystem::temp_directory_path() / "yavsg-tests-obj"
+        );
+        std::filesystem::create_directories( directory );
+        auto const write = [ & ]( char const* name, std::string_view data ){
+            std::ofstream out(
+                directory / name,
+                std::ios::binary | std::ios::trunc
+            );
+            out.write( data.data(), static_cast< std::streamsize >(
+                data.size()
+            ) );
+        };
+        write( "grid.obj", obj_data );
+        write( "grid.mtl", grid_mtl );
+        
+        auto obj = yavsg::parse_obj_file( directory / "grid.obj", directory );
+        std::filesystem::remove_all( directory );
+        return obj;
+    }
+    
+    std::size_t index_count( yavsg::obj_mesh const& mesh )
+    {
+        std::size_t count = 0;
+        for( auto const& group_indices : mesh.indices )
+        {
+            count += group_indices.size();
+        }
+        return count;
+    }
+}
+
+
+TEST_CASE( "parse_obj_file accepts optional coordinates" )
+{
+    // A lone fourth value is a position's weight rather than a color, & a
+    // texture coordinate's v defaults to 0
+    auto const obj = parse(
+        "mtllib grid.mtl\n"
+        "v 0 0 0 1\nv 1 0 0 0.5 0.25 0.125\nv 0 1 0 2 0.75\n"
+        "vt 0.5\nvt 0.25 0.75 1\n"
+        "usemtl grid\n"
+        "f 1/1 2/2 3/1\n"sv
+    );
+    
+    auto const expected_vertices  = std::vector< GLfloat >{
+        0, 0, 0,  1, 0, 0,  0, 1, 0
+    };
+    auto const expected_colors    = std::vector< GLfloat >{
+        1, 1, 1,  0.5f, 0.25f, 0.125f,  1, 1, 1
+    };
+    auto const expected_texcoords = std::vector< GLfloat >{
+        0.5f, 0,  0.25f, 0.75f
+    };
+    CHECK( obj.vertices  == expected_vertices  );
+    CHECK( obj.colors    == expected_colors    );
+    CHECK( obj.texcoords == expected_texcoords );
+    CHECK( obj.indices.size() == 3 );
+}
+
+
+TEST_CASE( "build_obj_mesh shares vertices between identical corners" )
+{
+    auto const obj = parse( grid_obj );
+    REQUIRE( obj.materials.size() == 1 );
+    REQUIRE( obj.indices  .size() == 24 );
+    
+    auto const shared   = yavsg::build_obj_mesh( obj, true  );
+    auto const unshared = yavsg::build_obj_mesh( obj, false );
+    
+    CHECK( shared  .corner_count == 24 );
+    CHECK( unshared.corner_count == 24 );
+    CHECK( index_count( shared   ) == 24 );
+    CHECK( index_count( unshared ) == 24 );
+    
+    CHECK( shared  .vertices.size() ==  9 );
+    CHECK( unshared.vertices.size() == 24 );
+    
+    // What's uploaded & cached
+    auto const vertex_bytes = []( yavsg::obj_mesh const& mesh ){
+        return mesh.vertices.size() * sizeof( yavsg::scene::vertex_type );
+    };
+#ifdef YAVSG_PACKED_VERTICES
+    REQUIRE( sizeof( yavsg::scene::vertex_type ) == 20 );
+    CHECK( vertex_bytes( shared   ) == 180 );
+    CHECK( vertex_bytes( unshared ) == 480 );
+#else
+    CHECK( vertex_bytes( shared ) * 24 == vertex_bytes( unshared ) * 9 );
+#endif
+    
+    // Both draw the same triangles
+    for( std::size_t i = 0; i < 24; ++i )
+    {
+        CHECK(
+            std::get< 0 >( shared.vertices[ shared.indices[ 0 ][ i ] ] )
+            == std::get< 0 >( unshared.vertices[ unshared.indices[ 0 ][ i ] ] )
+        );
+    }
+}
+
+TEST_CASE( "build_obj_mesh bounds fit the vertices" )
+{
+    // Entirely on the positive side of the origin on X & Z
+    yavsg::obj_data obj;
+    obj.vertices     = { 1, 2, 3,  4, -5, 6,  7, 8, 9 };
+    obj.colors       = std::vector< GLfloat >( obj.vertices.size(), 1.0f );
+    obj.indices      = { { 0, -1, -1 }, { 1, -1, -1 }, { 2, -1, -1 } };
+    obj.material_ids = { 0 };
+    obj.materials.resize( 1 );
+    
+    using vector3 = yavsg::vector< GLfloat, 3 >;
+    auto const origin = vector3{ 0.0f, 0.0f, 0.0f };
+    
+    // Y & Z are swapped the same way as the vertices
+    auto const mesh = yavsg::build_obj_mesh( obj );
+    auto const expected_min = vector3{ 1.0f, 3.0f, -5.0f };
+    auto const expected_max = vector3{ 7.0f, 9.0f,  8.0f };
+    CHECK( mesh.bounds_min == expected_min );
+    CHECK( mesh.bounds_max == expected_max );
+    
+    auto const empty = yavsg::build_obj_mesh( yavsg::obj_data{} );
+    CHECK( empty.vertices.empty() );
+    CHECK( empty.bounds_min == origin );
+    CHECK( empty.bounds_max == origin );
+}
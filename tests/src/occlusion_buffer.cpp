@@ -0,0 +1,124 @@
+#include <yavsg/rendering/occlusion_buffer.hpp>
+
+#include <yavsg/math/matrix.hpp>
+
+#include <doctest/doctest.h>
+
+#include <cstddef>  // size_t
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using point_type = yavsg::occlusion_buffer::point_type;
+    
+    // With an identity transform points are already in clip space, so depth
+    // is `( z + 1 ) / 2`
+    auto const identity = yavsg::identity_matrix< float, 4 >();
+    
+    // Covers the middle half of the screen on both axes at depth 0.5; the
+    // second triangle is wound clockwise, which occluders allow
+    std::vector< point_type > const centered_quad = {
+        { -0.5f, -0.5f, 0.0f },
+        {  0.5f, -0.5f, 0.0f },
+        {  0.5f,  0.5f, 0.0f },
+        
+        { -0.5f, -0.5f, 0.0f },
+        { -0.5f,  0.5f, 0.0f },
+        {  0.5f,  0.5f, 0.0f },
+    };
+    
+    yavsg::occlusion_buffer rasterized_quad()
+    {
+        yavsg::occlusion_buffer buffer{ 64, 32 };
+        buffer.clear();
+        buffer.add_occluder( centered_quad, identity );
+        buffer.rasterize();
+        return buffer;
+    }
+}
+
+
+TEST_CASE( "occlusion_buffer rasterizes a quad over exactly its pixels" )
+{
+    auto const buffer = rasterized_quad();
+    REQUIRE( buffer.width () == 64 );
+    REQUIRE( buffer.height() == 32 );
+    
+    // The quad spans x in [16,48) & y in [8,24); pixels are sampled at their
+    // centers, so none lie on an edge
+    std::size_t mismatches = 0;
+    for( std::size_t y = 0; y < buffer.height(); ++y )
+    {
+        for( std::size_t x = 0; x < buffer.width(); ++x )
+        {
+            auto const inside = x >= 16 && x < 48 && y >= 8 && y < 24;
+            auto const expected = ( inside ? 0.5f : 1.0f );
+            if( buffer.depth_at( x, y ) != doctest::Approx( expected ) )
+            {
+                ++mismatches;
+            }
+        }
+    }
+    CHECK( mismatches == 0 );
+}
+
+TEST_CASE( "occlusion_buffer test_bounds accepts & rejects boxes" )
+{
+    auto const buffer = rasterized_quad();
+    
+    // Behind the quad & within its footprint
+    CHECK_FALSE( buffer.test_bounds(
+        { -0.25f, -0.25f, 0.5f },
+        {  0.25f,  0.25f, 0.8f },
+        identity
+    ) );
+    
+    // In front of the quad
+    CHECK( buffer.test_bounds(
+        { -0.25f, -0.25f, -0.8f },
+        {  0.25f,  0.25f, -0.5f },
+        identity
+    ) );
+    
+    // Behind the quad but sticking out past its edges
+    CHECK( buffer.test_bounds(
+        { -0.9f, -0.25f, 0.5f },
+        {  0.9f,  0.25f, 0.8f },
+        identity
+    ) );
+    
+    // Off-screen
+    CHECK_FALSE( buffer.test_bounds(
+        { 2.0f, -0.25f, -0.5f },
+        { 3.0f,  0.25f,  0.5f },
+        identity
+    ) );
+    
+    // Beyond the far plane
+    CHECK_FALSE( buffer.test_bounds(
+        { -0.25f, -0.25f, 1.5f },
+        {  0.25f,  0.25f, 2.0f },
+        identity
+    ) );
+}
+
+TEST_CASE( "occlusion_buffer without occluders only tests the frustum" )
+{
+    yavsg::occlusion_buffer buffer{ 64, 32 };
+    buffer.clear();
+    buffer.rasterize();
+    
+    CHECK( buffer.test_bounds(
+        { -0.25f, -0.25f, 0.5f },
+        {  0.25f,  0.25f, 0.8f },
+        identity
+    ) );
+    CHECK_FALSE( buffer.test_bounds(
+        { 2.0f, -0.25f, -0.5f },
+        { 3.0f,  0.25f,  0.5f },
+        identity
+    ) );
+}
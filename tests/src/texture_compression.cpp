@@ -0,0 +1,512 @@
+#include <yavsg/gl/texture_compression.hpp>
+
+#include <doctest/doctest.h>
+
+#include <algorithm>  // max
+#include <array>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t
+#include <cstdlib>    // abs
+#include <cstring>    // memcpy
+#include <utility>    // move
+#include <vector>
+
+
+namespace
+{
+    namespace yavsg = JadeMatrix::yavsg;
+    
+    using block_type = std::array< std::array< std::uint8_t, 4 >, 16 >;
+    
+    // Compresses & decodes a single 4x4 RGBA block, returning the largest
+    // difference in any of the format's channels
+    int round_trip_error(
+        block_type                   const& block,
+        yavsg::gl::block_compression        compression,
+        std::size_t                         channels
+    )
+    {
+        yavsg::gl::texture_upload_data upload_data{
+            GL_RGBA8,
+            4,
+            4,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            yavsg::gl::make_texture_data( sizeof( block ) ),
+            {}
+        };
+        std::memcpy( upload_data.data.get(), block.data(), sizeof( block ) );
+        
+        auto const decoded = yavsg::gl::decompress_texture_data(
+            yavsg::gl::compress_texture_data(
+                std::move( upload_data ),
+                compression,
+                false
+            )
+        );
+        REQUIRE( decoded.gl_incoming_type == GL_UNSIGNED_BYTE );
+        
+        auto const decoded_channels = std::size_t{
+            decoded.gl_incoming_format == GL_RED ? 1u
+            : decoded.gl_incoming_format == GL_RG ? 2u
+            : 4u
+        };
+        REQUIRE( decoded_channels >= channels );
+        auto const pixels = reinterpret_cast< std::uint8_t const* >(
+            decoded.data.get()
+        );
+        
+        int error = 0;
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            for( std::size_t c = 0; c < channels; ++c )
+            {
+                error = std::max( error, std::abs(
+                    static_cast< int >( pixels[ i * decoded_channels + c ] )
+                    - static_cast< int >( block[ i ][ c ] )
+                ) );
+            }
+        }
+        return error;
+    }
+    
+    block_type constant_block( std::array< std::uint8_t, 4 > const& color )
+    {
+        block_type block;
+        block.fill( color );
+        return block;
+    }
+    
+    // Steps along a line through color space, so every format's endpoints
+    // can fit it; BC1 & BC4 have fewer than 16 palette entries, so they can't
+    // be exact
+    block_type gradient_block(
+        std::array< std::uint8_t, 4 > const& from,
+        std::array< int, 4 >          const& step
+    )
+    {
+        block_type block;
+        for( std::size_t i = 0; i < 16; ++i )
+        {
+            for( std::size_t c = 0; c < 4; ++c )
+            {
+                block[ i ][ c ] = static_cast< std::uint8_t >(
+                    from[ c ] + step[ c ] * static_cast< int >( i )
+                );
+            }
+        }
+        return block;
+    }
+    
+    // One 4x4 block & the texels it should decode to, with as many channels
+    // as `decompress_texture_data()` returns for the format
+    struct known_block
+    {
+        GLint                       gl_internal_format;
+        std::vector< std::uint8_t > block;
+        std::vector< std::uint8_t > texels;
+    };
+    
+    // Decodes a single block, returning the largest difference from the
+    // expected texels
+    int decode_error( known_block const& known )
+    {
+        yavsg::gl::texture_upload_data upload_data{
+            known.gl_internal_format,
+            4,
+            4,
+            0,
+            0,
+            yavsg::gl::make_texture_data( known.block.size() ),
+            {}
+        };
+        REQUIRE( known.block.size() == yavsg::gl::block_compressed_size(
+            known.gl_internal_format,
+            4,
+            4
+        ) );
+        std::memcpy(
+            upload_data.data.get(),
+            known.block.data(),
+            known.block.size()
+        );
+        
+        auto const decoded = yavsg::gl::decompress_texture_data(
+            std::move( upload_data )
+        );
+        REQUIRE( decoded.gl_incoming_type == GL_UNSIGNED_BYTE );
+        
+        auto const decoded_channels = std::size_t{
+            decoded.gl_incoming_format == GL_RED ? 1u
+            : decoded.gl_incoming_format == GL_RG ? 2u
+            : 4u
+        };
+        REQUIRE( known.texels.size() == 16 * decoded_channels );
+        auto const pixels = reinterpret_cast< std::uint8_t const* >(
+            decoded.data.get()
+        );
+        
+        int error = 0;
+        for( std::size_t i = 0; i < known.texels.size(); ++i )
+        {
+            error = std::max( error, std::abs(
+                static_cast< int >( pixels[ i ] )
+                - static_cast< int >( known.texels[ i ] )
+            ) );
+        }
+        return error;
+    }
+    
+    // The expected texels come from Mesa's software rasterizer (llvmpipe),
+    // which has its own decoders, so they catch mistakes the round trips
+    // can't, such as swapped endpoints or misread index bits made the same way
+    // when encoding.  The BC7 blocks are otherwise random bits, so they also
+    // cover partitions, anchors, rotations, & P-bits.
+    
+    // BC1 with `color_0 > color_1`, so four interpolated colors
+    known_block const bc1_four_colors{
+        GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+        {
+            0xA3, 0xE4, 0x4C, 0x2B, 0x1B, 0xE4, 0x72, 0x8D
+        },
+        {
+            0x68, 0x78, 0x49, 0xFF, 0xA7, 0x87, 0x30, 0xFF,
+            0x29, 0x69, 0x63, 0xFF, 0xE7, 0x96, 0x18, 0xFF,
+            0xE7, 0x96, 0x18, 0xFF, 0x29, 0x69, 0x63, 0xFF,
+            0xA7, 0x87, 0x30, 0xFF, 0x68, 0x78, 0x49, 0xFF,
+            0xA7, 0x87, 0x30, 0xFF, 0xE7, 0x96, 0x18, 0xFF,
+            0x68, 0x78, 0x49, 0xFF, 0x29, 0x69, 0x63, 0xFF,
+            0x29, 0x69, 0x63, 0xFF, 0x68, 0x78, 0x49, 0xFF,
+            0xE7, 0x96, 0x18, 0xFF, 0xA7, 0x87, 0x30, 0xFF
+        }
+    };
+    
+    // BC1 with `color_0 <= color_1`, so three colors & black
+    known_block const bc1_three_colors{
+        GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+        {
+            0x4C, 0x2B, 0xA3, 0xE4, 0xFF, 0x1B, 0xE4, 0x6C
+        },
+        {
+            0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF,
+            0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF,
+            0x00, 0x00, 0x00, 0xFF, 0x88, 0x80, 0x3E, 0xFF,
+            0xE7, 0x96, 0x18, 0xFF, 0x29, 0x69, 0x63, 0xFF,
+            0x29, 0x69, 0x63, 0xFF, 0xE7, 0x96, 0x18, 0xFF,
+            0x88, 0x80, 0x3E, 0xFF, 0x00, 0x00, 0x00, 0xFF,
+            0x29, 0x69, 0x63, 0xFF, 0x00, 0x00, 0x00, 0xFF,
+            0x88, 0x80, 0x3E, 0xFF, 0xE7, 0x96, 0x18, 0xFF
+        }
+    };
+    
+    // BC3 with `alpha_0 > alpha_1`, so eight interpolated alphas
+    known_block const bc3_eight_alphas{
+        GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        {
+            0xF0, 0x10, 0x6B, 0x84, 0xC5, 0x0D, 0x63, 0x70,
+            0xA3, 0xE4, 0x4C, 0x2B, 0x1B, 0xE4, 0x72, 0x8D
+        },
+        {
+            0x68, 0x78, 0x49, 0xB1, 0xA7, 0x87, 0x30, 0x71,
+            0x29, 0x69, 0x63, 0x10, 0xE7, 0x96, 0x18, 0xD0,
+            0xE7, 0x96, 0x18, 0xF0, 0x29, 0x69, 0x63, 0xB1,
+            0xA7, 0x87, 0x30, 0x10, 0x68, 0x78, 0x49, 0x50,
+            0xA7, 0x87, 0x30, 0x71, 0xE7, 0x96, 0x18, 0x10,
+            0x68, 0x78, 0x49, 0x90, 0x29, 0x69, 0x63, 0x10,
+            0x29, 0x69, 0x63, 0x50, 0x68, 0x78, 0x49, 0xF0,
+            0xE7, 0x96, 0x18, 0x90, 0xA7, 0x87, 0x30, 0xB1
+        }
+    };
+    
+    // BC3 with `alpha_0 <= alpha_1`, so six alphas plus 0 & 255; the colors are
+    // in the order that would select BC1's three-color mode, which BC3 ignores
+    known_block const bc3_six_alphas{
+        GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        {
+            0x30, 0xD0, 0xCA, 0x02, 0x82, 0xB6, 0x5B, 0x0D,
+            0x4C, 0x2B, 0xA3, 0xE4, 0xFF, 0x1B, 0xE4, 0x6C
+        },
+        {
+            0xA7, 0x86, 0x31, 0x4F, 0xA7, 0x86, 0x31, 0xD0,
+            0xA7, 0x86, 0x31, 0x6F, 0xA7, 0x86, 0x31, 0xD0,
+            0xA7, 0x86, 0x31, 0x30, 0x68, 0x77, 0x4A, 0x8F,
+            0xE7, 0x96, 0x18, 0x30, 0x29, 0x69, 0x63, 0x8F,
+            0x29, 0x69, 0x63, 0x00, 0xE7, 0x96, 0x18, 0x00,
+            0x68, 0x77, 0x4A, 0x00, 0xA7, 0x86, 0x31, 0xAF,
+            0x29, 0x69, 0x63, 0xAF, 0xA7, 0x86, 0x31, 0x4F,
+            0x68, 0x77, 0x4A, 0x6F, 0xE7, 0x96, 0x18, 0x30
+        }
+    };
+    
+    // BC4 with `red_0 > red_1`, so eight interpolated values
+    known_block const bc4_eight_values{
+        GL_COMPRESSED_RED_RGTC1,
+        {
+            0xE0, 0x18, 0x96, 0x25, 0xBB, 0x04, 0x37, 0xD9
+        },
+        {
+            0x51, 0xC3, 0x51, 0xC3, 0xC3, 0x51, 0x51, 0x6E,
+            0x8A, 0xE0, 0x8A, 0xA7, 0xA7, 0xC3, 0x51, 0x51
+        }
+    };
+    
+    // BC4 with `red_0 <= red_1`, so six values plus 0 & 255
+    known_block const bc4_six_values{
+        GL_COMPRESSED_RED_RGTC1,
+        {
+            0x18, 0xE0, 0xB2, 0xD8, 0x31, 0xC8, 0x99, 0x88
+        },
+        {
+            0x3F, 0x00, 0x3F, 0x8F, 0xB7, 0x67, 0x8F, 0xE0,
+            0x18, 0xE0, 0xFF, 0x8F, 0xE0, 0xE0, 0x3F, 0x8F
+        }
+    };
+    
+    // BC5 with red & green in opposite modes
+    known_block const bc5_block{
+        GL_COMPRESSED_RG_RGTC2,
+        {
+            0xC8, 0x20, 0x22, 0xEB, 0xDC, 0x83, 0xA4, 0x00,
+            0x40, 0xB0, 0x17, 0x60, 0xF6, 0xC3, 0xA0, 0x90
+        },
+        {
+            0xB0, 0xFF, 0x80, 0x56, 0x80, 0x40, 0x68, 0x40,
+            0x50, 0x00, 0x20, 0x82, 0x38, 0x99, 0x50, 0xFF,
+            0x98, 0x6C, 0xC8, 0x40, 0xB0, 0x6C, 0xB0, 0x40,
+            0xB0, 0x56, 0x20, 0xB0, 0xC8, 0x82, 0xC8, 0x82
+        }
+    };
+    
+    // BC7 mode 0: three subsets, 4-bit endpoints, per-endpoint P-bits
+    known_block const bc7_mode_0{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0xC7, 0xB3, 0xF5, 0x45, 0xDD, 0x24, 0x58, 0x98,
+            0x93, 0x78, 0x32, 0xCB, 0xF1, 0x2D, 0xD5, 0x11
+        },
+        {
+            0xD8, 0xC0, 0x57, 0xFF, 0xE0, 0x30, 0x5B, 0xFF,
+            0xA1, 0x61, 0x7E, 0xFF, 0xE0, 0x30, 0x5B, 0xFF,
+            0xA8, 0xE6, 0xB7, 0xFF, 0xE3, 0xB6, 0x40, 0xFF,
+            0x40, 0xAE, 0xB5, 0xFF, 0x21, 0xC6, 0xC6, 0xFF,
+            0xA8, 0xE6, 0xB7, 0xFF, 0xD8, 0xC0, 0x57, 0xFF,
+            0xC8, 0x50, 0xB8, 0xFF, 0xB3, 0x34, 0xA2, 0xFF,
+            0xA8, 0xE6, 0xB7, 0xFF, 0xCF, 0x5A, 0xBF, 0xFF,
+            0xC8, 0x50, 0xB8, 0xFF, 0xD6, 0x63, 0xC6, 0xFF
+        }
+    };
+    
+    // BC7 mode 1: two subsets, 6-bit endpoints, shared P-bits
+    known_block const bc7_mode_1{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0x0A, 0xD6, 0x02, 0xC1, 0x40, 0x71, 0x3C, 0xE1,
+            0x67, 0x74, 0x7B, 0x43, 0x2D, 0xFA, 0xA9, 0x8F
+        },
+        {
+            0x4E, 0x08, 0x84, 0xFF, 0xC3, 0x3E, 0x76, 0xFF,
+            0xB1, 0x3A, 0x69, 0xFF, 0x42, 0x1E, 0x1A, 0xFF,
+            0x4E, 0x08, 0x84, 0xFF, 0x9F, 0x35, 0x5C, 0xFF,
+            0x9F, 0x35, 0x5C, 0xFF, 0x42, 0x1E, 0x1A, 0xFF,
+            0x3A, 0x10, 0x81, 0xFF, 0xC3, 0x3E, 0x76, 0xFF,
+            0x78, 0x2C, 0x41, 0xFF, 0x66, 0x27, 0x34, 0xFF,
+            0x3A, 0x10, 0x81, 0xFF, 0xC3, 0x3E, 0x76, 0xFF,
+            0x54, 0x23, 0x27, 0xFF, 0x66, 0x27, 0x34, 0xFF
+        }
+    };
+    
+    // BC7 mode 2: three subsets, 5-bit endpoints, 2-bit indices
+    known_block const bc7_mode_2{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0x6C, 0x60, 0x48, 0x5B, 0x57, 0xB9, 0xA4, 0x92,
+            0x5B, 0x14, 0x3E, 0x6C, 0x20, 0x71, 0x18, 0x34
+        },
+        {
+            0x84, 0x94, 0x10, 0xFF, 0xAD, 0x68, 0x5C, 0xFF,
+            0xD6, 0x94, 0xB5, 0xFF, 0xC9, 0xAC, 0x7C, 0xFF,
+            0x84, 0x94, 0x10, 0xFF, 0x7B, 0x7E, 0xA3, 0xFF,
+            0xAD, 0xDE, 0x08, 0xFF, 0xD6, 0x94, 0xB5, 0xFF,
+            0x84, 0x94, 0x10, 0xFF, 0xDE, 0x52, 0x18, 0xFF,
+            0xD6, 0x94, 0xB5, 0xFF, 0xD6, 0x94, 0xB5, 0xFF,
+            0x31, 0x6D, 0x21, 0xFF, 0xAD, 0x68, 0x5C, 0xFF,
+            0xC9, 0xAC, 0x7C, 0xFF, 0xD6, 0x94, 0xB5, 0xFF
+        }
+    };
+    
+    // BC7 mode 3: two subsets, 7-bit endpoints, per-endpoint P-bits
+    known_block const bc7_mode_3{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0x38, 0x36, 0xEB, 0xE8, 0xB6, 0x88, 0x68, 0x40,
+            0xA2, 0x5E, 0x97, 0x22, 0x2C, 0xEC, 0x22, 0x94
+        },
+        {
+            0xB4, 0x5A, 0x55, 0xFF, 0xB4, 0x5A, 0x55, 0xFF,
+            0xD3, 0x37, 0x4C, 0xFF, 0xD0, 0x0C, 0x2E, 0xFF,
+            0xD0, 0x72, 0x59, 0xFF, 0xB4, 0x5A, 0x55, 0xFF,
+            0xDA, 0x90, 0x8A, 0xFF, 0xD3, 0x37, 0x4C, 0xFF,
+            0xD3, 0x37, 0x4C, 0xFF, 0xD0, 0x0C, 0x2E, 0xFF,
+            0xD0, 0x72, 0x59, 0xFF, 0x9A, 0x44, 0x50, 0xFF,
+            0xD0, 0x0C, 0x2E, 0xFF, 0xD3, 0x37, 0x4C, 0xFF,
+            0xB4, 0x5A, 0x55, 0xFF, 0xD0, 0x72, 0x59, 0xFF
+        }
+    };
+    
+    // BC7 mode 4: separate color & alpha indices, rotation, & index selection
+    known_block const bc7_mode_4{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0x10, 0x31, 0x5F, 0x6A, 0xC2, 0x4C, 0xFF, 0x40,
+            0xAE, 0x4A, 0x6C, 0xE3, 0x67, 0xA8, 0xAD, 0xE5
+        },
+        {
+            0xA2, 0xB5, 0x24, 0xD0, 0xCE, 0xA5, 0x08, 0xD2,
+            0xCE, 0xA5, 0x08, 0xD2, 0xA2, 0xB5, 0x24, 0xD0,
+            0x8C, 0xBD, 0x31, 0xD2, 0x8C, 0xBD, 0x31, 0xD3,
+            0xB8, 0xAD, 0x15, 0xD0, 0x8C, 0xBD, 0x31, 0xD1,
+            0xCE, 0xA5, 0x08, 0xCF, 0xA2, 0xB5, 0x24, 0xD2,
+            0xA2, 0xB5, 0x24, 0xD2, 0xA2, 0xB5, 0x24, 0xD2,
+            0xA2, 0xB5, 0x24, 0xD0, 0xA2, 0xB5, 0x24, 0xD1,
+            0xB8, 0xAD, 0x15, 0xD0, 0x8C, 0xBD, 0x31, 0xD3
+        }
+    };
+    
+    // BC7 mode 5: separate color & alpha indices with rotation
+    known_block const bc7_mode_5{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0xA0, 0x1C, 0xF5, 0x79, 0xEC, 0xAE, 0x09, 0xC6,
+            0x27, 0x8E, 0x6F, 0x01, 0xB5, 0x0E, 0xBC, 0xD3
+        },
+        {
+            0x6C, 0x82, 0xB7, 0xCC, 0x38, 0xA6, 0xDD, 0xCF,
+            0x6C, 0xF1, 0xB7, 0xCC, 0x38, 0xCD, 0xDD, 0xCF,
+            0xD5, 0xCD, 0x6A, 0xC7, 0x6C, 0xF1, 0xB7, 0xCC,
+            0x38, 0x82, 0xDD, 0xCF, 0xD5, 0x82, 0x6A, 0xC7,
+            0xD5, 0x82, 0x6A, 0xC7, 0x6C, 0xF1, 0xB7, 0xCC,
+            0xD5, 0xF1, 0x6A, 0xC7, 0xA1, 0xCD, 0x90, 0xCA,
+            0x38, 0xF1, 0xDD, 0xCF, 0x38, 0x82, 0xDD, 0xCF,
+            0x38, 0xA6, 0xDD, 0xCF, 0xA1, 0xF1, 0x90, 0xCA
+        }
+    };
+    
+    // BC7 mode 6: one subset, 7-bit endpoints with alpha, 4-bit indices
+    known_block const bc7_mode_6{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0x40, 0x2D, 0xF5, 0x1E, 0x44, 0x14, 0x8A, 0x8F,
+            0x2B, 0xE2, 0x1E, 0x3F, 0x42, 0xA4, 0x7E, 0x9D
+        },
+        {
+            0xB1, 0xCC, 0x0F, 0x68, 0xB3, 0xE0, 0x10, 0x7C,
+            0xB3, 0xE0, 0x10, 0x7C, 0xAA, 0x8A, 0x0B, 0x26,
+            0xAA, 0x8A, 0x0B, 0x26, 0xB4, 0xE8, 0x11, 0x84,
+            0xA9, 0x83, 0x0B, 0x1F, 0xB3, 0xD9, 0x10, 0x75,
+            0xB3, 0xE0, 0x10, 0x7C, 0xB2, 0xD2, 0x0F, 0x6E,
+            0xB2, 0xD2, 0x0F, 0x6E, 0xAD, 0xA6, 0x0D, 0x42,
+            0xAA, 0x8A, 0x0B, 0x26, 0xAF, 0xBC, 0x0E, 0x58,
+            0xAB, 0x92, 0x0C, 0x2E, 0xAE, 0xAF, 0x0D, 0x4B
+        }
+    };
+    
+    // BC7 mode 7: two subsets, 5-bit endpoints with alpha
+    known_block const bc7_mode_7{
+        GL_COMPRESSED_RGBA_BPTC_UNORM,
+        {
+            0x80, 0x36, 0x99, 0x90, 0xF6, 0x3D, 0x4B, 0x12,
+            0x27, 0xB0, 0x67, 0x75, 0x56, 0x8A, 0xC1, 0x00
+        },
+        {
+            0x4B, 0xE8, 0x39, 0x6C, 0x9A, 0x50, 0x1A, 0xCB,
+            0x82, 0x9A, 0x38, 0xB2, 0x4B, 0xE8, 0x39, 0x6C,
+            0x73, 0xE2, 0x24, 0x72, 0x73, 0xE2, 0x24, 0x72,
+            0x82, 0x9A, 0x38, 0xB2, 0x9A, 0x50, 0x1A, 0xCB,
+            0x8E, 0x76, 0x2A, 0xBE, 0x24, 0xEF, 0x4D, 0x65,
+            0x24, 0xEF, 0x4D, 0x65, 0xA6, 0x2C, 0x0C, 0xD7,
+            0x82, 0x9A, 0x38, 0xB2, 0x82, 0x9A, 0x38, 0xB2,
+            0x24, 0xEF, 0x4D, 0x65, 0x24, 0xEF, 0x4D, 0x65
+        }
+    };
+}
+
+
+TEST_CASE( "BC1 round-trips constant & gradient blocks" )
+{
+    using yavsg::gl::block_compression;
+    
+    // 5:6:5 endpoints are within 4 of any color, & the interpolated palette
+    // entries can land closer
+    CHECK_LE( round_trip_error(
+        constant_block( { 200, 100, 50, 255 } ),
+        block_compression::bc1,
+        3
+    ), 4 );
+    CHECK_LE( round_trip_error(
+        gradient_block( { 40, 80, 200, 255 }, { 4, 2, -3, 0 } ),
+        block_compression::bc1,
+        3
+    ), 12 );
+}
+
+TEST_CASE( "BC4 round-trips constant & gradient blocks" )
+{
+    using yavsg::gl::block_compression;
+    
+    CHECK_LE( round_trip_error(
+        constant_block( { 137, 0, 0, 255 } ),
+        block_compression::bc4,
+        1
+    ), 0 );
+    CHECK_LE( round_trip_error(
+        gradient_block( { 20, 0, 0, 255 }, { 8, 0, 0, 0 } ),
+        block_compression::bc4,
+        1
+    ), 10 );
+}
+
+TEST_CASE( "BC7 round-trips constant & gradient blocks" )
+{
+    using yavsg::gl::block_compression;
+    
+    CHECK_LE( round_trip_error(
+        constant_block( { 200, 100, 50, 180 } ),
+        block_compression::bc7,
+        4
+    ), 1 );
+    CHECK_LE( round_trip_error(
+        gradient_block( { 40, 80, 200, 250 }, { 4, 2, -3, -5 } ),
+        block_compression::bc7,
+        4
+    ), 2 );
+}
+
+TEST_CASE( "BC1 & BC3 decode known blocks" )
+{
+    // BC1-BC5 palettes are only specified to within rounding, & Mesa rounds
+    // where this decoder truncates
+    CHECK_LE( decode_error( bc1_four_colors  ), 1 );
+    CHECK_LE( decode_error( bc1_three_colors ), 1 );
+    CHECK_LE( decode_error( bc3_eight_alphas ), 1 );
+    CHECK_LE( decode_error( bc3_six_alphas   ), 1 );
+}
+
+TEST_CASE( "BC4 & BC5 decode known blocks" )
+{
+    CHECK_LE( decode_error( bc4_eight_values ), 1 );
+    CHECK_LE( decode_error( bc4_six_values   ), 1 );
+    CHECK_LE( decode_error( bc5_block        ), 1 );
+}
+
+TEST_CASE( "BC7 decodes known blocks in every mode" )
+{
+    // Unlike the others, BC7 decoding is specified exactly
+    CHECK_EQ( decode_error( bc7_mode_0 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_1 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_2 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_3 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_4 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_5 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_6 ), 0 );
+    CHECK_EQ( decode_error( bc7_mode_7 ), 0 );
+}